@@ -0,0 +1,329 @@
+#ifndef _ALLOCTRACKER__H
+#define _ALLOCTRACKER__H
+#include <SDL.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "heap_check.h"
+
+// Allocation tracking per subsystem. Every operator new and every SDL_malloc (SDL, SDL_image and
+// SDL_mixer allocate through it: surfaces, decoded sounds, renderer bookkeeping) is charged to the
+// tag of the ALLOC_SCOPE the calling thread is in, and a free is charged back to the tag the block
+// was allocated under, so live bytes per tag only go down when that subsystem's memory is returned.
+//
+// Per frame (ALLOC_END_FRAME after present) the counts and bytes of the frame are folded into the
+// high-water marks, every REPORT_FRAMES frames a table goes to the log; logSession() prints the
+// totals of the whole session, the game does it at every level start and at exit. Live bytes of a
+// tag that keep climbing from one level start to the next are a leak in that subsystem.
+//
+// Only compiled in with -DALLOC_TRACKING_ENABLED (the Tracking target). Without it ALLOC_SCOPE
+// expands to nothing and nothing is hooked.
+enum AllocTag {
+    ALLOC_OTHER,            // outside any scope: startup, shutdown, threads SDL starts
+    ALLOC_PHYSICS,          // simulation steps and the replay log recording them
+    ALLOC_RENDER,           // drawing the PLAYING state and presenting
+    ALLOC_AUDIO,            // music and sound effects, decoding included
+    ALLOC_MENU,             // menus and their input
+    ALLOC_LEVEL_LOAD,       // level files, image decoding and uploads, chunk streaming
+    ALLOC_TAG_COUNT
+};
+
+class AllocTracker {
+public:
+    static const int REPORT_FRAMES = 600;   // ten seconds at 60 fps
+
+    static const char* tagName(AllocTag tag) {
+        static const char* names[ALLOC_TAG_COUNT] = {"other", "physics", "render", "audio", "menu", "level load"};
+        return names[tag];
+    }
+
+    // Route SDL's allocations through the tracker, has to be the first SDL call. The only SDL blocks
+    // older than the hooks are argv, which SDL's main wrapper allocates on some platforms (Windows)
+    // and frees after SDL_main returns; those pointers are recorded here and passed straight through.
+    static void install(int argc, char* argv[]) {
+        State& s = state();
+        if (s.installed) return;
+        if (argc + 1 > MAX_FOREIGN) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "AllocTracker: %d arguments, SDL allocations are not tracked", argc);
+            return;
+        }
+        s.foreign[s.foreignCount++] = argv;
+        for (int i = 0; i < argc; i++) s.foreign[s.foreignCount++] = argv[i];
+
+        SDL_GetMemoryFunctions(&s.sdlMalloc, &s.sdlCalloc, &s.sdlRealloc, &s.sdlFree);
+        if (SDL_SetMemoryFunctions(sdlMallocHook, sdlCallocHook, sdlReallocHook, sdlFreeHook) != 0) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "AllocTracker: cannot hook SDL allocations: %s", SDL_GetError());
+            return;
+        }
+        s.installed = true;
+    }
+
+    // Call once per frame after presenting
+    static void endFrame() {
+        State& s = state();
+        for (int t = 0; t < ALLOC_TAG_COUNT; t++) {
+            Counters& c = s.counters[t];
+            Frame& f = s.frames[t];
+            int64_t allocs = c.allocs.load(std::memory_order_relaxed);
+            int64_t bytes = c.allocBytes.load(std::memory_order_relaxed);
+            int64_t frameAllocs = allocs - f.lastAllocs;
+            int64_t frameBytes = bytes - f.lastBytes;
+            f.lastAllocs = allocs;
+            f.lastBytes = bytes;
+            if (frameAllocs > f.worstAllocs) f.worstAllocs = frameAllocs;
+            if (frameBytes > f.worstBytes) f.worstBytes = frameBytes;
+            f.periodAllocs += frameAllocs;
+            f.periodBytes += frameBytes;
+        }
+
+        if (++s.periodFrames == REPORT_FRAMES) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                           "Allocations over %d frames: tag, allocs/frame, bytes/frame, worst frame allocs/bytes, live bytes",
+                           s.periodFrames);
+            for (int t = 0; t < ALLOC_TAG_COUNT; t++) {
+                Frame& f = s.frames[t];
+                SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                               "  %-10s %8.2f %10.0f %8lld %10lld %12lld", tagName(static_cast<AllocTag>(t)),
+                               f.periodAllocs / static_cast<double>(s.periodFrames),
+                               f.periodBytes / static_cast<double>(s.periodFrames),
+                               static_cast<long long>(f.worstAllocs), static_cast<long long>(f.worstBytes),
+                               static_cast<long long>(s.counters[t].liveBytes.load(std::memory_order_relaxed)));
+                f.periodAllocs = 0;
+                f.periodBytes = 0;
+            }
+            s.periodFrames = 0;
+        }
+    }
+
+    // Totals since the start, with the largest live size each tag ever had and its worst frame
+    static void logSession(const char* when) {
+        State& s = state();
+        SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                       "Allocations, session at %s: tag, allocs, frees, bytes, live bytes/blocks, peak live, worst frame allocs/bytes",
+                       when);
+        int64_t live = 0;
+        for (int t = 0; t < ALLOC_TAG_COUNT; t++) {
+            Counters& c = s.counters[t];
+            live += c.liveBytes.load(std::memory_order_relaxed);
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                           "  %-10s %10lld %10lld %12lld %12lld/%-8lld %12lld %8lld/%lld", tagName(static_cast<AllocTag>(t)),
+                           static_cast<long long>(c.allocs.load(std::memory_order_relaxed)),
+                           static_cast<long long>(c.frees.load(std::memory_order_relaxed)),
+                           static_cast<long long>(c.allocBytes.load(std::memory_order_relaxed)),
+                           static_cast<long long>(c.liveBytes.load(std::memory_order_relaxed)),
+                           static_cast<long long>(c.liveBlocks.load(std::memory_order_relaxed)),
+                           static_cast<long long>(c.peakLiveBytes.load(std::memory_order_relaxed)),
+                           static_cast<long long>(s.frames[t].worstAllocs),
+                           static_cast<long long>(s.frames[t].worstBytes));
+        }
+        SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO, "  %lld bytes live in total",
+                       static_cast<long long>(live));
+    }
+
+    // Block layout: a header in front of what the caller gets, so a free knows size and tag.
+    // Out of line (heap_check.h), inlined into a delete the header arithmetic trips GCC's warnings.
+    HEAP_NOINLINE static void* allocate(void* (*allocator)(size_t), size_t size) {
+        char* block = static_cast<char*>(allocator(size + HEADER));
+        if (block == nullptr) return nullptr;
+        Header* header = reinterpret_cast<Header*>(block);
+        header->size = size;
+        header->tag = current();
+        charge(header->tag, static_cast<int64_t>(size), 1);
+        return block + HEADER;
+    }
+
+    HEAP_NOINLINE static void release(void (*deallocator)(void*), void* pointer) {
+        if (pointer == nullptr) return;
+        Header* header = headerOf(pointer);
+        charge(header->tag, -static_cast<int64_t>(header->size), -1);
+        deallocator(header);
+    }
+
+private:
+    static const size_t HEADER = alignof(std::max_align_t);
+    static const int MAX_FOREIGN = 64;      // argv and its strings
+
+    struct Header {
+        size_t size;
+        AllocTag tag;
+    };
+    static_assert(sizeof(Header) <= HEADER, "allocation header does not fit its slot");
+
+    // Touched from every thread: the loader workers, the audio callback, the trace writer
+    struct Counters {
+        std::atomic<int64_t> allocs, frees, allocBytes, liveBytes, liveBlocks, peakLiveBytes;
+    };
+
+    // Main thread only
+    struct Frame {
+        int64_t lastAllocs, lastBytes;
+        int64_t worstAllocs, worstBytes;
+        int64_t periodAllocs, periodBytes;
+    };
+
+    struct State {
+        Counters counters[ALLOC_TAG_COUNT];
+        Frame frames[ALLOC_TAG_COUNT];
+        int periodFrames;
+        bool installed;
+        void* foreign[MAX_FOREIGN];     // SDL blocks from before install(), null once freed
+        int foreignCount;               // written by install() only, before any other thread runs
+        SDL_malloc_func sdlMalloc;
+        SDL_calloc_func sdlCalloc;
+        SDL_realloc_func sdlRealloc;
+        SDL_free_func sdlFree;
+    };
+
+    // Zero initialised and trivially constructible, usable from the first operator new on
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static AllocTag& current() {
+        static thread_local AllocTag tag = ALLOC_OTHER;
+        return tag;
+    }
+
+    static Header* headerOf(void* pointer) {
+        return reinterpret_cast<Header*>(static_cast<char*>(pointer) - HEADER);
+    }
+
+    // Slot of a block SDL allocated before install(), nullptr for a tracked one
+    static void** foreignSlot(void* pointer) {
+        State& s = state();
+        for (int i = 0; i < s.foreignCount; i++) {
+            if (s.foreign[i] == pointer) return &s.foreign[i];
+        }
+        return nullptr;
+    }
+
+    static void charge(AllocTag tag, int64_t bytes, int blocks) {
+        Counters& c = state().counters[tag];
+        if (blocks > 0) {
+            c.allocs.fetch_add(1, std::memory_order_relaxed);
+            c.allocBytes.fetch_add(bytes, std::memory_order_relaxed);
+        } else {
+            c.frees.fetch_add(1, std::memory_order_relaxed);
+        }
+        c.liveBlocks.fetch_add(blocks, std::memory_order_relaxed);
+        int64_t live = c.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        int64_t peak = c.peakLiveBytes.load(std::memory_order_relaxed);
+        while (live > peak && !c.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    static void* SDLCALL sdlMallocHook(size_t size) {
+        return allocate(state().sdlMalloc, size);
+    }
+
+    static void* SDLCALL sdlCallocHook(size_t count, size_t size) {
+        if (size != 0 && count > SIZE_MAX / size) return nullptr;
+        void* pointer = allocate(state().sdlMalloc, count * size);
+        if (pointer != nullptr) memset(pointer, 0, count * size);
+        return pointer;
+    }
+
+    static void* SDLCALL sdlReallocHook(void* pointer, size_t size) {
+        State& s = state();
+        if (pointer == nullptr) return allocate(s.sdlMalloc, size);
+        if (void** slot = foreignSlot(pointer)) {
+            void* moved = s.sdlRealloc(pointer, size);
+            if (moved != nullptr) *slot = moved;
+            return moved;
+        }
+
+        // Stays with the tag it was first allocated under
+        Header* header = headerOf(pointer);
+        AllocTag tag = header->tag;
+        size_t oldSize = header->size;
+        Header* moved = static_cast<Header*>(s.sdlRealloc(header, size + HEADER));
+        if (moved == nullptr) return nullptr;
+        moved->size = size;
+        charge(tag, -static_cast<int64_t>(oldSize), -1);
+        charge(tag, static_cast<int64_t>(size), 1);
+        return reinterpret_cast<char*>(moved) + HEADER;
+    }
+
+    static void SDLCALL sdlFreeHook(void* pointer) {
+        if (pointer == nullptr) return;
+        if (void** slot = foreignSlot(pointer)) {
+            *slot = nullptr;
+            state().sdlFree(pointer);
+        } else {
+            release(state().sdlFree, pointer);
+        }
+    }
+
+    friend class AllocScope;
+};
+
+// Allocations on this thread are charged to tag until the end of the block, scopes nest
+class AllocScope {
+public:
+    explicit AllocScope(AllocTag tag) : previous(AllocTracker::current()) {
+        AllocTracker::current() = tag;
+    }
+
+    ~AllocScope() {
+        AllocTracker::current() = previous;
+    }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocTag previous;
+};
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+
+#ifdef ALLOC_TRACKING_ENABLED
+#define ALLOC_SCOPE(tag) AllocScope ALLOC_CONCAT(allocScope, __LINE__)(tag)
+#define ALLOC_END_FRAME() AllocTracker::endFrame()
+
+// The replacement is only compiled where ALLOC_TRACKING_DEFINE_OPERATORS is defined, once per
+// program (main.cpp), so tools with an operator new of their own still build with tracking on.
+// It also feeds HeapCheck when both are on (heap_check.h leaves operator new to this one then).
+#ifdef ALLOC_TRACKING_DEFINE_OPERATORS
+void* operator new(size_t size) {
+    void* pointer = AllocTracker::allocate(malloc, size ? size : 1);
+    if (pointer == nullptr) throw std::bad_alloc();
+#ifdef HEAP_CHECK_ENABLED
+    HeapCheck::allocated();
+#endif
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    AllocTracker::release(free, pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    AllocTracker::release(free, pointer);
+}
+
+// Spelled out, a runtime with its own array forms would otherwise hand back blocks without a header
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void* pointer) noexcept {
+    AllocTracker::release(free, pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    AllocTracker::release(free, pointer);
+}
+#endif
+#else
+#define ALLOC_SCOPE(tag) ((void)0)
+#define ALLOC_END_FRAME() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef _ASSETARCHIVE__H
+#define _ASSETARCHIVE__H
+#include <SDL.h>
+#include <cstring>
+#include <string>
+#include "asset_format.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of assets.pak (built by tools/assetpack.cpp), the whole file is memory mapped
+// and every asset is handed to SDL as a SDL_RWFromConstMem view, no open/read/close per file.
+// Assets are named by their path relative to the game folder ("graphic/poll.png", "sounds/huhu.mp3").
+// If there is no archive the names are opened as loose files next to the game instead.
+class AssetArchive {
+public:
+    // Map the archive, looked up in the working directory first and then next to the executable
+    static bool mount(const char* archiveName) {
+        if (state().base != nullptr) return true;
+
+        if (mapFile(archiveName)) return true;
+
+        std::string besideExe = basePath() + archiveName;
+        if (mapFile(besideExe.c_str())) return true;
+
+        SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                       "No %s found, loading assets from loose files", archiveName);
+        return false;
+    }
+
+    static void unmount() {
+        State& s = state();
+        if (s.base == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(s.base);
+        CloseHandle(s.mapping);
+        CloseHandle(s.file);
+#else
+        munmap(const_cast<unsigned char*>(s.base), s.size);
+#endif
+        s = State();
+    }
+
+    static bool isMounted() {
+        return state().base != nullptr;
+    }
+
+    // Find an asset in the mapped archive, data stays valid until unmount()
+    static bool find(const char* name, const void*& data, size_t& size) {
+        const State& s = state();
+        if (s.base == nullptr) return false;
+
+        size_t nameLength = strlen(name);
+        // Entries are sorted by name, binary search
+        uint32_t low = 0, high = s.header->entryCount;
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            const PackEntry& entry = s.entries[mid];
+            int cmp = compareName(entry, name, nameLength);
+            if (cmp == 0) {
+                data = s.base + entry.dataOffset;
+                size = static_cast<size_t>(entry.dataSize);
+                return true;
+            }
+            if (cmp < 0) low = mid + 1;
+            else high = mid;
+        }
+        return false;
+    }
+
+    // Open an asset for SDL loaders (IMG_Load_RW, Mix_LoadWAV_RW...), caller passes freesrc = 1
+    static SDL_RWops* openRW(const char* name) {
+        const void* data;
+        size_t size;
+        if (find(name, data, size)) {
+            return SDL_RWFromConstMem(data, static_cast<int>(size));
+        }
+
+        // Loose file fallback, relative to the working directory then to the executable
+        SDL_RWops* rw = SDL_RWFromFile(name, "rb");
+        if (rw == nullptr) {
+            std::string besideExe = basePath() + name;
+            rw = SDL_RWFromFile(besideExe.c_str(), "rb");
+        }
+        return rw;
+    }
+
+    // Per-user writable location for settings files, nothing is written next to the assets
+    static std::string userPath(const char* fileName) {
+        std::string path;
+        char* pref = SDL_GetPrefPath("NgcBci", "SwingAndGrip");
+        if (pref != nullptr) {
+            path = pref;
+            SDL_free(pref);
+        }
+        return path + fileName;
+    }
+
+private:
+    struct State {
+        const unsigned char* base = nullptr;
+        size_t size = 0;
+        const PackHeader* header = nullptr;
+        const PackEntry* entries = nullptr;
+        const char* names = nullptr;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+#endif
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static std::string basePath() {
+        std::string path;
+        char* base = SDL_GetBasePath();
+        if (base != nullptr) {
+            path = base;
+            SDL_free(base);
+        }
+        return path;
+    }
+
+    static int compareName(const PackEntry& entry, const char* name, size_t nameLength) {
+        const char* entryName = state().names + entry.nameOffset;
+        size_t common = entry.nameLength < nameLength ? entry.nameLength : nameLength;
+        int cmp = memcmp(entryName, name, common);
+        if (cmp != 0) return cmp;
+        if (entry.nameLength == nameLength) return 0;
+        return entry.nameLength < nameLength ? -1 : 1;
+    }
+
+    static bool mapFile(const char* path) {
+        State s;
+#ifdef _WIN32
+        s.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (s.file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(s.file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(s.file);
+            return false;
+        }
+        s.size = static_cast<size_t>(fileSize.QuadPart);
+
+        s.mapping = CreateFileMappingA(s.file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (s.mapping == NULL) {
+            CloseHandle(s.file);
+            return false;
+        }
+        s.base = static_cast<const unsigned char*>(MapViewOfFile(s.mapping, FILE_MAP_READ, 0, 0, 0));
+        if (s.base == nullptr) {
+            CloseHandle(s.mapping);
+            CloseHandle(s.file);
+            return false;
+        }
+#else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        s.size = static_cast<size_t>(info.st_size);
+
+        void* mapped = mmap(nullptr, s.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);  // the mapping keeps the file alive
+        if (mapped == MAP_FAILED) return false;
+        s.base = static_cast<const unsigned char*>(mapped);
+#endif
+        state() = s;
+
+        if (!validate()) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "%s is not a valid asset archive", path);
+            unmount();
+            return false;
+        }
+        return true;
+    }
+
+    // Check the header and that every entry lies inside the file before trusting it
+    static bool validate() {
+        State& s = state();
+        if (s.size < sizeof(PackHeader)) return false;
+
+        s.header = reinterpret_cast<const PackHeader*>(s.base);
+        if (memcmp(s.header->magic, PACK_MAGIC, 4) != 0 || s.header->version != PACK_VERSION) return false;
+
+        uint64_t indexEnd = sizeof(PackHeader) + uint64_t(s.header->entryCount) * sizeof(PackEntry);
+        if (indexEnd + s.header->namesSize > s.size) return false;
+
+        s.entries = reinterpret_cast<const PackEntry*>(s.base + sizeof(PackHeader));
+        s.names = reinterpret_cast<const char*>(s.base + indexEnd);
+
+        for (uint32_t i = 0; i < s.header->entryCount; i++) {
+            const PackEntry& entry = s.entries[i];
+            if (uint64_t(entry.nameOffset) + entry.nameLength > s.header->namesSize) return false;
+            if (entry.dataOffset > s.size || entry.dataSize > s.size - entry.dataOffset) return false;
+        }
+        return true;
+    }
+};
+
+#endif
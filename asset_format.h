@@ -0,0 +1,32 @@
+#ifndef _ASSETFORMAT__H
+#define _ASSETFORMAT__H
+#include <cstdint>
+
+// On-disk layout of the packed asset archive (assets.pak), shared by the packer and the game.
+// Everything is little endian:
+//   PackHeader
+//   PackEntry[entryCount]      sorted by name so the loader can binary search
+//   name blob                  names are relative paths with '/' separators, e.g. "graphic/poll.png"
+//   file data                  each file starts on a PACK_DATA_ALIGN boundary
+const char PACK_MAGIC[4] = {'S', 'G', 'P', 'K'};
+const uint32_t PACK_VERSION = 1;
+const uint32_t PACK_DATA_ALIGN = 16;
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t namesSize;    // size of the name blob in bytes
+};
+
+struct PackEntry {
+    uint32_t nameOffset;   // offset into the name blob
+    uint32_t nameLength;
+    uint64_t dataOffset;   // absolute offset from the start of the archive
+    uint64_t dataSize;
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader must stay 16 bytes");
+static_assert(sizeof(PackEntry) == 24, "PackEntry must stay 24 bytes");
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef _ASSETLOADER__H
+#define _ASSETLOADER__H
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "alloc_tracker.h"
+#include "asset_archive.h"
+#include "texture_atlas.h"
+
+// Background asset loader: a small pool of worker threads decodes PNGs into SDL_Surfaces and
+// sound files into PCM chunks, the main thread only does the GPU upload in pump().
+// Used while the game sits in the LOADING state so frames keep being presented.
+class AssetLoader {
+public:
+    explicit AssetLoader(int threadCount = 0)
+        : mutex(SDL_CreateMutex()), workAvailable(SDL_CreateCond()), stopping(false),
+          requested(0), completed(0) {
+        if (threadCount <= 0) {
+            // Leave one core for the render thread
+            threadCount = SDL_GetCPUCount() - 1;
+            if (threadCount < 1) threadCount = 1;
+            if (threadCount > 4) threadCount = 4;
+        }
+        for (int i = 0; i < threadCount; i++) {
+            SDL_Thread* thread = SDL_CreateThread(workerMain, "AssetLoader", this);
+            if (thread != nullptr) workers.push_back(thread);
+        }
+    }
+
+    ~AssetLoader() {
+        SDL_LockMutex(mutex);
+        stopping = true;
+        SDL_CondBroadcast(workAvailable);
+        SDL_UnlockMutex(mutex);
+
+        for (SDL_Thread* thread : workers) {
+            SDL_WaitThread(thread, nullptr);
+        }
+
+        // Free whatever was decoded but never collected
+        for (Job& job : finished) freeJob(job);
+        for (auto& sound : sounds) Mix_FreeChunk(sound.second);
+
+        SDL_DestroyCond(workAvailable);
+        SDL_DestroyMutex(mutex);
+    }
+
+    // Queue a texture, textures that are already alive in the cache are just held, not decoded again
+    // and sprites packed into the atlas are skipped entirely
+    void requestTexture(const char* name) {
+        if (TextureAtlas::contains(name)) return;
+
+        TextureHandle cached = TextureCache::get(name);
+        if (cached) {
+            textures.push_back(cached);
+            requested++;
+            completed++;
+            return;
+        }
+        queueJob(name, false);
+    }
+
+    // Queue a sound effect, decoded to PCM with Mix_LoadWAV_RW on a worker
+    void requestSound(const char* name) {
+        queueJob(name, true);
+    }
+
+    // Main thread only: turn decoded surfaces into textures, at most maxUploads per call so a frame
+    // never stalls on a long list of uploads
+    void pump(SDL_Renderer* renderer, int maxUploads) {
+        for (int uploads = 0; uploads < maxUploads; uploads++) {
+            SDL_LockMutex(mutex);
+            if (finished.empty()) {
+                SDL_UnlockMutex(mutex);
+                break;
+            }
+            Job job = finished.front();
+            finished.pop_front();
+            SDL_UnlockMutex(mutex);
+
+            if (job.isSound) {
+                if (job.chunk != nullptr) sounds[job.name] = job.chunk;
+            } else if (job.surface != nullptr) {
+                TextureHandle texture = TextureCache::adoptSurface(renderer, job.name.c_str(), job.surface);
+                if (texture) textures.push_back(texture);
+                SDL_FreeSurface(job.surface);
+            } else {
+                SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                               "Could not load %s in background", job.name.c_str());
+            }
+            completed++;
+        }
+    }
+
+    bool done() const {
+        return completed == requested;
+    }
+
+    // 0..1, for the loading bar
+    float progress() const {
+        return requested == 0 ? 1.0f : static_cast<float>(completed) / requested;
+    }
+
+    // Take ownership of a decoded sound, nullptr if it failed or was not requested
+    Mix_Chunk* takeSound(const char* name) {
+        auto it = sounds.find(name);
+        if (it == sounds.end()) return nullptr;
+        Mix_Chunk* chunk = it->second;
+        sounds.erase(it);
+        return chunk;
+    }
+
+    // Drop the handles kept alive for the finished batch and reset the progress counters,
+    // call once whoever needed the textures (the level platforms) holds its own handles
+    void finishBatch() {
+        textures.clear();
+        requested = 0;
+        completed = 0;
+    }
+
+private:
+    struct Job {
+        std::string name;
+        bool isSound;
+        SDL_Surface* surface;
+        Mix_Chunk* chunk;
+    };
+
+    SDL_mutex* mutex;
+    SDL_cond* workAvailable;
+    bool stopping;
+    std::vector<SDL_Thread*> workers;
+    std::deque<Job> queue;       // waiting for a worker
+    std::deque<Job> finished;    // decoded, waiting for pump()
+
+    // Main thread only
+    int requested;
+    int completed;
+    std::vector<TextureHandle> textures;
+    std::map<std::string, Mix_Chunk*> sounds;
+
+    void queueJob(const char* name, bool isSound) {
+        Job job = {name, isSound, nullptr, nullptr};
+        requested++;
+
+        SDL_LockMutex(mutex);
+        queue.push_back(job);
+        SDL_CondSignal(workAvailable);
+        SDL_UnlockMutex(mutex);
+    }
+
+    static void freeJob(Job& job) {
+        if (job.surface) SDL_FreeSurface(job.surface);
+        if (job.chunk) Mix_FreeChunk(job.chunk);
+        job.surface = nullptr;
+        job.chunk = nullptr;
+    }
+
+    static int workerMain(void* data) {
+        AssetLoader* loader = static_cast<AssetLoader*>(data);
+        for (;;) {
+            SDL_LockMutex(loader->mutex);
+            while (loader->queue.empty() && !loader->stopping) {
+                SDL_CondWait(loader->workAvailable, loader->mutex);
+            }
+            if (loader->stopping) {
+                SDL_UnlockMutex(loader->mutex);
+                return 0;
+            }
+            Job job = loader->queue.front();
+            loader->queue.pop_front();
+            SDL_UnlockMutex(loader->mutex);
+
+            // Decode outside the lock, this is the expensive part
+            {
+                ALLOC_SCOPE(job.isSound ? ALLOC_AUDIO : ALLOC_LEVEL_LOAD);
+                SDL_RWops* rw = AssetArchive::openRW(job.name.c_str());
+                if (rw != nullptr) {
+                    if (job.isSound) job.chunk = Mix_LoadWAV_RW(rw, 1);
+                    else job.surface = IMG_Load_RW(rw, 1);
+                }
+            }
+
+            SDL_LockMutex(loader->mutex);
+            loader->finished.push_back(job);
+            SDL_UnlockMutex(loader->mutex);
+        }
+    }
+};
+
+#endif
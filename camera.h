@@ -0,0 +1,58 @@
+#ifndef _CAMERA__H
+#define _CAMERA__H
+#include <algorithm>
+#include <cmath>
+#include "defs.h"
+
+// Horizontal world-space camera, x is the world position of the left edge of the screen.
+// The player can move freely inside a dead zone around the middle of the screen; once they leave
+// it the camera eases towards the position that puts them back on its edge. The camera never
+// shows anything past either end of the level, so a one-screen level keeps x = 0.
+class Camera {
+public:
+    static constexpr double DEAD_ZONE_LEFT = 0.3;    // dead zone edges, in fractions of the screen width
+    static constexpr double DEAD_ZONE_RIGHT = 0.5;
+    static constexpr double FOLLOW_RATE = 6.0;       // per second, higher = catches up faster
+
+    double x;
+
+    Camera() : x(0), levelWidth(SCREEN_WIDTH) {}
+
+    void setLevelWidth(double width) {
+        levelWidth = std::max(width, static_cast<double>(SCREEN_WIDTH));
+        x = clamp(x);
+    }
+
+    double getLevelWidth() const { return levelWidth; }
+
+    // Jump straight to the target, for respawns and level starts
+    void snapTo(double targetX) {
+        x = clamp(targetX - SCREEN_WIDTH * DEAD_ZONE_LEFT);
+    }
+
+    // One physics step of smooth follow, frame rate independent: the remaining distance shrinks
+    // by the same factor every second whatever the step length is
+    void follow(double targetX, double step) {
+        double goal = x;
+        double left = x + SCREEN_WIDTH * DEAD_ZONE_LEFT;
+        double right = x + SCREEN_WIDTH * DEAD_ZONE_RIGHT;
+        if (targetX < left) goal = targetX - SCREEN_WIDTH * DEAD_ZONE_LEFT;
+        else if (targetX > right) goal = targetX - SCREEN_WIDTH * DEAD_ZONE_RIGHT;
+
+        x += (clamp(goal) - x) * (1.0 - std::exp(-FOLLOW_RATE * step));
+    }
+
+    // Is any part of [left, right] (world x) on screen
+    bool isVisible(double left, double right) const {
+        return right >= x && left <= x + SCREEN_WIDTH;
+    }
+
+private:
+    double levelWidth;
+
+    double clamp(double value) const {
+        return std::max(0.0, std::min(value, levelWidth - SCREEN_WIDTH));
+    }
+};
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef _CHROMETRACE__H
+#define _CHROMETRACE__H
+#include <SDL.h>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+// Streams the profiler zones to a Chrome trace file (chrome://tracing, ui.perfetto.dev), one
+// complete event ("ph":"X", begin + duration) per zone and one per frame, so hitches in a long
+// session show up as wide frames with the zone that ate them underneath.
+//
+// record() only appends raw counter values to a batch; a full batch is handed to a writer thread
+// that formats and writes it, the main thread never touches the file. Event names must be string
+// literals (they are written long after record() returns).
+class ChromeTrace {
+public:
+    static const size_t BATCH_EVENTS = 8192;    // ten seconds or so, a frame is a dozen events
+
+    static bool open(const char* path) {
+        State& s = state();
+        if (s.active) return false;
+        s.file = fopen(path, "wb");
+        if (s.file == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR, "Cannot write trace %s", path);
+            return false;
+        }
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}", s.file);
+
+        s.origin = SDL_GetPerformanceCounter();
+        s.usPerTick = 1e6 / SDL_GetPerformanceFrequency();
+        s.mutex = SDL_CreateMutex();
+        s.batchReady = SDL_CreateCond();
+        s.batchWritten = SDL_CreateCond();
+        s.pending = false;
+        s.stopping = false;
+        s.filling.reserve(BATCH_EVENTS);
+        s.writing.reserve(BATCH_EVENTS);
+        s.thread = SDL_CreateThread(writerMain, "ChromeTrace", &s);
+        s.active = true;
+        SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO, "Tracing to %s", path);
+        return true;
+    }
+
+    // Writes what is left and finishes the file, call before quitting
+    static void close() {
+        State& s = state();
+        if (!s.active) return;
+        if (!s.filling.empty()) handOff(s);
+
+        SDL_LockMutex(s.mutex);
+        s.stopping = true;
+        SDL_CondSignal(s.batchReady);
+        SDL_UnlockMutex(s.mutex);
+        if (s.thread != nullptr) SDL_WaitThread(s.thread, nullptr);
+
+        fputs("\n]}\n", s.file);
+        fclose(s.file);
+        s.file = nullptr;
+        SDL_DestroyCond(s.batchWritten);
+        SDL_DestroyCond(s.batchReady);
+        SDL_DestroyMutex(s.mutex);
+        s.thread = nullptr;
+        s.active = false;
+    }
+
+    static bool active() { return state().active; }
+
+    // Main thread only, start and end are SDL_GetPerformanceCounter values
+    static void record(const char* name, Uint64 start, Uint64 end) {
+        State& s = state();
+        if (!s.active) return;
+        Event event = {name, start, end};
+        s.filling.push_back(event);
+        if (s.filling.size() >= BATCH_EVENTS) handOff(s);
+    }
+
+private:
+    struct Event {
+        const char* name;
+        Uint64 start, end;
+    };
+
+    struct State {
+        bool active = false;
+        FILE* file = nullptr;                   // writer thread only while active
+        Uint64 origin = 0;
+        double usPerTick = 0;
+        SDL_mutex* mutex = nullptr;
+        SDL_cond* batchReady = nullptr;
+        SDL_cond* batchWritten = nullptr;
+        SDL_Thread* thread = nullptr;
+        bool pending = false;                   // writing holds a batch the thread has not written yet
+        bool stopping = false;
+        std::vector<Event> filling;             // main thread
+        std::vector<Event> writing;             // writer thread while pending
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    // Swap the full batch over to the writer, only waits if it is still busy with the previous one
+    static void handOff(State& s) {
+        SDL_LockMutex(s.mutex);
+        while (s.pending && s.thread != nullptr) {
+            SDL_CondWait(s.batchWritten, s.mutex);
+        }
+        std::swap(s.filling, s.writing);
+        s.pending = true;
+        SDL_CondSignal(s.batchReady);
+        SDL_UnlockMutex(s.mutex);
+        s.filling.clear();
+
+        // No thread (could not be created), write it here instead
+        if (s.thread == nullptr) {
+            writeBatch(s);
+            s.pending = false;
+        }
+    }
+
+    static void writeBatch(State& s) {
+        for (const Event& event : s.writing) {
+            fprintf(s.file, ",\n{\"name\":\"%s\",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    event.name, (event.start - s.origin) * s.usPerTick, (event.end - event.start) * s.usPerTick);
+        }
+        fflush(s.file);
+        s.writing.clear();
+    }
+
+    static int writerMain(void* data) {
+        State& s = *static_cast<State*>(data);
+        for (;;) {
+            SDL_LockMutex(s.mutex);
+            while (!s.pending && !s.stopping) {
+                SDL_CondWait(s.batchReady, s.mutex);
+            }
+            if (!s.pending) {
+                SDL_UnlockMutex(s.mutex);
+                return 0;
+            }
+            SDL_UnlockMutex(s.mutex);
+
+            // Formatting and writing happen outside the lock, the main thread keeps filling
+            writeBatch(s);
+
+            SDL_LockMutex(s.mutex);
+            s.pending = false;
+            SDL_CondSignal(s.batchWritten);
+            SDL_UnlockMutex(s.mutex);
+        }
+    }
+};
+
+#endif
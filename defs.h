@@ -8,7 +8,9 @@ const char* WINDOW_TITLE = "Hello World!";
 float t = 0.01;
 int jakobsenit = 20;
  // Physics constants
-const double dt = 0.016;             // Time step
+const double dt = 0.016;             // Simulated time one physics step advances
+const int STEPS_PER_SECOND = 60;     // Physics steps per second of play, game time in the tools counts these
+const double STEP_SECONDS = 1.0 / STEPS_PER_SECOND;  // Real time between steps, each still advances dt
 const double GRAVITY = 170.0;        // Reduced gravity for better jumping arcs
 const double DRAG = 0.99;            // Minimal drag to preserve momentum
 const double MAX_SPEED = 1200.0;     // Increased for better jumping between platforms
@@ -22,6 +24,11 @@ const double SWING_BOOST = 1.5;      // Momentum boost when swinging aggressivel
 const double JUMP_BOOST = 1.4;       // Increased velocity boost for better tossing
 const double FORWARD_TOSS = 300.0;   // Forward momentum when releasing
 const double UPWARD_BOOST = 80.0;    // Reduced upward boost when releasing
+ // Player: spawn point (the body starts 500 above it), body radius and particles per rope
+const double PLAYER_START_X = 300.0;
+const double PLAYER_START_Y = 100.0;
+const double PLAYER_RADIUS = 30.0;
+const int PLAYER_HAND_PARTICLES = 10;
 static const Uint32 RESPAWN_COOLDOWN = 1000;  // 1 second cooldown after respawn
 const int BASE_BUTTON_WIDTH = 200;  // Base width, will be adjusted to actual image size
 const int BASE_BUTTON_HEIGHT = 200; // Base height, will be adjusted to actual image size
@@ -0,0 +1,137 @@
+#ifndef _FRAMEARENA__H
+#define _FRAMEARENA__H
+#include <SDL.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "heap_check.h"
+
+// Bump allocator for data that lives one frame: allocate() moves a pointer through one block,
+// reset() at the end of the frame takes everything back at once. Nothing is freed on its own.
+// A frame that needs more than the block spills into extra blocks that reset() frees, and the
+// block is then regrown so the next frame like it fits.
+//
+// Memory comes from SDL_malloc, not operator new, so HeapCheck does not count the arena itself,
+// only a spill (a frame that outgrew the block is worth hearing about).
+// One arena per thread; the main loop owns one.
+class FrameArena {
+public:
+    static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY)
+        : block(nullptr), capacity(0), used(0), peak(0), framePeak(0), spills(nullptr) {
+        grow(capacity);
+    }
+
+    ~FrameArena() {
+        freeSpills();
+        SDL_free(block);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        size_t start = (used + alignment - 1) & ~(alignment - 1);
+        if (block != nullptr && start + bytes <= capacity) {
+            used = start + bytes;
+            framePeak = std::max(framePeak, used);
+            return block + start;
+        }
+        return spill(bytes, alignment);
+    }
+
+    // End of frame: everything handed out since the last reset is gone
+    void reset() {
+        if (spills != nullptr) {
+            freeSpills();
+            grow(framePeak + framePeak / 2);
+        }
+        peak = std::max(peak, framePeak);
+        used = 0;
+        framePeak = 0;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t bytesReserved() const { return capacity; }
+    size_t peakBytes() const { return std::max(peak, framePeak); }
+
+private:
+    // Extra blocks are chained through a header in front of them
+    struct Spill {
+        Spill* next;
+    };
+
+    char* block;
+    size_t capacity;
+    size_t used;
+    size_t peak;        // largest frame so far
+    size_t framePeak;   // this frame, spills included
+    Spill* spills;
+
+    void grow(size_t bytes) {
+        if (bytes <= capacity) return;
+        SDL_free(block);
+        block = static_cast<char*>(SDL_malloc(bytes));
+        capacity = block != nullptr ? bytes : 0;
+        if (block == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "FrameArena: cannot reserve %u bytes", static_cast<unsigned>(bytes));
+        }
+    }
+
+    void* spill(size_t bytes, size_t alignment) {
+        HeapCheck::allocated();
+        size_t header = (sizeof(Spill) + alignment - 1) & ~(alignment - 1);
+        Spill* extra = static_cast<Spill*>(SDL_malloc(header + bytes + alignment));
+        if (extra == nullptr) throw std::bad_alloc();
+        extra->next = spills;
+        spills = extra;
+        framePeak += bytes;
+
+        uintptr_t address = reinterpret_cast<uintptr_t>(extra) + header;
+        address = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        return reinterpret_cast<void*>(address);
+    }
+
+    void freeSpills() {
+        while (spills != nullptr) {
+            Spill* next = spills->next;
+            SDL_free(spills);
+            spills = next;
+        }
+    }
+};
+
+// std allocator on top of a FrameArena. deallocate() does nothing, the memory comes back with the
+// arena's reset(), so a container using it must not outlive the frame.
+template <typename T>
+struct FrameAllocator {
+    typedef T value_type;
+
+    FrameArena* arena;
+
+    explicit FrameAllocator(FrameArena& frameArena) : arena(&frameArena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif
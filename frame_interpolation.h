@@ -0,0 +1,111 @@
+#ifndef _FRAMEINTERPOLATION__H
+#define _FRAMEINTERPOLATION__H
+#include <cmath>
+#include <vector>
+#include "graphics.h"
+
+// Everything the PLAYING renderer draws that physics moves: the player, both ropes, the platforms,
+// the spike wall and the camera. The fixed-step loop keeps the state before the last physics step,
+// and rendering blends it with the current state by the leftover accumulator fraction, so the
+// picture stays smooth on any refresh rate while physics always runs at the same rate.
+struct PhysicsSnapshot {
+    // Anything that moved further than this in one step was teleported (respawn, level reset)
+    // and is drawn at its new place instead of sliding across the screen
+    static constexpr double TELEPORT_DISTANCE = 150.0;
+
+    bool valid = false;
+    double cameraOffsetX = 0;
+    double playerX = 0, playerY = 0;
+    std::vector<double> leftX, leftY, rightX, rightY;
+    std::vector<SDL_Point> platformPositions;
+    SDL_Point spikeWallPosition = {0, 0};
+
+    void capture(const Graphics& core, const Character& player, double camera, const MovingObject* spikeWall) {
+        cameraOffsetX = camera;
+        playerX = player.x;
+        playerY = player.y;
+        copyRope(player.leftHand, leftX, leftY);
+        copyRope(player.rightHand, rightX, rightY);
+
+        // Sized like the platform vector's capacity, not its size: slots spawned later in the level
+        // then fit without growing the snapshots
+        platformPositions.reserve(core.platforms.capacity());
+        platformPositions.resize(core.platforms.size());
+        for (size_t i = 0; i < core.platforms.size(); i++) {
+            platformPositions[i] = {core.platforms[i].rect.x, core.platforms[i].rect.y};
+        }
+        if (spikeWall) spikeWallPosition = {spikeWall->rect.x, spikeWall->rect.y};
+        valid = true;
+    }
+
+    // Write this snapshot back into the live objects
+    void apply(Graphics& core, Character& player, double& camera, MovingObject* spikeWall) const {
+        camera = cameraOffsetX;
+        player.x = playerX;
+        player.y = playerY;
+        pasteRope(player.leftHand, leftX, leftY);
+        pasteRope(player.rightHand, rightX, rightY);
+
+        for (size_t i = 0; i < core.platforms.size() && i < platformPositions.size(); i++) {
+            core.platforms[i].rect.x = platformPositions[i].x;
+            core.platforms[i].rect.y = platformPositions[i].y;
+        }
+        if (spikeWall) {
+            spikeWall->rect.x = spikeWallPosition.x;
+            spikeWall->rect.y = spikeWallPosition.y;
+        }
+    }
+
+    // this = previous + (current - previous) * alpha, per value
+    void blend(const PhysicsSnapshot& previous, const PhysicsSnapshot& current, double alpha) {
+        platformPositions.reserve(current.platformPositions.capacity());
+        *this = current;
+        if (!previous.valid || previous.platformPositions.size() != current.platformPositions.size() ||
+            previous.leftX.size() != current.leftX.size() || previous.rightX.size() != current.rightX.size()) {
+            return;  // different level or rope, nothing sensible to blend with
+        }
+
+        cameraOffsetX = lerp(previous.cameraOffsetX, current.cameraOffsetX, alpha);
+        playerX = lerp(previous.playerX, current.playerX, alpha);
+        playerY = lerp(previous.playerY, current.playerY, alpha);
+        for (size_t i = 0; i < leftX.size(); i++) {
+            leftX[i] = lerp(previous.leftX[i], current.leftX[i], alpha);
+            leftY[i] = lerp(previous.leftY[i], current.leftY[i], alpha);
+        }
+        for (size_t i = 0; i < rightX.size(); i++) {
+            rightX[i] = lerp(previous.rightX[i], current.rightX[i], alpha);
+            rightY[i] = lerp(previous.rightY[i], current.rightY[i], alpha);
+        }
+        for (size_t i = 0; i < platformPositions.size(); i++) {
+            platformPositions[i].x = lerpInt(previous.platformPositions[i].x, current.platformPositions[i].x, alpha);
+            platformPositions[i].y = lerpInt(previous.platformPositions[i].y, current.platformPositions[i].y, alpha);
+        }
+        spikeWallPosition.x = lerpInt(previous.spikeWallPosition.x, current.spikeWallPosition.x, alpha);
+        spikeWallPosition.y = lerpInt(previous.spikeWallPosition.y, current.spikeWallPosition.y, alpha);
+    }
+
+private:
+    static double lerp(double from, double to, double alpha) {
+        if (std::fabs(to - from) > TELEPORT_DISTANCE) return to;
+        return from + (to - from) * alpha;
+    }
+
+    static int lerpInt(int from, int to, double alpha) {
+        return static_cast<int>(std::lround(lerp(from, to, alpha)));
+    }
+
+    static void copyRope(const ropehand& hand, std::vector<double>& xs, std::vector<double>& ys) {
+        xs.assign(hand.parti.x, hand.parti.x + hand.parti.size());
+        ys.assign(hand.parti.y, hand.parti.y + hand.parti.size());
+    }
+
+    // Only current positions, previous positions (the Verlet velocity) are left alone
+    static void pasteRope(ropehand& hand, const std::vector<double>& xs, const std::vector<double>& ys) {
+        for (int i = 0; i < hand.parti.size() && i < static_cast<int>(xs.size()); i++) {
+            hand.parti.x[i] = xs[i];
+            hand.parti.y[i] = ys[i];
+        }
+    }
+};
+
+#endif
@@ -8,20 +8,21 @@
 #include <cstdlib> // For rand()
 #include <cstring> // For strstr()
 #include <SDL_mixer.h>
+#include <utility>
+#include "texture_atlas.h"
+#include "rope_renderer.h"
+#include "particle_buffer.h"
+#include "rope_solver.h"
+#include "spatial_grid.h"
+#include "camera.h"
+#include "input_frame.h"
+#include "profiler.h"
 
 using std::vector;
 
-struct Particle {
-    double xCurrent;
-    double yCurrent;
-    double xPrevious;
-    double yPrevious;
-    bool checkmovement;
-};
-
 struct Platform {
     SDL_Rect rect;
-    SDL_Texture* texture;
+    Sprite sprite;        // atlas region, or the whole texture for the big platforms
     double visualHeight;  // Actual visual height of the platform texture
     bool isSpike;        // New flag to identify if this platform is a spike
 
@@ -34,44 +35,40 @@ struct Platform {
 
     // Interactive platform properties
     bool isInteractive;
-    SDL_Texture* alternateTexture;
+    Sprite alternateSprite;
     bool activated;
 // constructor for basic, non moving platforms
-    Platform(SDL_Rect r, SDL_Texture* t, bool spike = false)
-        : rect(r), texture(t), isSpike(spike), isMoving(false),
+    Platform(SDL_Rect r, const Sprite& s, bool spike = false)
+        : rect(r), sprite(s), isSpike(spike), isMoving(false),
           startX(0), endX(0), speed(0), movingForward(true), movesVertically(false),
-          isInteractive(false), alternateTexture(nullptr), activated(false) {
-        // Get the actual texture dimensions
-        int w, h;
-        SDL_QueryTexture(t, NULL, NULL, &w, &h);
-        visualHeight = h;
+          isInteractive(false), activated(false) {
+        // Actual image height, the sprite knows its own size
+        visualHeight = s.src.h;
     }
 
     // Constructor for moving platforms
-    Platform(SDL_Rect r, SDL_Texture* t, float startPos, float endPos, float moveSpeed, bool spike = false)
-        : rect(r), texture(t), isSpike(spike), isMoving(true),
+    Platform(SDL_Rect r, const Sprite& s, float startPos, float endPos, float moveSpeed, bool spike = false)
+        : rect(r), sprite(s), isSpike(spike), isMoving(true),
           startX(startPos), endX(endPos), speed(moveSpeed), movingForward(true), movesVertically(false),
-          isInteractive(false), alternateTexture(nullptr), activated(false) {
-        // Get the actual texture dimensions
-        int w, h;
-        SDL_QueryTexture(t, NULL, NULL, &w, &h);
-        visualHeight = h;
+          isInteractive(false), activated(false) {
+        // Actual image height, the sprite knows its own size
+        visualHeight = s.src.h;
         rect.x = static_cast<int>(startX); // Initialize position
     }
 
     // Constructor for interactive platforms
-    Platform(SDL_Rect r, SDL_Texture* t, SDL_Texture* altTexture)
-        : rect(r), texture(t), isSpike(false), isMoving(false),
+    Platform(SDL_Rect r, const Sprite& s, const Sprite& altSprite)
+        : rect(r), sprite(s), isSpike(false), isMoving(false),
           startX(0), endX(0), speed(0), movingForward(true), movesVertically(false),
-          isInteractive(true), alternateTexture(altTexture), activated(false) {
-        // Get the actual texture dimensions
-        int w, h;
-        SDL_QueryTexture(t, NULL, NULL, &w, &h);
-        visualHeight = h;
+          isInteractive(true), alternateSprite(altSprite), activated(false) {
+        // Actual image height, the sprite knows its own size
+        visualHeight = s.src.h;
     }
 
-    void update(float deltaTime = 1.0f) {
+    // grid/index: keep the platform filed under the right cells when it moves
+    void update(float deltaTime = 1.0f, PlatformGrid* grid = nullptr, int index = -1) {
         if (!isMoving) return;
+            SDL_Rect oldRect = rect;
             if (movingForward) {
                 rect.x += static_cast<int>(speed * deltaTime);
                 if (rect.x >= endX) {
@@ -85,6 +82,7 @@ struct Platform {
                     movingForward = true;
                 }
             }
+            if (grid != nullptr) grid->move(index, oldRect, rect);
         }
         // when the platform reaches endX or startX it reverses
 
@@ -92,1119 +90,1071 @@ struct Platform {
     void activate() {
         if (isInteractive && !activated) {
             activated = true;
-            // Swap textures
-            SDL_Texture* temp = texture;
-            texture = alternateTexture;
-            alternateTexture = temp;
+            // Swap sprites
+            std::swap(sprite, alternateSprite);
         }
     }
 };
 
-// Add struct for moving objects like the spike wall
-struct MovingObject {
-    SDL_Rect rect;
-    SDL_Texture* texture;
-    float velocityX;
-    float velocityY;
-    float startX;
-    float startY;
+// Non-owning view of the live platform list (pointer + count), collision and grab code read the
+// platforms in place through it instead of taking a copy
+struct PlatformView {
+    const Platform* first;
+    int count;
 
-    MovingObject(SDL_Rect r, SDL_Texture* t, float vx = 0, float vy = 0) :
-        rect(r), texture(t), velocityX(vx), velocityY(vy), startX(r.x), startY(r.y) {}
+    PlatformView() : first(nullptr), count(0) {}
+    PlatformView(const std::vector<Platform>& platforms)
+        : first(platforms.data()), count(static_cast<int>(platforms.size())) {}
 
-    void update() {
-        rect.x += velocityX;
-        rect.y += velocityY;
+    const Platform& operator[](int i) const { return first[i]; }
+    int size() const { return count; }
+    const Platform* begin() const { return first; }
+    const Platform* end() const { return first + count; }
+};
+
+// One rope as the player physics reads and writes it, particle p at index p * stride of the arrays:
+// a ropehand's own buffer has stride 1, one instance of SimulationBatch's ropes the batch's lane count
+struct RopeView {
+    double* x;
+    double* y;
+    double* px;
+    double* py;
+    uint64_t* pinned;
+    int count;
+    int stride;
+    double maxLength;   // farthest the hand gets from the body while it holds nothing
+
+    RopeView(ParticleBuffer& parti, double length)
+        : x(parti.x), y(parti.y), px(parti.px), py(parti.py), pinned(parti.pinned),
+          count(parti.size()), stride(1), maxLength(length) {}
+
+    // Lane lane of a buffer holding particle p's lanes at [p * laneCount, (p + 1) * laneCount)
+    RopeView(ParticleBuffer& lanes, int lane, int laneCount, int particles, double length)
+        : x(lanes.x + lane), y(lanes.y + lane), px(lanes.px + lane), py(lanes.py + lane),
+          pinned(lanes.pinned + lane), count(particles), stride(laneCount), maxLength(length) {}
+
+    int at(int p) const { return p * stride; }
+    int last() const { return count - 1; }
+    double handX() const { return x[at(last())]; }
+    double handY() const { return y[at(last())]; }
+    bool isPinned(int p) const { return pinned[at(p)] != 0; }
+    void setPinned(int p, bool value) { pinned[at(p)] = value ? ~uint64_t(0) : 0; }
+
+    void place(int p, double newX, double newY) {
+        x[at(p)] = px[at(p)] = newX;
+        y[at(p)] = py[at(p)] = newY;
     }
 
-    void reset() {
-        rect.x = startX;
-        rect.y = startY;
+    void translate(double dx, double dy) {
+        for (int p = 0; p < count; p++) {
+            x[at(p)] += dx;
+            px[at(p)] += dx;
+            y[at(p)] += dy;
+            py[at(p)] += dy;
+        }
     }
 };
 
-struct Graphics {
-    SDL_Renderer *renderer;
-    SDL_Window *window;
-    SDL_Texture* characterTexture;
-    SDL_Texture* handTexture;
-    SDL_Texture* congratulationsTexture;
-    SDL_Texture* guideTexture;  // Add guide texture
-    SDL_Texture* acedTexture;   // Add aced texture
-    std::vector<Platform> platforms;
+// The player's body and both ropes, for PlayerPhysics. Character makes one of itself, SimulationBatch
+// one per instance. grabbing is read when the view is made, grabs and releases go through the owner.
+struct PlayerBody {
+    double& x;
+    double& y;
+    double& vx;
+    double& vy;
+    double& swingEnergy;
+    double& maxSwingSpeed;
+    double& facingDirection;
+    double radius;
+    RopeView hands[2];      // [0] left, [1] right
+    bool grabbing[2];
+};
 
-    Graphics() : window(nullptr), renderer(nullptr), characterTexture(nullptr),
-                handTexture(nullptr), congratulationsTexture(nullptr), guideTexture(nullptr),
-                acedTexture(nullptr) {}
+// The scalar player step, written once for Character and for every SimulationBatch instance, so the
+// two stay the same bits. Only the rope integration and constraints live elsewhere (ropehand, and the
+// batch's SIMD kernels across instances); the broad phase queries are the caller's too.
+class PlayerPhysics {
+public:
+    static constexpr double ROPE_BOUNCE = 0.1;          // Reduced bounce factor
+    // Moving platforms nudge the relative velocity by a fraction of a pixel, this covers it
+    static constexpr double ROPE_QUERY_MARGIN = 16.0;
+
+    static void applySwingForces(PlayerBody& body, const InputFrame& input) {
+        double& x = body.x;
+        double& y = body.y;
+        double& vx = body.vx;
+        double& vy = body.vy;
+        RopeView& leftHand = body.hands[0];
+        RopeView& rightHand = body.hands[1];
 
-    void logErrorAndExit(const char* msg, const char* error)
-    {
-        SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR, "%s: %s", msg, error);
-        SDL_Quit();
-    }
+        // Handle case when both hands are grabbing
+        if (body.grabbing[0] && body.grabbing[1]) {
+            // Get both grab points
+            double leftX = leftHand.handX();
+            double leftY = leftHand.handY();
+            double rightX = rightHand.handX();
+            double rightY = rightHand.handY();
 
-    void init() {
-        if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
-            logErrorAndExit("SDL_Init", SDL_GetError());
+            // Calculate midpoint between hands
+            double midX = (leftX + rightX) / 2.0;
+            double midY = (leftY + rightY) / 2.0;
 
-        // Initialize SDL_mixer
-        if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-            logErrorAndExit("Mix_OpenAudio", Mix_GetError());
-        }
+            // Calculate distance between hands
+            double handDistance = sqrt(pow(rightX - leftX, 2) + pow(rightY - leftY, 2));
 
-        // Initialize SDL_image
-        int imgFlags = IMG_INIT_PNG;
+            // Maximum allowed distance between character and midpoint
+            double maxDistance = handDistance * 0.5; // Character can't be more than half the hand distance away
 
-        window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+            // Calculate current distance from midpoint
+            double currentDistance = sqrt(pow(x - midX, 2) + pow(y - midY, 2));
 
-        if (window == nullptr) logErrorAndExit("CreateWindow", SDL_GetError());
-        SDL_SetWindowResizable(window, SDL_TRUE);
-        SDL_MaximizeWindow(window);
+            // If character is too far from midpoint, pull it back
+            if (currentDistance > maxDistance) {
+                double ratio = maxDistance / currentDistance;
+                x = midX + (x - midX) * ratio;
+                y = midY + (y - midY) * ratio;
+            }
 
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED |
-                                              SDL_RENDERER_PRESENTVSYNC);
+            // Apply gravity
+            vy += GRAVITY * 0.7 * dt;
+            return;
+        } // dam bao nhan vat ko qua midpoint
 
-        if (renderer == nullptr) logErrorAndExit("CreateRenderer", SDL_GetError());
+        // Original single-hand grabbing code
+        if (!(body.grabbing[0] ^ body.grabbing[1])) {
+            // In free fall, just apply gravity
+            vy += GRAVITY * dt;
+            return;
+        }
 
-        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
-        SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+        // Get the pivot point (the grabbing hand's position)
+        bool isRightHandGrabbing = body.grabbing[1];
+        RopeView& pivotHand = isRightHandGrabbing ? rightHand : leftHand;
+        RopeView& freeHand = isRightHandGrabbing ? leftHand : rightHand;
+        double pivotX = pivotHand.handX();
+        double pivotY = pivotHand.handY();
 
-        // Load congratulations texture
-        congratulationsTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\congrat.png");
-        // Load guide image
-        guideTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\guidefinalroi.png");
-        if (guideTexture == nullptr) {
-            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION,
-                          SDL_LOG_PRIORITY_ERROR,
-                          "Could not load guide image! SDL_Error: %s", SDL_GetError());
-        }
+        // Get input direction
+        double inputX = 0, inputY = 0;
+        if (input.held(InputFrame::UP)) inputY -= 1;
+        if (input.held(InputFrame::DOWN)) inputY += 1;
+        if (input.held(InputFrame::LEFT)) inputX -= 1;
+        if (input.held(InputFrame::RIGHT)) inputX += 1;
 
-        // Load aced image
-        acedTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\aced-Photoroom.png");
-        if (acedTexture == nullptr) {
-            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION,
-                          SDL_LOG_PRIORITY_ERROR,
-                          "Could not load aced image! SDL_Error: %s", SDL_GetError());
-        }
-    }
+        // For the free hand - let natural rope physics handle it most of the time,
+        // but apply an upward force on UP key specifically
+        int hand = freeHand.at(freeHand.last());
+        double& handX = freeHand.x[hand];
+        double& handY = freeHand.y[hand];
+        double& handVX = freeHand.px[hand];  // Using previous position to store velocity
+        double& handVY = freeHand.py[hand];
 
-    void renderCongratulations() {
-        if (congratulationsTexture) {
-            // Center the congratulations image on screen but make it smaller
-            int w, h;
-            SDL_QueryTexture(congratulationsTexture, NULL, NULL, &w, &h);
+        // Calculate current hand velocity
+        double handVelocityX = handX - handVX;
+        double handVelocityY = handY - handVY;
 
-            // Scale down the image to half size
-            w = w / 2;
-            h = h / 2;
+        // Apply gentler upward force when UP key is pressed - special case
+        if (inputY < 0) {
+            // Apply upward force to the free hand - more gradual
+            handVelocityY += inputY * HAND_FORCE * 0.8 * dt; // Reduced to 80% for more visibility
 
-            SDL_Rect destRect = {
-                SCREEN_WIDTH/2 - w/2,  // Center horizontally
-                SCREEN_HEIGHT/2 - h/2, // Center vertically
-                w,                     // Scaled width
-                h                      // Scaled height
-            };
-            SDL_RenderCopy(renderer, congratulationsTexture, NULL, &destRect);
+            // Add small lift to body for air climbing (reduced)
+            vy -= FLAP_LIFT * 0.7 * dt;
         }
-    }
+        //lên thì nâng ng lên cho tay free
 
-    void renderHowToPlay() {
-        if (guideTexture == nullptr) {
-            guideTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\guidefinalroi.png");
-            if (guideTexture == nullptr) {
-                logErrorAndExit("Could not load guide image", IMG_GetError());
-            }
+        // Apply horizontal force to free hand for directional swing control
+        if (inputX != 0) {
+            handVelocityX += inputX * HAND_FORCE * 0.6 * dt;
         }
+        // dua vao phim mui ten ma tang hay giam velo
 
-        int guideWidth, guideHeight;
-        SDL_QueryTexture(guideTexture, NULL, NULL, &guideWidth, &guideHeight);
-
-        // Center the guide image on screen
-        SDL_Rect guideRect = {
-            (SCREEN_WIDTH - guideWidth) / 2,
-            (SCREEN_HEIGHT - guideHeight) / 2 + 25, // Decreased from 30 to 25 to move it up 5 more pixels
-            guideWidth,
-            guideHeight
-        };
-
-        SDL_RenderCopy(renderer, guideTexture, NULL, &guideRect);
-    }
-
-    void renderAced() {
-        if (!acedTexture) return;
+        // Apply minimal damping to preserve momentum
+        handVelocityX *= 0.98; // Slightly more damping for smoother motion
+        handVelocityY *= 0.98;
 
-        // Get texture dimensions
-        int texWidth, texHeight;
-        SDL_QueryTexture(acedTexture, NULL, NULL, &texWidth, &texHeight);
+        // Update hand position with gentler movement
+        handX = handVX + handVelocityX;
+        handY = handVY + handVelocityY;
 
-        // Calculate smaller size (70% of original)
-        int newWidth = static_cast<int>(texWidth * 0.7);
-        int newHeight = static_cast<int>(texHeight * 0.7);
+        // Store velocity for next frame
+        handVX = handX - handVelocityX;
+        handVY = handY - handVelocityY;
 
-        // Calculate position to center on screen
-        SDL_Rect destRect = {
-            (SCREEN_WIDTH - newWidth) / 2,
-            (SCREEN_HEIGHT - newHeight) / 2,
-            newWidth,
-            newHeight
-        };
+        // Calculate tangential velocity (velocity along the swing arc)
+        double dx = x - pivotX; // x dis tu Pivot den C
+        double dy = y - pivotY;
+        double distance = sqrt(dx*dx + dy*dy);
 
-        // Render the texture
-        SDL_RenderCopy(renderer, acedTexture, NULL, &destRect);
-    }
+        if (distance < 0.0001) return; // Avoid division by zero
 
-    ~Graphics() {
-        if (window != nullptr) {
-            SDL_DestroyWindow(window);
-            window = nullptr;
-        }
-        if (renderer != nullptr) {
-            SDL_DestroyRenderer(renderer);
-            renderer = nullptr;
-        }
-        if (characterTexture != nullptr) {
-            SDL_DestroyTexture(characterTexture);
-            characterTexture = nullptr;
-        }
-        if (handTexture != nullptr) {
-            SDL_DestroyTexture(handTexture);
-            handTexture = nullptr;
-        }
-        if (congratulationsTexture != nullptr) {
-            SDL_DestroyTexture(congratulationsTexture);
-            congratulationsTexture = nullptr;
-        }
-        if (guideTexture != nullptr) {
-            SDL_DestroyTexture(guideTexture);
-            guideTexture = nullptr;
-        }
-        if (acedTexture != nullptr) {
-            SDL_DestroyTexture(acedTexture);
-            acedTexture = nullptr;
-        }
+        // Calculate tangent direction (perpendicular to radius)
+        double tangentX = -dy / distance;
+        double tangentY = dx / distance; // de lay vecto chuan hoa cua vecto vuong goc
 
-        // Cleanup platforms
-        for (auto& platform : platforms) {
-            if (platform.texture) {
-                SDL_DestroyTexture(platform.texture);
-            }
-        }
-    }
-};
+        // Project current velocity onto tangent
+        double tangentialSpeed = vx * tangentX + vy * tangentY; // how fast ủr going from side to side
 
-class ropehand {
-public:
-    bool isGrabbingObject;
-    static const int jakobsenit = 10;  // Reduced for more stable physics
-    vector<Particle> parti;
-    double maxLength;
-    double currentLength;
-    SDL_Texture* handTexture;
-    SDL_Texture* grabTexture;  // New texture for grabbing state
-    bool isLeftHand;
-    // Add color property for the rope
-    SDL_Color ropeColor;
+        // Apply gravity as a tangential force - increased for better swinging
+        double gravityAngle = atan2(dy, dx);
+        double gravityTangentialComponent = GRAVITY * 1.2 * cos(gravityAngle); // Increased gravity effect for better swing, goc tu pivot den body
+        tangentialSpeed += gravityTangentialComponent * dt;
 
-    // Keep platform tracking for debugging purposes
-    int grabbedPlatformIndex;  // Index of the grabbed platform in platforms vector
+        // Normalize input direction for body control
+        double inputLength = sqrt(inputX*inputX + inputY*inputY);
+        if (inputLength > 0) {
+            inputX /= inputLength;
+            inputY /= inputLength;
 
-    ropehand(SDL_Renderer* renderer, double x1, double x2, double y1, double y2, int numberofparticles, bool isLeft)
-        : isGrabbingObject(false), isLeftHand(isLeft), grabbedPlatformIndex(-1) {
-        maxLength = sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2));  // Calculate maximum length
-        currentLength = maxLength;
+            // Apply input to tangential speed - for body swing control
+            double controlForce = 700.0; // Increased force for better swinging
+            double swingControl = (inputX * tangentX + inputY * tangentY) * controlForce * dt; // dot product cua input va cai goc quay
+            tangentialSpeed += swingControl;
 
-        // Default rope color is red
-        ropeColor = {255, 0, 0, 255};  // Red color (R,G,B,A)
+            // Apply slight upward boost when pressing Up, to make higher jumps possible
+            if (inputY < 0) {
+                // Apply reduced upward component to the body when pressing up
+                vy -= 40.0 * dt; // Reduced from 80.0
+            }
 
-        // Load release hand texture based on hand type
-        const char* releasePath = isLeft ? "F:\\Game\\graphic\\lefthandrelease.png" : "F:\\Game\\graphic\\righthandrelease.png";
-        SDL_Surface* surface = IMG_Load(releasePath);
-        if (surface) {
-            handTexture = SDL_CreateTextureFromSurface(renderer, surface);
-            SDL_FreeSurface(surface);
-        }
-        // Load grab hand texture based on hand type
-        const char* grabPath = isLeft ? "F:\\Game\\graphic\\grableft.png" : "F:\\Game\\graphic\\grabright.png";
-        surface = IMG_Load(grabPath);
-        if (surface) {
-            grabTexture = SDL_CreateTextureFromSurface(renderer, surface);
-            SDL_FreeSurface(surface);
+            // Add extra horizontal momentum when pressing left/right
+            // This helps create more of a tossing motion
+            if (inputX != 0) {
+                // Add extra horizontal momentum in the direction of input
+                vx += inputX * 50.0 * dt;
+            }
         }
-        //cong thuc li: position = (1 - t) * start + t * end(cong thuc noi suy tuyen tinh de suy ra vi tri cua tung particle)
-        for (int i = 0; i < numberofparticles; i++) {
-            double weightforlerp = (double)i/(numberofparticles - 1);
-            double x = (1 - weightforlerp)*x1 + weightforlerp*x2;
-            double y = (1 - weightforlerp)*y1 + weightforlerp*y2;
-            Particle pn;
-            pn.xCurrent = x;
-            pn.yCurrent = y;
-            pn.xPrevious = x;
-            pn.yPrevious = y;
-            pn.checkmovement = (i == 0);  // First particle is fixed to body
-            parti.push_back(pn);
-        } // vdu parti 5 hat thi co cac vi tri la 0, 0,25, 0,5...
-        int segments = numberofparticles - 1;
-        desireddistance = maxLength/segments; // dam bao cac hat cach nhau 1 khoang nhat dinh
-    }
 
-    ~ropehand() {
-        if (handTexture) {
-            SDL_DestroyTexture(handTexture);
-            handTexture = nullptr;
-        }
-        if (grabTexture) {
-            SDL_DestroyTexture(grabTexture);
-            grabTexture = nullptr;
-        }
-    }
+        // Apply a boost at the bottom of the swing (when gravity is pulling downward)
+        // This creates a more natural swinging motion and builds momentum
+        if (dy > 0 && tangentialSpeed != 0) {
+            double boostMultiplier = std::min(1.0, std::abs(dy) / (ROPE_LENGTH * 0.75));
+            double boostForce = 250.0 * boostMultiplier; // Increased boost for better jumps
+            tangentialSpeed += (tangentialSpeed > 0 ? boostForce : -boostForce) * dt;
 
-    void render(SDL_Renderer* renderer) {
-        // Use the rope color for drawing the rope
-        SDL_SetRenderDrawColor(renderer, ropeColor.r, ropeColor.g, ropeColor.b, ropeColor.a);
-
-        for (size_t i = 0; i < parti.size() - 1; i++) {
-            // Draw multiple lines to create a thicker rope
-            for (int offset = -2; offset <= 2; offset++) {
-                SDL_RenderDrawLine(renderer,
-                    static_cast<int>(parti[i].xCurrent),
-                    static_cast<int>(parti[i].yCurrent + offset),
-                    static_cast<int>(parti[i + 1].xCurrent),
-                    static_cast<int>(parti[i + 1].yCurrent + offset));
-            }
-            for (int offset = -2; offset <= 2; offset++) {
-                SDL_RenderDrawLine(renderer,
-                    static_cast<int>(parti[i].xCurrent + offset),
-                    static_cast<int>(parti[i].yCurrent),
-                    static_cast<int>(parti[i + 1].xCurrent + offset),
-                    static_cast<int>(parti[i + 1].yCurrent));
+            // Add slight upward impulse at bottom of swing for better arc (reduced)
+            if (std::abs(dx) < ROPE_LENGTH * 0.5) {
+                vy -= 10.0 * boostMultiplier * dt; // Reduced from 20.0
             }
         }
 
-        // Draw hand at the end of the rope, check xem co grab ko, grab thi load anh grab
-        SDL_Texture* currentTexture = isGrabbingObject ? grabTexture : handTexture;
-        if (currentTexture) {
-            int handWidth = 40;
-            int handHeight = 40;
+        // Update position based on tangential velocity
+        x += tangentX * tangentialSpeed * dt;
+        y += tangentY * tangentialSpeed * dt;
 
-            // tính hướng dây đoạn cuối, 2 cái parti cuối ấy, xoay tay theo hướng dây, tn2(dx,y) là góc giữa trục ox và vector dxx dy
-            double dx = parti.back().xCurrent - parti[parti.size()-2].xCurrent;
-            double dy = parti.back().yCurrent - parti[parti.size()-2].yCurrent;
-            double angle = atan2(dy, dx) * 180.0 / M_PI;
-// vdu dx = 1, dy = 0 ko xoay, dx =0, dy = -1 xoay -90
-            // Calculate hand position based on rope angle
-            double handX = parti.back().xCurrent;
-            double handY = parti.back().yCurrent + 10; // Move hand down to connect with rope
-// dịch 1 tí tại lệch với hình vẽ
-            // Create destination rectangle
-            SDL_Rect handRect = {
-                static_cast<int>(handX - handWidth/2),
-                static_cast<int>(handY - handHeight/2),
-                handWidth,
-                handHeight
-            };
+        // Maintain rope length constraint
+        dx = x - pivotX;
+        dy = y - pivotY;
+        distance = sqrt(dx*dx + dy*dy);
 
-            // Calculate center point for rotation
-            SDL_Point center = {handWidth/2, handHeight/2};
-// hàm để xoay ảnh
-            // Render with rotation
-            SDL_RenderCopyEx(renderer, currentTexture, NULL, &handRect, angle, &center, SDL_FLIP_NONE);
+        if (distance > ROPE_LENGTH) {
+            double ratio = ROPE_LENGTH / distance;
+            x = pivotX + dx * ratio;
+            y = pivotY + dy * ratio;
         }
-    }
 
-    void step() {
-    verletintergraion();
-    enforceConstraint();
+        // Store velocity for when we release
+        vx = tangentX * tangentialSpeed;
+        vy = tangentY * tangentialSpeed;
+
+        // Very minimal damping to preserve momentum for jumping
+        vx *= 0.999;
+        vy *= 0.999;
     }
 
-    void attachtothebody(double bodyx, double bodyy, double bodywidth, bool islefthand) {
-        // Update the first particle (attachment point)
-        if (islefthand) {
-            parti[0].xCurrent = bodyx - (bodywidth/2);
-        } else {
-            parti[0].xCurrent = bodyx + (bodywidth/2);
-        }
-    parti[0].yCurrent = bodyy;
-    parti[0].xPrevious = parti[0].xCurrent;
-    parti[0].yPrevious = parti[0].yCurrent;
+    // Character::update once both ropes have stepped: swing forces, gravity, swing energy, speed
+    // limits, drag, integration, and the ropes' roots following the body
+    static void moveBody(PlayerBody& body, const InputFrame& input) {
+        double& vx = body.vx;
+        double& vy = body.vy;
+        bool holding = body.grabbing[0] || body.grabbing[1];
 
-        // If not grabbing, keep the hand within max length
-        if (!isGrabbingObject) {
-            double dx = parti.back().xCurrent - parti[0].xCurrent;
-            double dy = parti.back().yCurrent - parti[0].yCurrent;
-            double length = sqrt(dx*dx + dy*dy);
+        // Apply swing forces before gravity
+        applySwingForces(body, input);
 
-            if (length > maxLength) {
-                double ratio = maxLength / length;
-                parti.back().xCurrent = parti[0].xCurrent + dx * ratio;
-                parti.back().yCurrent = parti[0].yCurrent + dy * ratio;
-            }
+        // Always apply gravity, but less when swinging to preserve momentum
+        if (holding) {
+            // Reduced gravity when holding on to something
+            vy += GRAVITY * 0.7 * dt;
+        } else {
+            // Full gravity in free fall
+            vy += GRAVITY * dt;
         }
-    }
-
-    // Standard grab method for non-moving objects
-    void grab(double grabx, double graby) {
-        // Update the last particle's position to the grab point
-        parti.back().xCurrent = grabx;
-        parti.back().yCurrent = graby;
-        parti.back().checkmovement = true;
-        isGrabbingObject = true;
 
-        // Reset platform tracking when doing a standard grab
-        grabbedPlatformIndex = -1;
-    }
+        // Track swing energy for better jumps
+        if (holding) {
+            // Current swing speed
+            double swingSpeed = sqrt(vx*vx + vy*vy);
+            if (swingSpeed > body.maxSwingSpeed) {
+                body.maxSwingSpeed = swingSpeed;
+            }
 
-    void release() {
-         parti.back().checkmovement = false;
-        isGrabbingObject = false;
-        grabbedPlatformIndex = -1;
-    }
+            // Update swing energy based on current velocity
+            body.swingEnergy = 0.8 * body.swingEnergy + 0.2 * swingSpeed;
 
-    void handlecollision(const std::vector<Platform>& platforms) {
-        const double BOUNCE = 0.1; // Reduced bounce factor
+            // Update facing direction based on movement if significant
+            if (abs(vx) > 50.0) {
+                body.facingDirection = (vx > 0) ? 1.0 : -1.0;
+            }
+        } else {
+            // Gradually reduce swing energy when not holding
+            body.swingEnergy *= 0.95;
+            body.maxSwingSpeed = 0;
+        }
 
-        // Check each particle in the rope except the fixed ones
-        for (auto& particle : parti) {
-            // Skip fixed particles (first and possibly last particle)
-            if (particle.checkmovement) continue;
+        // Limit fall speed but allow higher horizontal speed
+        if (vy > MAX_SPEED) vy = MAX_SPEED;
+        if (abs(vx) > MAX_SPEED * 1.2) vx = (vx > 0) ? MAX_SPEED * 1.2 : -MAX_SPEED * 1.2;
 
-            for (const auto& platform : platforms) {
-                // Get current velocity
-                double velX = particle.xCurrent - particle.xPrevious;
-                double velY = particle.yCurrent - particle.yPrevious;
+        // Apply less drag when swinging for better momentum preservation
+        if (holding) {
+            vx *= 0.995; // Very minimal drag during swing
+        } else {
+            vx *= DRAG; // Normal drag in free fall
+        }
 
-                // Adjust velocity for moving platforms
-                if (platform.isMoving) {
-                    // Add platform's movement to relative velocity
-                    float platformVelocity = platform.speed * (platform.movingForward ? 1.0f : -1.0f);
-                    velX -= platformVelocity * 0.1f; // Same scale as used in main.cpp
-                }
+        // Update position
+        body.x += vx * dt;
+        body.y += vy * dt;
 
-                // Check current position and predicted next position
-                double nextX = particle.xCurrent + velX;
-                double nextY = particle.yCurrent + velY;
-
-                // Line segment intersection test between current and next position
-                bool collision = false;
-
-                // Check top edge of platform
-                if (velY > 0 && // Moving downward
-                    particle.yCurrent <= platform.rect.y && nextY >= platform.rect.y &&
-                    particle.xCurrent + velX >= platform.rect.x &&
-                    particle.xCurrent + velX <= platform.rect.x + platform.rect.w) {
-                    // Collision with top of platform
-                    particle.yCurrent = platform.rect.y;
-                    particle.yPrevious = particle.yCurrent - velY * BOUNCE;
-                    collision = true;
-                }
+        // Keep hands attached at the edges of the character
+        double attachWidth = body.radius * 0.2;
+        attachToBody(body.hands[0], (body.x - body.radius) - (attachWidth/2), body.y, body.grabbing[0]);
+        attachToBody(body.hands[1], (body.x + body.radius) + (attachWidth/2), body.y, body.grabbing[1]);
+    }
 
-                // Check bottom edge of platform
-                else if (velY < 0 && // Moving upward
-                    particle.yCurrent >= platform.rect.y + platform.rect.h &&
-                    nextY <= platform.rect.y + platform.rect.h &&
-                    particle.xCurrent + velX >= platform.rect.x &&
-                    particle.xCurrent + velX <= platform.rect.x + platform.rect.w) {
-                    // Collision with bottom of platform
-                    particle.yCurrent = platform.rect.y + platform.rect.h;
-                    particle.yPrevious = particle.yCurrent - velY * BOUNCE;
-                    collision = true;
-                }
+    // The rope's root on the body, a hand holding nothing is pulled back within maxLength
+    static void attachToBody(RopeView rope, double attachX, double attachY, bool grabbing) {
+        rope.place(0, attachX, attachY);
 
-                // Check left edge of platform
-                if (!collision && velX > 0 && // Moving right
-                    particle.xCurrent <= platform.rect.x && nextX >= platform.rect.x &&
-                    particle.yCurrent + velY >= platform.rect.y &&
-                    particle.yCurrent + velY <= platform.rect.y + platform.rect.h) {
-                    // Collision with left of platform
-                    particle.xCurrent = platform.rect.x;
-                    particle.xPrevious = particle.xCurrent - velX * BOUNCE;
-                }
+        // If not grabbing, keep the hand within max length
+        if (!grabbing) {
+            int hand = rope.at(rope.last());
+            double dx = rope.x[hand] - rope.x[0];
+            double dy = rope.y[hand] - rope.y[0];
+            double length = sqrt(dx*dx + dy*dy);
 
-                // Check right edge of platform
-                else if (!collision && velX < 0 && // Moving left
-                    particle.xCurrent >= platform.rect.x + platform.rect.w &&
-                    nextX <= platform.rect.x + platform.rect.w &&
-                    particle.yCurrent + velY >= platform.rect.y &&
-                    particle.yCurrent + velY <= platform.rect.y + platform.rect.h) {
-                    // Collision with right of platform
-                    particle.xCurrent = platform.rect.x + platform.rect.w;
-                    particle.xPrevious = particle.xCurrent - velX * BOUNCE;
-                }
+            if (length > rope.maxLength) {
+                double ratio = rope.maxLength / length;
+                rope.x[hand] = rope.x[0] + dx * ratio;
+                rope.y[hand] = rope.y[0] + dy * ratio;
             }
         }
     }
 
-private:
-    const double dt = 0.016;
-    double desireddistance;
+    // Letting go throws the body forward, harder after a good swing. The owner releases the hand.
+    static void releaseBoost(PlayerBody& body) {
+        double& vx = body.vx;
+        double& vy = body.vy;
+        double releaseBoost = JUMP_BOOST;
 
-    void verletintergraion() {
-        double damping = 0.99;  // Increased damping for better momentum preservation
-    for (Particle &pn : parti) {
-            if (pn.checkmovement) continue;
+        // Calculate boost based on swing energy and direction
+        if (body.swingEnergy > 100) {
+            // Additional boost based on accumulated swing energy
+            releaseBoost += 0.3 * (body.swingEnergy / 300.0);
 
-        double prevX = pn.xCurrent;
-        double prevY = pn.yCurrent;
+            // Cap the boost at a reasonable value
+            if (releaseBoost > 2.0) releaseBoost = 2.0;
+        }
 
-        double velocityX = (pn.xCurrent - pn.xPrevious) * damping;
-        double velocityY = (pn.yCurrent - pn.yPrevious) * damping;
+        // Use the tracked facing direction for forward toss
+        double forwardDir = body.facingDirection;
 
-            // Apply less gravity to rope particles for smoother rope movement
-            velocityY += 5.0 * dt; // Reduced from 9.81 for rope particles
+        // Apply the boost to horizontal velocity - enhanced forward boost
+        vx *= releaseBoost;
 
-        pn.xCurrent += velocityX;
-        pn.yCurrent += velocityY;
+        // Add extra forward momentum (tossing effect)
+        vx += forwardDir * FORWARD_TOSS;
 
-        pn.xPrevious = prevX;
-        pn.yPrevious = prevY;
-    }
-}
+        // Apply the boost to vertical velocity with a reduced upward component
+        vy *= releaseBoost * 0.85; // Reduced vertical boost multiplier
 
-    void enforceConstraint() {
-        const int iterations = isGrabbingObject ? 20 : jakobsenit;  // More iterations when grabbing
-        for (int i = 0; i < iterations; i++) {
-            for (size_t j = 1; j < parti.size(); j++) {
-                Particle &p1 = parti[j-1];
-                Particle &p2 = parti[j];
-                double distance = sqrt(pow(p1.xCurrent - p2.xCurrent, 2) + pow(p1.yCurrent - p2.yCurrent, 2));
-                double distanceError = distance - desireddistance;
-
-                double xDifference = p2.xCurrent - p1.xCurrent;
-                double yDifference = p2.yCurrent - p1.yCurrent;
-
-                // Avoid division by zero
-                double totalDifference = sqrt(pow(xDifference, 2) + pow(yDifference, 2));
-                if (totalDifference < 0.0001) continue;
-
-                double xDirection = xDifference / totalDifference;
-                double yDirection = yDifference / totalDifference;
-
-                double correction = isGrabbingObject ? 1.0 : 0.5;  // Full correction when grabbing
-// p1 fixed , p2 ko fixed thi p2 dich ve p1
-                if (p1.checkmovement && !p2.checkmovement) {
-                    p2.xCurrent -= xDirection * distanceError * correction;
-                    p2.yCurrent -= yDirection * distanceError * correction;
-                }
-                else if (p2.checkmovement && !p1.checkmovement) {
-                    p1.xCurrent += xDirection * distanceError * correction;
-                    p1.yCurrent += yDirection * distanceError * correction;
-                }
-                else if (!p1.checkmovement && !p2.checkmovement) {
-                    p2.xCurrent -= xDirection * distanceError * correction * 0.5;
-                    p2.yCurrent -= yDirection * distanceError * correction * 0.5;
-                    p1.xCurrent += xDirection * distanceError * correction * 0.5;
-                    p1.yCurrent += yDirection * distanceError * correction * 0.5;
-                }
-            }
-        }
+        // Add a smaller upward impulse to help reach the next object
+        // but less if we're going forward fast (more horizontal trajectory)
+        double upwardBoost = UPWARD_BOOST;
+        double horizontalFactor = std::min(1.0, std::abs(vx) / 500.0); // How much we're moving horizontally
+        upwardBoost *= (1.0 - 0.5 * horizontalFactor); // Reduce upward boost more when moving fast horizontally
+
+        vy -= upwardBoost; // Negative is upward
+
+        // Reset swing tracking after releasing
+        body.maxSwingSpeed = 0;
     }
-};
 
-class Character {
-public:
-    double x, y;
-    double vx, vy;
-    double radius;
-    ropehand leftHand;
-    ropehand rightHand;
-    SDL_Texture *texture;
-    bool hasReachedFinish;
-    bool showingCongratulations;  // New flag for congratulations state
-    // Track swing state and movement
-    double lastSwingAngle = 0;
-    double maxSwingSpeed = 0;
-    bool isSwingingRight = false;
-    double swingEnergy = 0;
-    double facingDirection = 1.0; // 1.0 for right, -1.0 for left
+    // Back at the start of the level, at rest, ropes spread out to the sides. The owner releases
+    // both hands first.
+    static void resetBody(PlayerBody& body) {
+        body.x = PLAYER_START_X;  // Initial x position
+        body.y = PLAYER_START_Y;  // Initial y position
+        body.vx = 0;
+        body.vy = 0;
 
-    // Add a function to set the character texture at runtime
-    void setTexture(SDL_Renderer* renderer, const char* texturePath) {
-        // Free old texture if it exists
-        if (texture) {
-            SDL_DestroyTexture(texture);
-            texture = nullptr;
+        // Reset hand positions relative to character position
+        RopeView& leftHand = body.hands[0];
+        for (int i = 0; i < leftHand.count; i++) {
+            double t = static_cast<double>(i) / (leftHand.count - 1);
+            leftHand.place(i, body.x - body.radius - (35 * t), body.y);  // Spread particles left
         }
 
-        // Try to load the new image
-        SDL_Surface* originalSurface = IMG_Load(texturePath);
-        if (!originalSurface) {
-            return;
+        RopeView& rightHand = body.hands[1];
+        for (int i = 0; i < rightHand.count; i++) {
+            double t = static_cast<double>(i) / (rightHand.count - 1);
+            rightHand.place(i, body.x + body.radius + (35 * t), body.y);  // Spread particles right
         }
 
-        // Create a new surface at the desired size (2*radius x 2*radius)
-        SDL_Surface* scaledSurface = SDL_CreateRGBSurface(0, radius * 2, radius * 2, 32,
-            0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+        // Reset swing tracking
+        body.maxSwingSpeed = 0;
+        body.swingEnergy = 0;
+    }
 
-        if (!scaledSurface) {
-            SDL_FreeSurface(originalSurface);
-            return;
+    // Catch the platform when the hand is inside it: the hand is pinned where it is
+    static bool grab(RopeView hand, const SDL_Rect& rect) {
+        double handX = hand.handX();
+        double handY = hand.handY();
+        if (handX >= rect.x && handX <= rect.x + rect.w &&
+            handY >= rect.y && handY <= rect.y + rect.h) {
+            // Set fixed grab point exactly at current position
+            hand.place(hand.last(), handX, handY);
+            hand.setPinned(hand.last(), true);
+            return true;
         }
+        return false;
+    }
 
-        // Scale the image to match the collision size
-        SDL_BlitScaled(originalSurface, NULL, scaledSurface, NULL);
-
-        // Create texture from the scaled surface
-        texture = SDL_CreateTextureFromSurface(renderer, scaledSurface);
-
-        // Clean up surfaces
-        SDL_FreeSurface(originalSurface);
-        SDL_FreeSurface(scaledSurface);
-
-        // Free existing hand textures first to prevent memory leaks
-        if (leftHand.handTexture) {
-            SDL_DestroyTexture(leftHand.handTexture);
-            leftHand.handTexture = nullptr;
-        }
-        if (leftHand.grabTexture) {
-            SDL_DestroyTexture(leftHand.grabTexture);
-            leftHand.grabTexture = nullptr;
+    // A hand holding a moving platform that was at oldX moves with it, true when it did (the owner
+    // moves the body)
+    static bool carryHand(RopeView hand, int oldX, const SDL_Rect& rect, int deltaX) {
+        double handX = hand.handX();
+        double handY = hand.handY();
+
+        if (handX >= oldX && handX <= oldX + rect.w &&
+            handY >= rect.y && handY <= rect.y + rect.h) {
+            // Hand is on this platform - move all particles of the hand
+            hand.translate(deltaX, 0);
+            return true;
         }
-        if (rightHand.handTexture) {
-            SDL_DestroyTexture(rightHand.handTexture);
-            rightHand.handTexture = nullptr;
+        return false;
+    }
+
+    // Push the body out of one platform. True when it is a spike, the owner then sends the player
+    // back to the start and stops colliding.
+    static bool collideBody(PlayerBody& body, const Platform& platform) {
+        double& x = body.x;
+        double& y = body.y;
+        double radius = body.radius;
+        SDL_Rect collisionRect = platform.rect;
+
+        // Get platform corners and edges
+        double platformLeft = collisionRect.x;
+        double platformRight = collisionRect.x + collisionRect.w;
+        double platformTop = collisionRect.y;
+        double platformBottom = collisionRect.y + collisionRect.h;
+
+        // Find the closest point on the platform to the circle center
+        double closestX = std::max(platformLeft, std::min(x, platformRight));
+        double closestY = std::max(platformTop, std::min(y, platformBottom));
+
+        // Calculate distance between closest point and circle center
+        double distanceX = x - closestX;
+        double distanceY = y - closestY;
+        double distanceSquared = distanceX * distanceX + distanceY * distanceY;
+
+        // Check if circle collides with platform
+        if (distanceSquared >= radius * radius) return false;
+
+        // Hit a spike
+        if (platform.isSpike) return true;
+
+        // Calculate overlap amounts
+        double overlapLeft = x + radius - platformLeft;
+        double overlapRight = platformRight - (x - radius);
+        double overlapTop = y + radius - platformTop;
+        double overlapBottom = platformBottom - (y - radius);
+
+        // Find smallest overlap
+        double overlapX = (overlapLeft < overlapRight) ? -overlapLeft : overlapRight;
+        double overlapY = (overlapTop < overlapBottom) ? -overlapTop : overlapBottom;
+
+        // Resolve collision based on smallest overlap
+        if (abs(overlapX) < abs(overlapY)) {
+            // Horizontal collision
+            x += overlapX;
+            body.vx = 0;
+        } else {
+            // Vertical collision
+            y += overlapY;
+            if (overlapY < 0) { // If hitting from above
+                body.vy = 0;  // Just stop, no bounce
+                y = platformTop - radius;  // Place exactly on top
+            } else {  // If hitting from below
+                body.vy = 0;  // Stop upward movement
+            }
         }
-        if (rightHand.grabTexture) {
-            SDL_DestroyTexture(rightHand.grabTexture);
-            rightHand.grabTexture = nullptr;
+        return false;
+    }
+
+    // Box around every free particle and where it goes next, margin included: one broad phase query
+    // for the whole rope. False when every particle is pinned and there is nothing to collide.
+    static bool ropeQueryBox(const RopeView& rope, double& left, double& top, double& right, double& bottom) {
+        bool anyFree = false;
+        left = top = right = bottom = 0;
+        for (int p = 0; p < rope.count; p++) {
+            if (rope.isPinned(p)) continue;
+            int i = rope.at(p);
+            double nextX = 2 * rope.x[i] - rope.px[i];
+            double nextY = 2 * rope.y[i] - rope.py[i];
+            if (!anyFree) {
+                left = right = rope.x[i];
+                top = bottom = rope.y[i];
+                anyFree = true;
+            }
+            left = std::min(left, std::min(rope.x[i], nextX));
+            right = std::max(right, std::max(rope.x[i], nextX));
+            top = std::min(top, std::min(rope.y[i], nextY));
+            bottom = std::max(bottom, std::max(rope.y[i], nextY));
         }
+        left -= ROPE_QUERY_MARGIN;
+        top -= ROPE_QUERY_MARGIN;
+        right += ROPE_QUERY_MARGIN;
+        bottom += ROPE_QUERY_MARGIN;
+        return anyFree;
+    }
 
-        // Check if this is the mint character
-        if (strstr(texturePath, "mintchar") != nullptr) {
-            // Load mint-specific hand textures
-            leftHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\mintleftrelease-Photoroom - Copy.png");
-            leftHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\mintrightgrab-Photoroom.png");
-            rightHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\mintleftrelease-Photoroom.png");
-            rightHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\mintrightgrab-Photoroom - Copy.png");
+    // Free particle p against one platform: stopped on the edge it crosses, bouncing off a little
+    static void collideParticle(RopeView& rope, int p, const Platform& platform) {
+        int i = rope.at(p);
+        double& xCurrent = rope.x[i];
+        double& yCurrent = rope.y[i];
+        double& xPrevious = rope.px[i];
+        double& yPrevious = rope.py[i];
+
+        // Get current velocity
+        double velX = xCurrent - xPrevious;
+        double velY = yCurrent - yPrevious;
+
+        // Adjust velocity for moving platforms
+        if (platform.isMoving) {
+            // Add platform's movement to relative velocity
+            float platformVelocity = platform.speed * (platform.movingForward ? 1.0f : -1.0f);
+            velX -= platformVelocity * 0.1f; // Same scale as used in main.cpp
+        }
 
-            // Set mint color for ropes (a light mint/teal color)
-            leftHand.ropeColor = {0, 200, 150, 255};  // Mint/teal color for mint character
-            rightHand.ropeColor = {0, 200, 150, 255};
+        // Check current position and predicted next position
+        double nextX = xCurrent + velX;
+        double nextY = yCurrent + velY;
+
+        // Line segment intersection test between current and next position
+        bool collision = false;
+
+        // Check top edge of platform
+        if (velY > 0 && // Moving downward
+            yCurrent <= platform.rect.y && nextY >= platform.rect.y &&
+            xCurrent + velX >= platform.rect.x &&
+            xCurrent + velX <= platform.rect.x + platform.rect.w) {
+            // Collision with top of platform
+            yCurrent = platform.rect.y;
+            yPrevious = yCurrent - velY * ROPE_BOUNCE;
+            collision = true;
         }
-        // Check if this is the black character
-        else if (strstr(texturePath, "blackchar") != nullptr) {
-            // Load black character-specific hand textures
-            rightHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\blackreleaseleft-Photoroom.png");
-            leftHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\blackreleaseleft-Photoroom - Copy.png");
-            rightHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\blacklefthand-Photoroom - Copy - Copy.png");
-            leftHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\blacklefthand-Photoroom - Copy.png");
 
-            // Set black color for ropes
-            SDL_Color blackColor = {30, 30, 30, 255};  // Dark black color with a bit of visibility
-            leftHand.ropeColor = blackColor;
-            rightHand.ropeColor = blackColor;
+        // Check bottom edge of platform
+        else if (velY < 0 && // Moving upward
+            yCurrent >= platform.rect.y + platform.rect.h &&
+            nextY <= platform.rect.y + platform.rect.h &&
+            xCurrent + velX >= platform.rect.x &&
+            xCurrent + velX <= platform.rect.x + platform.rect.w) {
+            // Collision with bottom of platform
+            yCurrent = platform.rect.y + platform.rect.h;
+            yPrevious = yCurrent - velY * ROPE_BOUNCE;
+            collision = true;
         }
-        // Check if this is the Sabrina character
-        else if (strstr(texturePath, "3735783d") != nullptr) {
-            // Load Sabrina-specific hand textures
-            rightHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\sabrinaleftrelease-removebg-preview.png");
-            leftHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\sabrinaleftrelease-removebg-preview - Copy.png");
-            leftHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\sabrinaleftgrab-removebg-preview - Copy.png");
-            rightHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\sabrinaleftgrab-removebg-preview.png");
 
-            // Set muted yellow color for ropes
-            SDL_Color mutedYellow = {220, 180, 50, 255};  // Muted yellow color
-            leftHand.ropeColor = mutedYellow;
-            rightHand.ropeColor = mutedYellow;
+        // Check left edge of platform
+        if (!collision && velX > 0 && // Moving right
+            xCurrent <= platform.rect.x && nextX >= platform.rect.x &&
+            yCurrent + velY >= platform.rect.y &&
+            yCurrent + velY <= platform.rect.y + platform.rect.h) {
+            // Collision with left of platform
+            xCurrent = platform.rect.x;
+            xPrevious = xCurrent - velX * ROPE_BOUNCE;
         }
-        else {
-            // Load default hand textures for other characters
-            leftHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\lefthandrelease.png");
-            leftHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\grableft.png");
-            rightHand.handTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\righthandrelease.png");
-            rightHand.grabTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\grabright.png");
 
-            // Reset to default red color for ropes
-            leftHand.ropeColor = {255, 0, 0, 255};  // Red color
-            rightHand.ropeColor = {255, 0, 0, 255};
+        // Check right edge of platform
+        else if (!collision && velX < 0 && // Moving left
+            xCurrent >= platform.rect.x + platform.rect.w &&
+            nextX <= platform.rect.x + platform.rect.w &&
+            yCurrent + velY >= platform.rect.y &&
+            yCurrent + velY <= platform.rect.y + platform.rect.h) {
+            // Collision with right of platform
+            xCurrent = platform.rect.x + platform.rect.w;
+            xPrevious = xCurrent - velX * ROPE_BOUNCE;
         }
     }
+};
 
-    // External variables from main.cpp that we need to modify
-    static int& getCurrentScreenIndex() {
-        extern int currentScreenIndex;
-        return currentScreenIndex;
-    }
+// Add struct for moving objects like the spike wall
+struct MovingObject {
+    SDL_Rect rect;
+    Sprite sprite;
+    float velocityX;
+    float velocityY;
+    float startX;
+    float startY;
 
-    static double& getCameraOffsetX() {
-        extern double cameraOffsetX;
-        return cameraOffsetX;
+    MovingObject(SDL_Rect r, const Sprite& s, float vx = 0, float vy = 0) :
+        rect(r), sprite(s), velocityX(vx), velocityY(vy), startX(r.x), startY(r.y) {}
+
+    void update() {
+        rect.x += velocityX;
+        rect.y += velocityY;
     }
 
-    // Add platforms reference for moving platform interaction
-    std::vector<Platform> currentPlatforms;
+    void reset() {
+        rect.x = startX;
+        rect.y = startY;
+    }
+};
 
-    Character(SDL_Renderer* renderer, double startX, double startY, double r, int handParticles)
-        : x(startX), y(startY - 500), vx(0), vy(0), radius(r),  // Start 500 pixels above the platform
-          // Initialize hands at the edges of the character with medium length ropes (35 pixels)
-          leftHand(renderer, startX - r, startX - r - 35, startY - 500, startY - 500 - 35, handParticles, true),
-          rightHand(renderer, startX + r, startX + r + 35, startY - 500, startY - 500 - 35, handParticles, false),
-          hasReachedFinish(false),
-          showingCongratulations(false)  // Initialize new flag
-    {
-        const char* texturePath = "F:\\Game\\graphic\\character.png";
-        SDL_Surface* originalSurface = IMG_Load(texturePath);
-        // Create a new surface at the desired size (2*radius x 2*radius)
-        SDL_Surface* scaledSurface = SDL_CreateRGBSurface(0, radius * 2, radius * 2, 32,
-            0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
-        // Scale the image to match the collision size
-        SDL_BlitScaled(originalSurface, NULL, scaledSurface, NULL);
+struct Graphics {
+    SDL_Renderer *renderer;
+    SDL_Window *window;
+    TextureHandle congratulationsTexture;
+    TextureHandle guideTexture;  // Add guide texture
+    TextureHandle acedTexture;   // Add aced texture
+    std::vector<Platform> platforms;
+    PlatformGrid platformGrid;  // broad phase over platforms, built when a level is loaded
 
-        // Create texture from the scaled surface
-        texture = SDL_CreateTextureFromSurface(renderer, scaledSurface);
+    Graphics() : renderer(nullptr), window(nullptr) {}
 
-        // Clean up surfaces
-        SDL_FreeSurface(originalSurface);
-        SDL_FreeSurface(scaledSurface);
+    void logErrorAndExit(const char* msg, const char* error)
+    {
+        SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR, "%s: %s", msg, error);
+        SDL_Quit();
     }
 
-    ~Character() {
-        if (texture) {
-            SDL_DestroyTexture(texture);
-            texture = nullptr;
+    void init() {
+        if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+            logErrorAndExit("SDL_Init", SDL_GetError());
+
+        // Initialize SDL_mixer
+        if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+            logErrorAndExit("Mix_OpenAudio", Mix_GetError());
         }
-    }
 
-    void applySwingForces(const Uint8* keystate) {
-        // Handle case when both hands are grabbing
-        if (leftHand.isGrabbingObject && rightHand.isGrabbingObject) {
-            // Get both grab points
-            double leftX = leftHand.parti.back().xCurrent;
-            double leftY = leftHand.parti.back().yCurrent;
-            double rightX = rightHand.parti.back().xCurrent;
-            double rightY = rightHand.parti.back().yCurrent;
+        // Initialize SDL_image
+        int imgFlags = IMG_INIT_PNG;
 
-            // Calculate midpoint between hands
-            double midX = (leftX + rightX) / 2.0;
-            double midY = (leftY + rightY) / 2.0;
+        window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
 
-            // Calculate distance between hands
-            double handDistance = sqrt(pow(rightX - leftX, 2) + pow(rightY - leftY, 2));
+        if (window == nullptr) logErrorAndExit("CreateWindow", SDL_GetError());
+        SDL_SetWindowResizable(window, SDL_TRUE);
+        SDL_MaximizeWindow(window);
 
-            // Maximum allowed distance between character and midpoint
-            double maxDistance = handDistance * 0.5; // Character can't be more than half the hand distance away
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED |
+                                              SDL_RENDERER_PRESENTVSYNC);
 
-            // Calculate current distance from midpoint
-            double currentDistance = sqrt(pow(x - midX, 2) + pow(y - midY, 2));
+        if (renderer == nullptr) logErrorAndExit("CreateRenderer", SDL_GetError());
 
-            // If character is too far from midpoint, pull it back
-            if (currentDistance > maxDistance) {
-                double ratio = maxDistance / currentDistance;
-                x = midX + (x - midX) * ratio;
-                y = midY + (y - midY) * ratio;
-            }
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+        SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
 
-            // Apply gravity
-            vy += GRAVITY * 0.7 * dt;
-            return;
-        } // dam bao nhan vat ko qua midpoint
+        // Load congratulations texture
+        congratulationsTexture = TextureCache::load(renderer, "graphic/congrat.png");
+        // Load guide image
+        guideTexture = TextureCache::load(renderer, "graphic/guidefinalroi.png");
+        if (guideTexture == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION,
+                          SDL_LOG_PRIORITY_ERROR,
+                          "Could not load guide image! SDL_Error: %s", SDL_GetError());
+        }
 
-        // Original single-hand grabbing code
-        if (!(leftHand.isGrabbingObject ^ rightHand.isGrabbingObject)) {
-            // In free fall, just apply gravity
-            vy += GRAVITY * dt;
-            return;
+        // Load aced image
+        acedTexture = TextureCache::load(renderer, "graphic/aced-Photoroom.png");
+        if (acedTexture == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION,
+                          SDL_LOG_PRIORITY_ERROR,
+                          "Could not load aced image! SDL_Error: %s", SDL_GetError());
         }
+    }
 
-        // Get the pivot point (the grabbing hand's position)
-        double pivotX, pivotY;
-        bool isRightHandGrabbing = rightHand.isGrabbingObject;
-        ropehand& freeHand = isRightHandGrabbing ? leftHand : rightHand;
+    void renderCongratulations() {
+        if (congratulationsTexture) {
+            // Center the congratulations image on screen but make it smaller
+            int w, h;
+            SDL_QueryTexture(congratulationsTexture.get(), NULL, NULL, &w, &h);
 
-        if (isRightHandGrabbing) {
-            pivotX = rightHand.parti.back().xCurrent;
-            pivotY = rightHand.parti.back().yCurrent;
-        } else {
-            pivotX = leftHand.parti.back().xCurrent;
-            pivotY = leftHand.parti.back().yCurrent;
+            // Scale down the image to half size
+            w = w / 2;
+            h = h / 2;
+
+            SDL_Rect destRect = {
+                SCREEN_WIDTH/2 - w/2,  // Center horizontally
+                SCREEN_HEIGHT/2 - h/2, // Center vertically
+                w,                     // Scaled width
+                h                      // Scaled height
+            };
+            SDL_RenderCopy(renderer, congratulationsTexture.get(), NULL, &destRect);
         }
+    }
 
-        // Get input direction
-        double inputX = 0, inputY = 0;
-        if (keystate[SDL_SCANCODE_UP]) inputY -= 1;
-        if (keystate[SDL_SCANCODE_DOWN]) inputY += 1;
-        if (keystate[SDL_SCANCODE_LEFT]) inputX -= 1;
-        if (keystate[SDL_SCANCODE_RIGHT]) inputX += 1;
+    void renderHowToPlay() {
+        if (guideTexture == nullptr) {
+            guideTexture = TextureCache::load(renderer, "graphic/guidefinalroi.png");
+            if (guideTexture == nullptr) {
+                logErrorAndExit("Could not load guide image", IMG_GetError());
+            }
+        }
 
-        // For the free hand - let natural rope physics handle it most of the time,
-        // but apply an upward force on UP key specifically
-        double& handX = freeHand.parti.back().xCurrent;
-        double& handY = freeHand.parti.back().yCurrent;
-        double& handVX = freeHand.parti.back().xPrevious;  // Using previous position to store velocity
-        double& handVY = freeHand.parti.back().yPrevious;
+        int guideWidth, guideHeight;
+        SDL_QueryTexture(guideTexture.get(), NULL, NULL, &guideWidth, &guideHeight);
 
-        // Calculate current hand velocity
-        double handVelocityX = handX - handVX;
-        double handVelocityY = handY - handVY;
+        // Center the guide image on screen
+        SDL_Rect guideRect = {
+            (SCREEN_WIDTH - guideWidth) / 2,
+            (SCREEN_HEIGHT - guideHeight) / 2 + 25, // Decreased from 30 to 25 to move it up 5 more pixels
+            guideWidth,
+            guideHeight
+        };
 
-        // Apply gentler upward force when UP key is pressed - special case
-        if (inputY < 0) {
-            // Apply upward force to the free hand - more gradual
-            handVelocityY += inputY * HAND_FORCE * 0.8 * dt; // Reduced to 80% for more visibility
+        SDL_RenderCopy(renderer, guideTexture.get(), NULL, &guideRect);
+    }
 
-            // Add small lift to body for air climbing (reduced)
-            vy -= FLAP_LIFT * 0.7 * dt;
-        }
-        //lên thì nâng ng lên cho tay free
+    void renderAced() {
+        if (!acedTexture) return;
 
-        // Apply horizontal force to free hand for directional swing control
-        if (inputX != 0) {
-            handVelocityX += inputX * HAND_FORCE * 0.6 * dt;
-        }
-        // dua vao phim mui ten ma tang hay giam velo
+        // Get texture dimensions
+        int texWidth, texHeight;
+        SDL_QueryTexture(acedTexture.get(), NULL, NULL, &texWidth, &texHeight);
 
-        // Apply minimal damping to preserve momentum
-        handVelocityX *= 0.98; // Slightly more damping for smoother motion
-        handVelocityY *= 0.98;
+        // Calculate smaller size (70% of original)
+        int newWidth = static_cast<int>(texWidth * 0.7);
+        int newHeight = static_cast<int>(texHeight * 0.7);
 
-        // Update hand position with gentler movement
-        handX = handVX + handVelocityX;
-        handY = handVY + handVelocityY;
+        // Calculate position to center on screen
+        SDL_Rect destRect = {
+            (SCREEN_WIDTH - newWidth) / 2,
+            (SCREEN_HEIGHT - newHeight) / 2,
+            newWidth,
+            newHeight
+        };
 
-        // Store velocity for next frame
-        handVX = handX - handVelocityX;
-        handVY = handY - handVelocityY;
+        // Render the texture
+        SDL_RenderCopy(renderer, acedTexture.get(), NULL, &destRect);
+    }
 
-        // Calculate tangential velocity (velocity along the swing arc)
-        double dx = x - pivotX; // x dis tu Pivot den C
-        double dy = y - pivotY;
-        double distance = sqrt(dx*dx + dy*dy);
+    ~Graphics() {
+        if (window != nullptr) {
+            SDL_DestroyWindow(window);
+            window = nullptr;
+        }
+        if (renderer != nullptr) {
+            SDL_DestroyRenderer(renderer);
+            renderer = nullptr;
+        }
+        // Textures are owned by their handles, the cache destroys each one exactly once
+    }
+};
 
-        if (distance < 0.0001) return; // Avoid division by zero
+class ropehand {
+public:
+    bool isGrabbingObject;
+    RopeConstraintSolver constraintSolver;  // picked per rope in the constructor
+    ParticleBuffer parti;  // SoA rope particles, index 0 is tied to the body, last() is the hand
+    double maxLength;
+    double currentLength;
+    Sprite handSprite;
+    Sprite grabSprite;  // New sprite for grabbing state
+    bool isLeftHand;
+    // Add color property for the rope
+    SDL_Color ropeColor;
+    RopeRenderer ropeRenderer;  // triangle strip for the rope, thickness is set here
 
-        // Calculate tangent direction (perpendicular to radius)
-        double tangentX = -dy / distance;
-        double tangentY = dx / distance; // de lay vecto chuan hoa cua vecto vuong goc
+    // Keep platform tracking for debugging purposes
+    int grabbedPlatformIndex;  // Index of the grabbed platform in platforms vector
 
-        // Project current velocity onto tangent
-        double tangentialSpeed = vx * tangentX + vy * tangentY; // how fast ủr going from side to side
+    ropehand(SDL_Renderer* renderer, double x1, double x2, double y1, double y2, int numberofparticles, bool isLeft,
+             RopeSolver solver = ROPE_SOLVER_JAKOBSEN)
+        : isGrabbingObject(false), constraintSolver(solver), isLeftHand(isLeft), grabbedPlatformIndex(-1) {
+        maxLength = sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2));  // Calculate maximum length
+        currentLength = maxLength;
+
+        // Default rope color is red
+        ropeColor = {255, 0, 0, 255};  // Red color (R,G,B,A)
+
+        // Load release hand texture based on hand type
+        const char* releasePath = isLeft ? "graphic/lefthandrelease.png" : "graphic/righthandrelease.png";
+        handSprite = TextureAtlas::sprite(renderer, releasePath);
+        // Load grab hand texture based on hand type
+        const char* grabPath = isLeft ? "graphic/grableft.png" : "graphic/grabright.png";
+        grabSprite = TextureAtlas::sprite(renderer, grabPath);
+        //cong thuc li: position = (1 - t) * start + t * end(cong thuc noi suy tuyen tinh de suy ra vi tri cua tung particle)
+        parti.resize(numberofparticles);
+        for (int i = 0; i < numberofparticles; i++) {
+            double weightforlerp = (double)i/(numberofparticles - 1);
+            double x = (1 - weightforlerp)*x1 + weightforlerp*x2;
+            double y = (1 - weightforlerp)*y1 + weightforlerp*y2;
+            parti.place(i, x, y);
+            parti.setPinned(i, i == 0);  // First particle is fixed to body
+        } // vdu parti 5 hat thi co cac vi tri la 0, 0,25, 0,5...
+        int segments = numberofparticles - 1;
+        desireddistance = maxLength/segments; // dam bao cac hat cach nhau 1 khoang nhat dinh
+    }
 
-        // Apply gravity as a tangential force - increased for better swinging
-        double gravityAngle = atan2(dy, dx);
-        double gravityTangentialComponent = GRAVITY * 1.2 * cos(gravityAngle); // Increased gravity effect for better swing, goc tu pivot den body
-        tangentialSpeed += gravityTangentialComponent * dt;
+    // Particles are in world space, cameraX is subtracted only here
+    void render(SDL_Renderer* renderer, double cameraX = 0) {
+        PROFILE_ZONE(ZONE_ROPE_DRAW);
 
-        // Normalize input direction for body control
-        double inputLength = sqrt(inputX*inputX + inputY*inputY);
-        if (inputLength > 0) {
-            inputX /= inputLength;
-            inputY /= inputLength;
+        // Whole rope as one triangle strip, a single draw call instead of a stack of lines per segment
+        ropeRenderer.clear();
+        for (int i = 0; i < parti.size(); i++) {
+            ropeRenderer.addPoint(parti.x[i] - cameraX, parti.y[i]);
+        }
+        ropeRenderer.draw(renderer, ropeColor);
 
-            // Apply input to tangential speed - for body swing control
-            double controlForce = 700.0; // Increased force for better swinging
-            double swingControl = (inputX * tangentX + inputY * tangentY) * controlForce * dt; // dot product cua input va cai goc quay
-            tangentialSpeed += swingControl;
+        // Draw hand at the end of the rope, check xem co grab ko, grab thi load anh grab
+        const Sprite& currentSprite = isGrabbingObject ? grabSprite : handSprite;
+        if (currentSprite) {
+            int handWidth = 40;
+            int handHeight = 40;
 
-            // Apply slight upward boost when pressing Up, to make higher jumps possible
-            if (inputY < 0) {
-                // Apply reduced upward component to the body when pressing up
-                vy -= 40.0 * dt; // Reduced from 80.0
-            }
+            // tính hướng dây đoạn cuối, 2 cái parti cuối ấy, xoay tay theo hướng dây, tn2(dx,y) là góc giữa trục ox và vector dxx dy
+            double dx = parti.x[parti.last()] - parti.x[parti.last() - 1];
+            double dy = parti.y[parti.last()] - parti.y[parti.last() - 1];
+            double angle = atan2(dy, dx) * 180.0 / M_PI;
+// vdu dx = 1, dy = 0 ko xoay, dx =0, dy = -1 xoay -90
+            // Calculate hand position based on rope angle
+            double handX = parti.x[parti.last()] - cameraX;
+            double handY = parti.y[parti.last()] + 10; // Move hand down to connect with rope
+// dịch 1 tí tại lệch với hình vẽ
+            // Create destination rectangle
+            SDL_Rect handRect = {
+                static_cast<int>(handX - handWidth/2),
+                static_cast<int>(handY - handHeight/2),
+                handWidth,
+                handHeight
+            };
 
-            // Add extra horizontal momentum when pressing left/right
-            // This helps create more of a tossing motion
-            if (inputX != 0) {
-                // Add extra horizontal momentum in the direction of input
-                vx += inputX * 50.0 * dt;
-            }
+            // Calculate center point for rotation
+            SDL_Point center = {handWidth/2, handHeight/2};
+// hàm để xoay ảnh
+            // Render with rotation
+            renderSpriteEx(renderer, currentSprite, &handRect, angle, &center);
         }
+    }
 
-        // Apply a boost at the bottom of the swing (when gravity is pulling downward)
-        // This creates a more natural swinging motion and builds momentum
-        if (dy > 0 && tangentialSpeed != 0) {
-            double boostMultiplier = std::min(1.0, std::abs(dy) / (ROPE_LENGTH * 0.75));
-            double boostForce = 250.0 * boostMultiplier; // Increased boost for better jumps
-            tangentialSpeed += (tangentialSpeed > 0 ? boostForce : -boostForce) * dt;
+    // Position of the hand, the last particle of the rope
+    double handX() const { return parti.x[parti.last()]; }
+    double handY() const { return parti.y[parti.last()]; }
 
-            // Add slight upward impulse at bottom of swing for better arc (reduced)
-            if (std::abs(dx) < ROPE_LENGTH * 0.5) {
-                vy -= 10.0 * boostMultiplier * dt; // Reduced from 20.0
-            }
-        }
+    void step() {
+    verletintergraion();
+    enforceConstraint();
+    }
 
-        // Update position based on tangential velocity
-        x += tangentX * tangentialSpeed * dt;
-        y += tangentY * tangentialSpeed * dt;
+    void attachtothebody(double bodyx, double bodyy, double bodywidth, bool islefthand) {
+        // Update the first particle (attachment point), a free hand stays within max length
+        double attachX = islefthand ? bodyx - (bodywidth/2) : bodyx + (bodywidth/2);
+        PlayerPhysics::attachToBody(view(), attachX, bodyy, isGrabbingObject);
+    }
 
-        // Maintain rope length constraint
-        dx = x - pivotX;
-        dy = y - pivotY;
-        distance = sqrt(dx*dx + dy*dy);
+    // Standard grab method for non-moving objects
+    void grab(double grabx, double graby) {
+        // Update the last particle's position to the grab point
+        parti.x[parti.last()] = grabx;
+        parti.y[parti.last()] = graby;
+        parti.setPinned(parti.last(), true);
+        isGrabbingObject = true;
 
-        if (distance > ROPE_LENGTH) {
-            double ratio = ROPE_LENGTH / distance;
-            x = pivotX + dx * ratio;
-            y = pivotY + dy * ratio;
+        // Reset platform tracking when doing a standard grab
+        grabbedPlatformIndex = -1;
+    }
+
+    void release() {
+         parti.setPinned(parti.last(), false);
+        isGrabbingObject = false;
+        grabbedPlatformIndex = -1;
+    }
+
+    // World space, the grid indexes the same platforms the view points at
+    void handlecollision(PlatformView platforms, const PlatformGrid& grid) {
+        RopeView rope = view();
+        double left, top, right, bottom;
+        if (!PlayerPhysics::ropeQueryBox(rope, left, top, right, bottom)) return;
+        grid.query(left, top, right, bottom, nearbyPlatforms);
+
+        // Check each particle in the rope except the fixed ones (first and possibly last particle)
+        for (int i = 0; i < parti.size(); i++) {
+            if (parti.isPinned(i)) continue;
+            for (int index : nearbyPlatforms) PlayerPhysics::collideParticle(rope, i, platforms[index]);
         }
+    }
 
-        // Store velocity for when we release
-        vx = tangentX * tangentialSpeed;
-        vy = tangentY * tangentialSpeed;
+    // The rope as PlayerPhysics sees it
+    RopeView view() { return RopeView(parti, maxLength); }
 
-        // Very minimal damping to preserve momentum for jumping
-        vx *= 0.999;
-        vy *= 0.999;
+    // Room for a query returning every platform, so the scratch list never grows mid-level
+    void reserveQueries(size_t platforms) {
+        nearbyPlatforms.reserve(platforms);
     }
 
-    void update() {
-        // Get keyboard state for swing controls
-        const Uint8* keystate = SDL_GetKeyboardState(NULL);
-
-        // Remove hardcoded finish line detection - this is now handled in main.cpp
-
-        // If showing congratulations, only check for C or Q keys
-        if (showingCongratulations) {
-            if (keystate[SDL_SCANCODE_C]) {
-                // Reset for next level
-                hasReachedFinish = false;
-                showingCongratulations = false;
-                x = 300;  // Reset position
-                y = 100;
-                vx = 0;
-                vy = 0;
-                leftHand.release();
-                rightHand.release();
-
-                // Reset hand positions relative to character position
-                for (size_t i = 0; i < leftHand.parti.size(); i++) {
-                    double t = static_cast<double>(i) / (leftHand.parti.size() - 1);
-                    leftHand.parti[i].xCurrent = x - radius - (35 * t);  // Spread particles left
-                    leftHand.parti[i].yCurrent = y;
-                    leftHand.parti[i].xPrevious = leftHand.parti[i].xCurrent;
-                    leftHand.parti[i].yPrevious = leftHand.parti[i].yCurrent;
-                }
+    // Distance the solver keeps between neighbouring particles
+    double restLength() const { return desireddistance; }
 
-                for (size_t i = 0; i < rightHand.parti.size(); i++) {
-                    double t = static_cast<double>(i) / (rightHand.parti.size() - 1);
-                    rightHand.parti[i].xCurrent = x + radius + (35 * t);  // Spread particles right
-                    rightHand.parti[i].yCurrent = y;
-                    rightHand.parti[i].xPrevious = rightHand.parti[i].xCurrent;
-                    rightHand.parti[i].yPrevious = rightHand.parti[i].yCurrent;
-                }
-            }
-            else if (keystate[SDL_SCANCODE_Q]) {
-                SDL_Event quitEvent;
-                quitEvent.type = SDL_QUIT;
-                SDL_PushEvent(&quitEvent);
-            }
-            return;
-        }
+private:
+    const double dt = 0.016;
+    double desireddistance;
+    std::vector<int> nearbyPlatforms;  // grid query results, reused every step
 
-        // Check if character is out of bounds and respawn if needed
-        if (y > SCREEN_HEIGHT + 500 || y < -500 ||
-            x > SCREEN_WIDTH + 500 || x < -500) {
-            // Reset position to initial position
-            x = 300;  // Initial x position
-            y = 100;  // Initial y position
-            vx = 0;
-            vy = 0;
-
-            // Reset hands
-            leftHand.release();
-            rightHand.release();
-
-            // Reset hand positions relative to character position
-            for (size_t i = 0; i < leftHand.parti.size(); i++) {
-                double t = static_cast<double>(i) / (leftHand.parti.size() - 1);
-                leftHand.parti[i].xCurrent = x - radius - (35 * t);  // Spread particles left
-                leftHand.parti[i].yCurrent = y;
-                leftHand.parti[i].xPrevious = leftHand.parti[i].xCurrent;
-                leftHand.parti[i].yPrevious = leftHand.parti[i].yCurrent;
-            }
+    void verletintergraion() {
+        double damping = 0.99;  // Increased damping for better momentum preservation
+        // Apply less gravity to rope particles for smoother rope movement
+        parti.integrate(damping, 5.0 * dt); // Reduced from 9.81 for rope particles
+    }
 
-            for (size_t i = 0; i < rightHand.parti.size(); i++) {
-                double t = static_cast<double>(i) / (rightHand.parti.size() - 1);
-                rightHand.parti[i].xCurrent = x + radius + (35 * t);  // Spread particles right
-                rightHand.parti[i].yCurrent = y;
-                rightHand.parti[i].xPrevious = rightHand.parti[i].xCurrent;
-                rightHand.parti[i].yPrevious = rightHand.parti[i].yCurrent;
-            }
+    void enforceConstraint() {
+        // Taut while grabbing: the solver uses more iterations / zero compliance then
+        constraintSolver.solve(parti, desireddistance, isGrabbingObject, dt);
+    }
+};
+
+class Character {
+public:
+    double x, y;
+    double vx, vy;
+    double radius;
+    ropehand leftHand;
+    ropehand rightHand;
+    TextureHandle texture;
+    bool hasReachedFinish;
+    bool showingCongratulations;  // New flag for congratulations state
+    // Track swing state and movement
+    double lastSwingAngle = 0;
+    double maxSwingSpeed = 0;
+    bool isSwingingRight = false;
+    double swingEnergy = 0;
+    double facingDirection = 1.0; // 1.0 for right, -1.0 for left
 
-            // Reset swing tracking
-            maxSwingSpeed = 0;
-            swingEnergy = 0;
+    // Add a function to set the character texture at runtime
+    void setTexture(SDL_Renderer* renderer, const char* texturePath) {
+        // Load the image scaled to the collision size (2*radius x 2*radius)
+        TextureHandle newTexture = TextureCache::loadScaled(renderer, texturePath, radius * 2, radius * 2);
+        if (!newTexture) {
             return;
         }
-        // Update movement direction based on input
-        if (keystate[SDL_SCANCODE_LEFT]) facingDirection = -1.0;
-        if (keystate[SDL_SCANCODE_RIGHT]) facingDirection = 1.0;
+        texture = newTexture;
 
-        // Update both hands
-        leftHand.step();
-        rightHand.step();
+        // Hand sprites come from the atlas (or the cache), reassigning them drops the old handles
 
-        // Apply swing forces before gravity
-        applySwingForces(keystate);
+        // Check if this is the mint character
+        if (strstr(texturePath, "mintchar") != nullptr) {
+            // Load mint-specific hand textures
+            leftHand.handSprite = TextureAtlas::sprite(renderer, "graphic/mintleftrelease-Photoroom - Copy.png");
+            leftHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/mintrightgrab-Photoroom.png");
+            rightHand.handSprite = TextureAtlas::sprite(renderer, "graphic/mintleftrelease-Photoroom.png");
+            rightHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/mintrightgrab-Photoroom - Copy.png");
 
-        // Always apply gravity, but less when swinging to preserve momentum
-        if (leftHand.isGrabbingObject || rightHand.isGrabbingObject) {
-            // Reduced gravity when holding on to something
-            vy += GRAVITY * 0.7 * dt;
-        } else {
-            // Full gravity in free fall
-            vy += GRAVITY * dt;
+            // Set mint color for ropes (a light mint/teal color)
+            leftHand.ropeColor = {0, 200, 150, 255};  // Mint/teal color for mint character
+            rightHand.ropeColor = {0, 200, 150, 255};
         }
+        // Check if this is the black character
+        else if (strstr(texturePath, "blackchar") != nullptr) {
+            // Load black character-specific hand textures
+            rightHand.handSprite = TextureAtlas::sprite(renderer, "graphic/blackreleaseleft-Photoroom.png");
+            leftHand.handSprite = TextureAtlas::sprite(renderer, "graphic/blackreleaseleft-Photoroom - Copy.png");
+            rightHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/blacklefthand-Photoroom - Copy - Copy.png");
+            leftHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/blacklefthand-Photoroom - Copy.png");
 
-        // Track swing energy for better jumps
-        if (leftHand.isGrabbingObject || rightHand.isGrabbingObject) {
-            // Current swing speed
-            double swingSpeed = sqrt(vx*vx + vy*vy);
-            if (swingSpeed > maxSwingSpeed) {
-                maxSwingSpeed = swingSpeed;
-            }
-
-            // Update swing energy based on current velocity
-            swingEnergy = 0.8 * swingEnergy + 0.2 * swingSpeed;
-
-            // Update facing direction based on movement if significant
-            if (abs(vx) > 50.0) {
-                facingDirection = (vx > 0) ? 1.0 : -1.0;
-            }
-        } else {
-            // Gradually reduce swing energy when not holding
-            swingEnergy *= 0.95;
-            maxSwingSpeed = 0;
+            // Set black color for ropes
+            SDL_Color blackColor = {30, 30, 30, 255};  // Dark black color with a bit of visibility
+            leftHand.ropeColor = blackColor;
+            rightHand.ropeColor = blackColor;
         }
+        // Check if this is the Sabrina character
+        else if (strstr(texturePath, "3735783d") != nullptr) {
+            // Load Sabrina-specific hand textures
+            rightHand.handSprite = TextureAtlas::sprite(renderer, "graphic/sabrinaleftrelease-removebg-preview.png");
+            leftHand.handSprite = TextureAtlas::sprite(renderer, "graphic/sabrinaleftrelease-removebg-preview - Copy.png");
+            leftHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/sabrinaleftgrab-removebg-preview - Copy.png");
+            rightHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/sabrinaleftgrab-removebg-preview.png");
 
-        // Limit fall speed but allow higher horizontal speed
-        if (vy > MAX_SPEED) vy = MAX_SPEED;
-        if (abs(vx) > MAX_SPEED * 1.2) vx = (vx > 0) ? MAX_SPEED * 1.2 : -MAX_SPEED * 1.2;
+            // Set muted yellow color for ropes
+            SDL_Color mutedYellow = {220, 180, 50, 255};  // Muted yellow color
+            leftHand.ropeColor = mutedYellow;
+            rightHand.ropeColor = mutedYellow;
+        }
+        else {
+            // Load default hand textures for other characters
+            leftHand.handSprite = TextureAtlas::sprite(renderer, "graphic/lefthandrelease.png");
+            leftHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/grableft.png");
+            rightHand.handSprite = TextureAtlas::sprite(renderer, "graphic/righthandrelease.png");
+            rightHand.grabSprite = TextureAtlas::sprite(renderer, "graphic/grabright.png");
 
-        // Apply less drag when swinging for better momentum preservation
-        if (leftHand.isGrabbingObject || rightHand.isGrabbingObject) {
-            vx *= 0.995; // Very minimal drag during swing
-        } else {
-            vx *= DRAG; // Normal drag in free fall
+            // Reset to default red color for ropes
+            leftHand.ropeColor = {255, 0, 0, 255};  // Red color
+            rightHand.ropeColor = {255, 0, 0, 255};
         }
+    }
 
-        // Update position
-        x += vx * dt;
-        y += vy * dt;
+    // External variable from main.cpp that we need to modify
+    // Length of the current level in world space, the out of bounds respawn allows 500 past either end
+    double levelWidth;
 
-        // Keep hands attached at the edges of the character
-        leftHand.attachtothebody(x - radius, y, radius * 0.2, true);
-        rightHand.attachtothebody(x + radius, y, radius * 0.2, false);
+    Character(SDL_Renderer* renderer, double startX, double startY, double r, int handParticles,
+              RopeSolver ropeSolver = ROPE_SOLVER_JAKOBSEN)
+        : x(startX), y(startY - 500), vx(0), vy(0), radius(r),  // Start 500 pixels above the platform
+          // Initialize hands at the edges of the character with medium length ropes (35 pixels)
+          leftHand(renderer, startX - r, startX - r - 35, startY - 500, startY - 500 - 35, handParticles, true, ropeSolver),
+          rightHand(renderer, startX + r, startX + r + 35, startY - 500, startY - 500 - 35, handParticles, false, ropeSolver),
+          hasReachedFinish(false),
+          showingCongratulations(false),  // Initialize new flag
+          levelWidth(SCREEN_WIDTH)
+    {
+        const char* texturePath = "graphic/character.png";
+        // Scale the image to match the collision size
+        texture = TextureCache::loadScaled(renderer, texturePath, radius * 2, radius * 2);
     }
 
-    // Add a reference to platforms for the update method to use
-    void setPlatformsReference(const std::vector<Platform>& platforms) {
-        currentPlatforms = platforms;
+    void applySwingForces(const InputFrame& input) {
+        PlayerBody body = this->body();
+        PlayerPhysics::applySwingForces(body, input);
     }
 
-    void grab(bool isLeft, const std::vector<Platform>& platforms) {
-        double handX, handY;
-        if (isLeft) {
-            handX = leftHand.parti.back().xCurrent;
-            handY = leftHand.parti.back().yCurrent;
-        } else {
-            handX = rightHand.parti.back().xCurrent;
-            handY = rightHand.parti.back().yCurrent;
+    // One physics step, the caller skips it while the congratulations screen is up
+    void update(const InputFrame& input) {
+        // Check if character is out of bounds and respawn if needed
+        if (y > SCREEN_HEIGHT + 500 || y < -500 ||
+            x > levelWidth + 500 || x < -500) {
+            resetPosition();
+            return;
         }
+        // Update movement direction based on input
+        if (input.held(InputFrame::LEFT)) facingDirection = -1.0;
+        if (input.held(InputFrame::RIGHT)) facingDirection = 1.0;
 
-        for (const auto& platform : platforms) {
-            if (handX >= platform.rect.x && handX <= platform.rect.x + platform.rect.w &&
-                handY >= platform.rect.y && handY <= platform.rect.y + platform.rect.h) {
-                if (isLeft) {
-                    // Set fixed grab point exactly at current position
-                    leftHand.parti.back().xCurrent = handX;
-                    leftHand.parti.back().yCurrent = handY;
-                    leftHand.parti.back().xPrevious = handX;
-                    leftHand.parti.back().yPrevious = handY;
-                    leftHand.parti.back().checkmovement = true;
-                    leftHand.isGrabbingObject = true;
-
-                    // If it's a moving platform, store position information
-                    if (platform.isMoving) {
-                        leftHand.grabbedPlatformIndex = -1;  // We'll handle movement directly in main.cpp
-                        for (int i = 0; i < platforms.size(); i++) {
-                            if (&platform == &platforms[i]) {
-                                leftHand.grabbedPlatformIndex = i;
-                                break;
-                            }
-                        }
-                    }
-                } else {
-                    // Set fixed grab point exactly at current position
-                    rightHand.parti.back().xCurrent = handX;
-                    rightHand.parti.back().yCurrent = handY;
-                    rightHand.parti.back().xPrevious = handX;
-                    rightHand.parti.back().yPrevious = handY;
-                    rightHand.parti.back().checkmovement = true;
-                    rightHand.isGrabbingObject = true;
-
-                    // If it's a moving platform, store position information
-                    if (platform.isMoving) {
-                        rightHand.grabbedPlatformIndex = -1;  // We'll handle movement directly in main.cpp
-                        for (int i = 0; i < platforms.size(); i++) {
-                            if (&platform == &platforms[i]) {
-                                rightHand.grabbedPlatformIndex = i;
-                                break;
-                            }
-                        }
-                    }
-                }
-                break;
-            }
-        }
+        // Update both hands
+        leftHand.step();
+        rightHand.step();
+
+        // Then the body: swing forces, gravity, integration, hands kept at its edges
+        PlayerBody body = this->body();
+        PlayerPhysics::moveBody(body, input);
     }
 
-    // New method that can handle camera offset
-    void grabWithCamera(bool isLeft, const std::vector<Platform>& platforms, double cameraOffsetX) {
-        double handX, handY;
-        if (isLeft) {
-            handX = leftHand.parti.back().xCurrent;
-            handY = leftHand.parti.back().yCurrent;
-        } else {
-            handX = rightHand.parti.back().xCurrent;
-            handY = rightHand.parti.back().yCurrent;
-        }
+    // Hand and platforms are both in world space, no camera offset involved
+    void grab(bool isLeft, PlatformView platforms, const PlatformGrid& grid) {
+        ropehand& hand = isLeft ? leftHand : rightHand;
 
-        // Add camera offset to hand position for the check
-        handX += cameraOffsetX;
-
-        for (const auto& platform : platforms) {
-            if (handX >= platform.rect.x && handX <= platform.rect.x + platform.rect.w &&
-                handY >= platform.rect.y && handY <= platform.rect.y + platform.rect.h) {
-
-                // Adjust grab position back to screen space
-                double screenSpaceHandX = handX - cameraOffsetX;
-
-                if (isLeft) {
-                    // Set fixed grab point exactly at current position
-                    leftHand.parti.back().xCurrent = screenSpaceHandX;
-                    leftHand.parti.back().yCurrent = handY;
-                    leftHand.parti.back().xPrevious = screenSpaceHandX;
-                    leftHand.parti.back().yPrevious = handY;
-                    leftHand.parti.back().checkmovement = true;
-                    leftHand.isGrabbingObject = true;
-
-                    // If it's a moving platform, store position information
-                    if (platform.isMoving) {
-                        leftHand.grabbedPlatformIndex = -1;  // We'll handle movement directly in main.cpp
-                        for (int i = 0; i < platforms.size(); i++) {
-                            if (&platform == &platforms[i]) {
-                                leftHand.grabbedPlatformIndex = i;
-                                break;
-                            }
-                        }
-                    }
-                } else {
-                    // Set fixed grab point exactly at current position
-                    rightHand.parti.back().xCurrent = screenSpaceHandX;
-                    rightHand.parti.back().yCurrent = handY;
-                    rightHand.parti.back().xPrevious = screenSpaceHandX;
-                    rightHand.parti.back().yPrevious = handY;
-                    rightHand.parti.back().checkmovement = true;
-                    rightHand.isGrabbingObject = true;
-
-                    // If it's a moving platform, store position information
-                    if (platform.isMoving) {
-                        rightHand.grabbedPlatformIndex = -1;  // We'll handle movement directly in main.cpp
-                        for (int i = 0; i < platforms.size(); i++) {
-                            if (&platform == &platforms[i]) {
-                                rightHand.grabbedPlatformIndex = i;
-                                break;
-                            }
-                        }
-                    }
+        // Only the platforms filed in the hand's cell can contain it
+        grid.queryPoint(hand.handX(), hand.handY(), nearbyPlatforms);
+        for (int index : nearbyPlatforms) {
+            const Platform& platform = platforms[index];
+            if (PlayerPhysics::grab(hand.view(), platform.rect)) {
+                hand.isGrabbingObject = true;
+
+                // If it's a moving platform, store position information
+                if (platform.isMoving) {
+                    hand.grabbedPlatformIndex = index;  // GameSimulation moves the hand with it
                 }
                 break;
             }
@@ -1212,158 +1162,72 @@ public:
     }
 
     void release(bool isLeft) {
-        double releaseBoost = JUMP_BOOST;
-
-        // Calculate boost based on swing energy and direction
-        if (swingEnergy > 100) {
-            // Additional boost based on accumulated swing energy
-            releaseBoost += 0.3 * (swingEnergy / 300.0);
-
-            // Cap the boost at a reasonable value
-            if (releaseBoost > 2.0) releaseBoost = 2.0;
-        }
-
-        // Use the tracked facing direction for forward toss
-        double forwardDir = facingDirection;
-
-        // Apply the boost to horizontal velocity - enhanced forward boost
-        vx *= releaseBoost;
-
-        // Add extra forward momentum (tossing effect)
-        vx += forwardDir * FORWARD_TOSS;
-
-        // Apply the boost to vertical velocity with a reduced upward component
-        vy *= releaseBoost * 0.85; // Reduced vertical boost multiplier
-
-        // Add a smaller upward impulse to help reach the next object
-        // but less if we're going forward fast (more horizontal trajectory)
-        double upwardBoost = UPWARD_BOOST;
-        double horizontalFactor = std::min(1.0, std::abs(vx) / 500.0); // How much we're moving horizontally
-        upwardBoost *= (1.0 - 0.5 * horizontalFactor); // Reduce upward boost more when moving fast horizontally
-
-        vy -= upwardBoost; // Negative is upward
-
-        // Reset swing tracking after releasing
-        maxSwingSpeed = 0;
+        PlayerBody body = this->body();
+        PlayerPhysics::releaseBoost(body);
 
         // Release the hand
         if (isLeft) leftHand.release();
         else rightHand.release();
     }
 
-    void handlecollision(const std::vector<Platform>& platforms, int screenIndex = 0) {
-        for (const auto& platform : platforms) {
-            SDL_Rect collisionRect = platform.rect;
-
-            // Get platform corners and edges
-            double platformLeft = collisionRect.x;
-            double platformRight = collisionRect.x + collisionRect.w;
-            double platformTop = collisionRect.y;
-            double platformBottom = collisionRect.y + collisionRect.h;
-
-            // Find the closest point on the platform to the circle center
-            double closestX = std::max(platformLeft, std::min(x, platformRight));
-            double closestY = std::max(platformTop, std::min(y, platformBottom));
-
-            // Calculate distance between closest point and circle center
-            double distanceX = x - closestX;
-            double distanceY = y - closestY;
-            double distanceSquared = distanceX * distanceX + distanceY * distanceY;
-
-            // Check if circle collides with platform
-            if (distanceSquared < radius * radius) {
-                // Check if this is a spike platform
-                if (platform.isSpike) {
-                    // Hit a spike, reset player position and go to first screen
-                    getCurrentScreenIndex() = 0;  // Reset to first screen
-                    getCameraOffsetX() = 0;       // Reset camera offset
-                    resetPosition();              // Reset player position
-                    return; // Exit collision check after respawning
-                }
-
-                // Determine finish line based on level (handled in main.cpp)
-
-                // Calculate overlap amounts
-                double overlapLeft = x + radius - platformLeft;
-                double overlapRight = platformRight - (x - radius);
-                double overlapTop = y + radius - platformTop;
-                double overlapBottom = platformBottom - (y - radius);
-
-                // Find smallest overlap
-                double overlapX = (overlapLeft < overlapRight) ? -overlapLeft : overlapRight;
-                double overlapY = (overlapTop < overlapBottom) ? -overlapTop : overlapBottom;
-
-                // Resolve collision based on smallest overlap
-                if (abs(overlapX) < abs(overlapY)) {
-                    // Horizontal collision
-                    x += overlapX;
-                    vx = 0;
-                } else {
-                    // Vertical collision
-                    y += overlapY;
-                    if (overlapY < 0) { // If hitting from above
-                        vy = 0;  // Just stop, no bounce
-                        y = platformTop - radius;  // Place exactly on top
-                    } else {  // If hitting from below
-                        vy = 0;  // Stop upward movement
-                    }
-                }
+    // Returns true when a spike sent the player back to the start, the caller moves the camera
+    bool handlecollision(PlatformView platforms, const PlatformGrid& grid) {
+        // Resolving one overlap can push the body up to a radius further, so look two radii around it
+        grid.query(x - 2 * radius, y - 2 * radius, x + 2 * radius, y + 2 * radius, nearbyPlatforms);
+        PlayerBody body = this->body();
+        for (int index : nearbyPlatforms) {
+            if (PlayerPhysics::collideBody(body, platforms[index])) {
+                // Hit a spike, reset player position to the start of the level
+                resetPosition();
+                return true;
             }
         }
 
         // Also handle rope collisions
-        leftHand.handlecollision(platforms);
-        rightHand.handlecollision(platforms);
+        leftHand.handlecollision(platforms, grid);
+        rightHand.handlecollision(platforms, grid);
+        return false;
     }
 
-    void render(SDL_Renderer* renderer) {
+    // World space position, the camera is applied only when drawing
+    void render(SDL_Renderer* renderer, double cameraX = 0) {
         // First render the character
         SDL_Rect destrec = {
-            static_cast<int>(x-radius),
+            static_cast<int>(x - cameraX - radius),
             static_cast<int>(y - radius),
             static_cast<int>(radius * 2),
             static_cast<int>(radius * 2),
         };
-        SDL_RenderCopy(renderer, texture, NULL, &destrec);
+        SDL_RenderCopy(renderer, texture.get(), NULL, &destrec);
 
         // Then render the ropes on top
-        leftHand.render(renderer);
-        rightHand.render(renderer);
+        leftHand.render(renderer, cameraX);
+        rightHand.render(renderer, cameraX);
     }
 
     void resetPosition() {
-        x = 300;  // Initial x position
-        y = 100;  // Initial y position
-        vx = 0;
-        vy = 0;
-
-        // Reset hands
         leftHand.release();
         rightHand.release();
+        PlayerBody body = this->body();
+        PlayerPhysics::resetBody(body);
+    }
 
-        // Reset hand positions relative to character position
-        for (size_t i = 0; i < leftHand.parti.size(); i++) {
-            double t = static_cast<double>(i) / (leftHand.parti.size() - 1);
-            leftHand.parti[i].xCurrent = x - radius - (35 * t);  // Spread particles left
-            leftHand.parti[i].yCurrent = y;
-            leftHand.parti[i].xPrevious = leftHand.parti[i].xCurrent;
-            leftHand.parti[i].yPrevious = leftHand.parti[i].yCurrent;
-        }
-
-        for (size_t i = 0; i < rightHand.parti.size(); i++) {
-            double t = static_cast<double>(i) / (rightHand.parti.size() - 1);
-            rightHand.parti[i].xCurrent = x + radius + (35 * t);  // Spread particles right
-            rightHand.parti[i].yCurrent = y;
-            rightHand.parti[i].xPrevious = rightHand.parti[i].xCurrent;
-            rightHand.parti[i].yPrevious = rightHand.parti[i].yCurrent;
-        }
+    // The body and both ropes as PlayerPhysics sees them
+    PlayerBody body() {
+        return PlayerBody{x, y, vx, vy, swingEnergy, maxSwingSpeed, facingDirection, radius,
+                          {leftHand.view(), rightHand.view()},
+                          {leftHand.isGrabbingObject, rightHand.isGrabbingObject}};
+    }
 
-        // Reset swing tracking
-        maxSwingSpeed = 0;
-        swingEnergy = 0;
+    // Query scratch of the body and both hands sized for the whole level, see ropehand::reserveQueries
+    void reserveQueries(size_t platforms) {
+        nearbyPlatforms.reserve(platforms);
+        leftHand.reserveQueries(platforms);
+        rightHand.reserveQueries(platforms);
     }
 
 private:
+    std::vector<int> nearbyPlatforms;  // grid query results, reused every step
 };
 
 #endif
@@ -0,0 +1,219 @@
+// Game_headless: runs the PLAYING simulation with no window, renderer or audio, as fast as the CPU
+// allows, driven by an input stream instead of the keyboard.
+// usage: Game_headless <level> [input file, - for stdin, bot] [max steps] [--record out.sgr]
+//        Game_headless --replay run.sgr
+//
+// Input stream, one run of identical steps per line, '#' starts a comment:
+//   <steps> <keys>      keys: U D L R = arrows, [ = grab left (A), ] = grab right (D), - = nothing
+// e.g. "60 -" waits one second, "20 R[" swings right while holding the left hand.
+// Without an input file the player just idles until max steps (default one minute of game time),
+// "bot" instead of a file lets BotInput (input_source.h) play until max steps.
+// --record saves the run as a replay (see replay.h). --replay plays a recorded run (from the game's
+// user folder or an earlier --record) and checks every checkpoint hash, reporting the first step
+// where the simulation went somewhere else.
+// Exits with 0 when the level was finished (or the replay matched), 2 when it was not.
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "graphics.h"
+#include "input_source.h"
+#include "replay.h"
+#include "simulation.h"
+
+struct InputRun {
+    int steps;
+    InputFrame input;
+};
+
+static bool parseKeys(const std::string& keys, InputFrame& input) {
+    input = InputFrame();
+    for (char key : keys) {
+        switch (key) {
+            case 'U': input.buttons |= InputFrame::UP; break;
+            case 'D': input.buttons |= InputFrame::DOWN; break;
+            case 'L': input.buttons |= InputFrame::LEFT; break;
+            case 'R': input.buttons |= InputFrame::RIGHT; break;
+            case '[': input.buttons |= InputFrame::GRAB_LEFT; break;
+            case ']': input.buttons |= InputFrame::GRAB_RIGHT; break;
+            case '-': break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+static bool readInputStream(std::istream& in, std::vector<InputRun>& runs) {
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream words(line);
+        InputRun run;
+        std::string keys;
+        if (!(words >> run.steps)) continue;  // blank line
+        if (!(words >> keys) || run.steps < 0 || !parseKeys(keys, run.input)) {
+            fprintf(stderr, "input line %d: expected '<steps> <keys>'\n", lineNumber);
+            return false;
+        }
+        runs.push_back(run);
+    }
+    return true;
+}
+
+// Play a recorded run and compare it against its checkpoints
+static int replayRun(const char* path) {
+    ReplayLog log;
+    if (!log.load(path)) {
+        fprintf(stderr, "cannot read replay %s\n", path);
+        return 1;
+    }
+
+    Graphics world;
+    Character player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+    GameSimulation sim(world, player);
+    if (!sim.loadLevel(log.level)) return 1;
+    sim.startLevel();
+
+    ReplayPlayer replay(log);
+    InputFrame input;
+    SimEvents events;
+    Uint64 start = SDL_GetPerformanceCounter();
+    while (replay.next(input)) {
+        sim.step(input, events);
+        if (!replay.check(sim)) break;
+    }
+    double seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+
+    printf("replay of level %d: %u of %u steps in %.3f s\n", log.level, replay.stepsPlayed(), log.steps, seconds);
+    if (replay.firstDivergence() != 0) {
+        printf("diverged at step %u (checked every %u steps)\n", replay.firstDivergence(), REPLAY_CHECKPOINT_INTERVAL);
+        return 2;
+    }
+    printf("identical, player at %.2f, %.2f\n", player.x, player.y);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Options first, whatever is left is positional
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--record" || arg == "--replay") && i + 1 < argc) {
+            (arg == "--record" ? recordPath : replayPath) = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 2 && replayPath == nullptr) {
+        fprintf(stderr, "usage: %s <level> [input file, - for stdin, bot] [max steps] [--record out.sgr]\n"
+                        "       %s --replay run.sgr\n", argv[0], argv[0]);
+        return 1;
+    }
+    SDL_SetMainReady();
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (replayPath != nullptr) {
+        int result = replayRun(replayPath);
+        SDL_Quit();
+        return result;
+    }
+
+    int levelNumber = atoi(argv[1]);
+    long maxSteps = argc > 3 ? atol(argv[3]) : 60L * STEPS_PER_SECOND;
+
+    std::vector<InputRun> runs;
+    bool useBot = argc > 2 && std::string(argv[2]) == "bot";
+    if (argc > 2 && !useBot) {
+        bool ok;
+        if (std::string(argv[2]) == "-") {
+            ok = readInputStream(std::cin, runs);
+        } else {
+            std::ifstream file(argv[2]);
+            if (!file) {
+                fprintf(stderr, "cannot open %s\n", argv[2]);
+                SDL_Quit();
+                return 1;
+            }
+            ok = readInputStream(file, runs);
+        }
+        if (!ok) {
+            SDL_Quit();
+            return 1;
+        }
+        if (argc <= 3) {
+            maxSteps = 0;
+            for (const InputRun& run : runs) maxSteps += run.steps;
+        }
+    }
+
+    // Same player as the game, without textures
+    Graphics world;
+    Character player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+    GameSimulation sim(world, player);
+    if (!sim.loadLevel(levelNumber)) {
+        SDL_Quit();
+        return 1;
+    }
+    sim.startLevel();
+    BotInput bot;
+    ReplayLog recording;
+    recording.begin(levelNumber);
+
+    long steps = 0, finishedAt = -1;
+    int grabs = 0, buttons = 0, respawns = 0;
+    size_t run = 0;
+    int runLeft = runs.empty() ? 0 : runs[0].steps;
+    SimEvents events;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    while (steps < maxSteps) {
+        while (run < runs.size() && runLeft == 0) {
+            run++;
+            runLeft = run < runs.size() ? runs[run].steps : 0;
+        }
+        InputFrame input = run < runs.size() ? runs[run].input : InputFrame();
+        if (useBot) input = bot.next(sim);
+        if (runLeft > 0) runLeft--;
+
+        sim.step(input, events);
+        if (recordPath != nullptr) recording.record(input, sim);
+        steps++;
+        grabs += events.grabPresses;
+        buttons += events.buttonsPressed;
+        respawns += events.respawns;
+        if (events.finished && finishedAt < 0) finishedAt = steps;
+    }
+    double seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+
+    printf("level %d: %ld steps (%.1f s of game time) in %.3f s, %.0f steps/s\n", levelNumber, steps,
+           steps * STEP_SECONDS, seconds, seconds > 0 ? steps / seconds : 0.0);
+    printf("player at %.2f, %.2f  grabs %d  buttons %d  respawns %d  ", player.x, player.y, grabs, buttons, respawns);
+    if (finishedAt >= 0) printf("finished at step %ld\n", finishedAt);
+    else printf("not finished\n");
+
+    if (recordPath != nullptr) {
+        recording.finish(sim);
+        if (recording.save(recordPath)) printf("recorded %u steps in %u runs to %s\n", recording.steps,
+                                               static_cast<unsigned>(recording.runs.size()), recordPath);
+    }
+
+    SDL_Quit();
+    return finishedAt >= 0 ? 0 : 2;
+}
@@ -0,0 +1,100 @@
+#ifndef _HEAPCHECK__H
+#define _HEAPCHECK__H
+#include <SDL.h>
+#include <cstdlib>
+#include <new>
+
+// Debug check that the PLAYING loop leaves the general heap alone. Every operator new on the main
+// thread is counted; once the game has been PLAYING for WARMUP_FRAMES in a row (scratch vectors
+// have reached their size by then), a frame that still allocated is logged and SDL_assert fires.
+// Transient per-frame data belongs in the FrameArena (frame_arena.h); what may legitimately
+// allocate while playing (chunk streaming, texture uploads, the replay log, saving a finished run)
+// is wrapped in HEAP_CHECK_ALLOW().
+//
+// Only compiled in with -DHEAP_CHECK_ENABLED (the Debug target). The counters are per thread, so the
+// loader threads decoding images are not the main loop's business.
+class HeapCheck {
+public:
+    static const int WARMUP_FRAMES = 120;   // two seconds of PLAYING before frames are checked
+
+    static void allocated() {
+        State& s = state();
+        if (s.allowDepth == 0) s.frameAllocations++;
+    }
+
+    // Call once per frame after presenting, playing = the frame was a PLAYING frame
+    static void endFrame(bool playing) {
+        State& s = state();
+        s.playingFrames = playing ? s.playingFrames + 1 : 0;
+        if (s.playingFrames > WARMUP_FRAMES && s.frameAllocations > 0) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "HeapCheck: %d heap allocations in a PLAYING frame", s.frameAllocations);
+            SDL_assert(s.frameAllocations == 0);
+        }
+        s.frameAllocations = 0;
+    }
+
+    // Allocations inside the scope are expected and not counted
+    class Allow {
+    public:
+        Allow() { state().allowDepth++; }
+        ~Allow() { state().allowDepth--; }
+
+        Allow(const Allow&) = delete;
+        Allow& operator=(const Allow&) = delete;
+    };
+
+private:
+    struct State {
+        int frameAllocations;
+        int allowDepth;
+        int playingFrames;
+    };
+
+    static State& state() {
+        static thread_local State s = {0, 0, 0};
+        return s;
+    }
+};
+
+// For replacement allocation functions: GCC inlines them into every new and delete expression and
+// then warns about the malloc/free inside (-Wmismatched-new-delete, -Warray-bounds on a header in
+// front of the block). Out of line, a delete only sees a call.
+#if defined(__GNUC__)
+#define HEAP_NOINLINE __attribute__((noinline))
+#else
+#define HEAP_NOINLINE
+#endif
+
+#define HEAP_CHECK_CONCAT_INNER(a, b) a##b
+#define HEAP_CHECK_CONCAT(a, b) HEAP_CHECK_CONCAT_INNER(a, b)
+
+#ifdef HEAP_CHECK_ENABLED
+#define HEAP_CHECK_ALLOW() HeapCheck::Allow HEAP_CHECK_CONCAT(heapCheckAllow, __LINE__)
+#define HEAP_CHECK_END_FRAME(playing) HeapCheck::endFrame(playing)
+
+// The replacement itself is only compiled where HEAP_CHECK_DEFINE_OPERATORS is defined, once per
+// program (main.cpp), tools with their own operator new can still turn the check on.
+// With allocation tracking on, alloc_tracker.h replaces it and reports here.
+#if defined(HEAP_CHECK_DEFINE_OPERATORS) && !defined(ALLOC_TRACKING_ENABLED)
+void* operator new(size_t size) {
+    void* block = malloc(size ? size : 1);
+    if (block == nullptr) throw std::bad_alloc();
+    HeapCheck::allocated();
+    return block;
+}
+
+HEAP_NOINLINE void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+HEAP_NOINLINE void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+#endif
+#else
+#define HEAP_CHECK_ALLOW() ((void)0)
+#define HEAP_CHECK_END_FRAME(playing) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _INPUTFRAME__H
+#define _INPUTFRAME__H
+#include <SDL.h>
+
+// The player's input for one physics step, the only thing the simulation reads from outside.
+// One byte of held keys, so recorded input streams stay small.
+struct InputFrame {
+    enum Button {
+        UP = 1 << 0,
+        DOWN = 1 << 1,
+        LEFT = 1 << 2,
+        RIGHT = 1 << 3,
+        GRAB_LEFT = 1 << 4,     // A held
+        GRAB_RIGHT = 1 << 5     // D held
+    };
+
+    Uint8 buttons;
+
+    InputFrame() : buttons(0) {}
+    explicit InputFrame(Uint8 b) : buttons(b) {}
+
+    bool held(Button button) const { return (buttons & button) != 0; }
+
+    // Sample the keyboard right now (the game), headless runs build frames from their input stream
+    static InputFrame fromKeyboard() {
+        const Uint8* keystate = SDL_GetKeyboardState(NULL);
+        InputFrame input;
+        if (keystate[SDL_SCANCODE_UP]) input.buttons |= UP;
+        if (keystate[SDL_SCANCODE_DOWN]) input.buttons |= DOWN;
+        if (keystate[SDL_SCANCODE_LEFT]) input.buttons |= LEFT;
+        if (keystate[SDL_SCANCODE_RIGHT]) input.buttons |= RIGHT;
+        if (keystate[SDL_SCANCODE_A]) input.buttons |= GRAB_LEFT;
+        if (keystate[SDL_SCANCODE_D]) input.buttons |= GRAB_RIGHT;
+        return input;
+    }
+};
+
+#endif
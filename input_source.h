@@ -0,0 +1,192 @@
+#ifndef _INPUTSOURCE__H
+#define _INPUTSOURCE__H
+#include <SDL.h>
+#include <cmath>
+#include <cstdint>
+#include "graphics.h"
+#include "input_frame.h"
+#include "simulation.h"
+
+// Whatever decides the InputFrame of the next step: the keyboard in the game, a bot in soak runs
+// (tools/soak, the game with --bot, Game_headless <level> bot). GameSimulation::step only ever sees
+// the InputFrame, so all of them drive exactly the same code.
+class InputSource {
+public:
+    virtual ~InputSource() {}
+
+    // Input for the next step of sim
+    virtual InputFrame next(const GameSimulation& sim) = 0;
+
+    // A level (re)started, forget whatever was about the last one
+    virtual void restart() {}
+};
+
+class KeyboardInput : public InputSource {
+public:
+    InputFrame next(const GameSimulation&) override {
+        return InputFrame::fromKeyboard();
+    }
+};
+
+// Plays like an impatient player: hold both grab keys while falling, swing on whatever caught,
+// pump in the direction of motion and let go when flying forward and up, climb hand over hand
+// when the free hand reaches something ahead. The target is the closest unpressed button while
+// the gates are shut, else the next platform ahead (the finish past the last one). Stuck for a
+// few seconds it mashes random keys for a while. Not a good player, but it grabs, releases, dies,
+// presses buttons and now and then finishes, which is what a soak run needs.
+//
+// Deterministic for a given seed, so a bot run can be recorded and replayed like any other.
+class BotInput : public InputSource {
+public:
+    static const int MIN_HOLD = 20;             // steps on a hand before it may let go
+    static const int MAX_HOLD = 240;            // let go anyway, whatever the swing looks like
+    static const int RELEASE_COOLDOWN = 12;     // no grabbing right after a release, or it catches the same spot
+    static const int STUCK_STEPS = 300;         // no progress for this long starts a wander
+    static const int WANDER_STEPS = 120;
+    static constexpr double RELEASE_SPEED = 150.0;
+
+    explicit BotInput(uint32_t seed = 1) : rng(seed ? seed : 1) {
+        restart();
+    }
+
+    void restart() override {
+        holdSteps = 0;
+        cooldown = 0;
+        stuckSteps = 0;
+        wanderSteps = 0;
+        bestDistance = -1;
+        wanderInput = InputFrame();
+    }
+
+    InputFrame next(const GameSimulation& sim) override {
+        const Character& player = sim.player;
+        double targetX = sim.player.x, targetY = sim.player.y;
+        findTarget(sim, targetX, targetY);
+        double direction = targetX >= player.x ? 1.0 : -1.0;
+
+        // Progress is getting closer to the target, a new target counts as progress too
+        double distance = std::fabs(targetX - player.x) + std::fabs(targetY - player.y);
+        if (bestDistance < 0 || distance < bestDistance - 10) {
+            bestDistance = distance;
+            stuckSteps = 0;
+        } else if (++stuckSteps > STUCK_STEPS) {
+            wanderSteps = WANDER_STEPS;
+            stuckSteps = 0;
+            bestDistance = -1;
+        }
+        if (wanderSteps > 0) return wander();
+
+        InputFrame input;
+        bool left = player.leftHand.isGrabbingObject;
+        bool right = player.rightHand.isGrabbingObject;
+        if (cooldown > 0) cooldown--;
+
+        if (!left && !right) {
+            // Falling or flying: steer, flap, catch anything
+            holdSteps = 0;
+            press(input, direction);
+            input.buttons |= InputFrame::UP;
+            if (cooldown == 0) input.buttons |= InputFrame::GRAB_LEFT | InputFrame::GRAB_RIGHT;
+        } else if (left && right) {
+            // Keep the hand nearer the target, drop the other one
+            bool leftAhead = (player.leftHand.handX() - player.rightHand.handX()) * direction > 0;
+            input.buttons |= leftAhead ? InputFrame::GRAB_LEFT : InputFrame::GRAB_RIGHT;
+            press(input, direction);
+            holdSteps = 0;
+        } else {
+            const ropehand& pivot = left ? player.leftHand : player.rightHand;
+            const ropehand& free = left ? player.rightHand : player.leftHand;
+            holdSteps++;
+
+            // Pump: push along the swing, which adds to it
+            press(input, player.vx != 0 ? (player.vx > 0 ? 1.0 : -1.0) : direction);
+
+            // The free hand tries for anything ahead of the pivot
+            if ((free.handX() - pivot.handX()) * direction > 20) {
+                input.buttons |= left ? InputFrame::GRAB_RIGHT : InputFrame::GRAB_LEFT;
+            }
+
+            // Let go flying towards the target and up, or when the swing is not going anywhere
+            bool launch = holdSteps > MIN_HOLD && player.vx * direction > RELEASE_SPEED && player.vy < 0;
+            if (launch || holdSteps > MAX_HOLD) {
+                cooldown = RELEASE_COOLDOWN;
+                holdSteps = 0;
+            } else {
+                input.buttons |= left ? InputFrame::GRAB_LEFT : InputFrame::GRAB_RIGHT;
+            }
+        }
+        return input;
+    }
+
+private:
+    uint32_t rng;
+    int holdSteps;
+    int cooldown;
+    int stuckSteps;
+    int wanderSteps;
+    double bestDistance;
+    InputFrame wanderInput;
+
+    uint32_t nextRandom() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+
+    static void press(InputFrame& input, double direction) {
+        input.buttons |= direction > 0 ? InputFrame::RIGHT : InputFrame::LEFT;
+    }
+
+    // Random keys, a new combination every quarter second
+    InputFrame wander() {
+        if (wanderSteps-- % 15 == 0) wanderInput.buttons = static_cast<Uint8>(nextRandom() & 0x3f);
+        return wanderInput;
+    }
+
+    // Closest unpressed button while the gates are shut, else the nearest safe platform ahead,
+    // else the finish (or just further right)
+    void findTarget(const GameSimulation& sim, double& targetX, double& targetY) const {
+        const Character& player = sim.player;
+        double best = -1;
+
+        if (!sim.rules.gatesOpen) {
+            for (const Platform& platform : sim.world.platforms) {
+                if (!platform.isInteractive || platform.activated) continue;
+                double cx = platform.rect.x + platform.rect.w / 2.0;
+                double cy = platform.rect.y + platform.rect.h / 2.0;
+                double d = std::fabs(cx - player.x) + std::fabs(cy - player.y);
+                if (best < 0 || d < best) {
+                    best = d;
+                    targetX = cx;
+                    targetY = cy;
+                }
+            }
+            if (best >= 0) return;
+        }
+
+        for (const Platform& platform : sim.world.platforms) {
+            if (platform.isSpike || platform.isInteractive) continue;
+            double cx = platform.rect.x + platform.rect.w / 2.0;
+            if (cx < player.x + player.radius * 2) continue;
+            // Ahead first, height differences count double (climbing is slow)
+            double d = (cx - player.x) + 2 * std::fabs(platform.rect.y - player.y);
+            if (best < 0 || d < best) {
+                best = d;
+                targetX = cx;
+                targetY = platform.rect.y;
+            }
+        }
+        if (best >= 0) return;
+
+        if (sim.rules.hasFinish) {
+            targetX = sim.rules.finishRect.x + sim.rules.finishRect.w / 2.0;
+            targetY = sim.rules.finishRect.y + sim.rules.finishRect.h / 2.0;
+        } else {
+            targetX = player.x + SCREEN_WIDTH;
+            targetY = player.y;
+        }
+    }
+};
+
+#endif
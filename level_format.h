@@ -0,0 +1,271 @@
+#ifndef _LEVELFORMAT__H
+#define _LEVELFORMAT__H
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Level files, shared by the game and tools/levelc.cpp. A level is a list of objects in world space,
+// stored as levels/levelN.lvl (text, for authoring) or levels/levelN.lvb (binary, compiled by levelc).
+//
+// Text form, one object per line, '#' starts a comment, everything in pixels:
+//   background <image>                            drawn stretched over the whole level
+//   width <w>                                     level length, default one screen
+//   platform <image> x y w h
+//   spike <image> x y w h                         touching it respawns the player
+//   mover <image> x y w h fromX toX speed         slides back and forth between fromX and toX
+//   button <image> <pressedImage> x y w h         pressed when the player touches it
+//   gate <image> x y w h                          removed once every button is pressed
+//   spikewall <image> x y w h speed               wall chasing the player from the left
+//   finish x y w h                                reaching it completes the level (once the gates are open)
+// Image paths are relative to the game folder and must not contain spaces.
+//
+// Binary form, little endian:
+//   LevelHeader
+//   LevelRecord[recordCount]
+//   string blob                                   image paths, referenced by offset
+enum LevelObjectType {
+    LEVEL_PLATFORM,
+    LEVEL_SPIKE,
+    LEVEL_MOVER,
+    LEVEL_BUTTON,
+    LEVEL_GATE,
+    LEVEL_SPIKEWALL,
+    LEVEL_FINISH,
+    LEVEL_OBJECT_TYPE_COUNT
+};
+
+const char LEVEL_MAGIC[4] = {'S', 'G', 'L', 'V'};
+const uint32_t LEVEL_VERSION = 1;
+const uint32_t LEVEL_NO_STRING = 0xFFFFFFFFu;
+
+struct LevelHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordCount;
+    uint32_t stringsSize;   // size of the string blob in bytes
+    int32_t width;          // 0 = one screen
+    uint32_t background;    // string offset or LEVEL_NO_STRING
+};
+
+struct LevelRecord {
+    uint8_t type;           // LevelObjectType
+    uint8_t reserved[3];
+    uint32_t image;         // string offsets, LEVEL_NO_STRING when unused
+    uint32_t pressedImage;
+    int32_t x, y, w, h;
+    float from, to, speed;
+};
+
+static_assert(sizeof(LevelHeader) == 24, "LevelHeader must stay 24 bytes");
+static_assert(sizeof(LevelRecord) == 40, "LevelRecord must stay 40 bytes");
+
+// One object of either form
+struct LevelObject {
+    LevelObjectType type;
+    std::string image;
+    std::string pressedImage;
+    int x, y, w, h;
+    float from, to, speed;
+
+    LevelObject() : type(LEVEL_PLATFORM), x(0), y(0), w(0), h(0), from(0), to(0), speed(0) {}
+};
+
+struct LevelDescription {
+    std::string background;
+    int width;
+    std::vector<LevelObject> objects;
+
+    LevelDescription() : width(0) {}
+};
+
+class LevelFormat {
+public:
+    // Parse the text form, error gets "line N: ..." on failure
+    static bool parseText(const char* text, size_t size, LevelDescription& level, std::string& error) {
+        level = LevelDescription();
+        std::istringstream input(std::string(text, size));
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(input, line)) {
+            lineNumber++;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) line.erase(comment);
+
+            std::istringstream words(line);
+            std::string keyword;
+            if (!(words >> keyword)) continue;  // blank line
+
+            bool ok = true;
+            LevelObject object;
+            if (keyword == "background") {
+                ok = static_cast<bool>(words >> level.background);
+            } else if (keyword == "width") {
+                ok = static_cast<bool>(words >> level.width);
+            } else if (keyword == "platform" || keyword == "spike" || keyword == "gate") {
+                object.type = keyword == "platform" ? LEVEL_PLATFORM : keyword == "spike" ? LEVEL_SPIKE : LEVEL_GATE;
+                ok = static_cast<bool>(words >> object.image >> object.x >> object.y >> object.w >> object.h);
+            } else if (keyword == "mover") {
+                object.type = LEVEL_MOVER;
+                ok = static_cast<bool>(words >> object.image >> object.x >> object.y >> object.w >> object.h
+                                             >> object.from >> object.to >> object.speed);
+            } else if (keyword == "button") {
+                object.type = LEVEL_BUTTON;
+                ok = static_cast<bool>(words >> object.image >> object.pressedImage
+                                             >> object.x >> object.y >> object.w >> object.h);
+            } else if (keyword == "spikewall") {
+                object.type = LEVEL_SPIKEWALL;
+                ok = static_cast<bool>(words >> object.image >> object.x >> object.y >> object.w >> object.h
+                                             >> object.speed);
+            } else if (keyword == "finish") {
+                object.type = LEVEL_FINISH;
+                ok = static_cast<bool>(words >> object.x >> object.y >> object.w >> object.h);
+            } else {
+                error = "line " + std::to_string(lineNumber) + ": unknown object '" + keyword + "'";
+                return false;
+            }
+
+            std::string extra;
+            if (!ok || (words >> extra)) {
+                error = "line " + std::to_string(lineNumber) + ": wrong arguments for '" + keyword + "'";
+                return false;
+            }
+            if (keyword != "background" && keyword != "width") level.objects.push_back(object);
+        }
+        return true;
+    }
+
+    // Read the binary form, everything is bounds checked before it is trusted
+    static bool readBinary(const void* data, size_t size, LevelDescription& level, std::string& error) {
+        level = LevelDescription();
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        LevelHeader header;
+        if (size < sizeof(header)) {
+            error = "file too small";
+            return false;
+        }
+        memcpy(&header, bytes, sizeof(header));
+        if (memcmp(header.magic, LEVEL_MAGIC, 4) != 0 || header.version != LEVEL_VERSION) {
+            error = "not a level file or wrong version";
+            return false;
+        }
+
+        size_t recordsEnd = sizeof(header) + static_cast<size_t>(header.recordCount) * sizeof(LevelRecord);
+        if (recordsEnd > size || size - recordsEnd < header.stringsSize) {
+            error = "truncated";
+            return false;
+        }
+        const char* strings = reinterpret_cast<const char*>(bytes + recordsEnd);
+
+        level.width = header.width;
+        if (!readString(strings, header.stringsSize, header.background, level.background, error)) return false;
+
+        level.objects.resize(header.recordCount);
+        for (uint32_t i = 0; i < header.recordCount; i++) {
+            LevelRecord record;
+            memcpy(&record, bytes + sizeof(header) + i * sizeof(LevelRecord), sizeof(record));
+            if (record.type >= LEVEL_OBJECT_TYPE_COUNT) {
+                error = "bad object type";
+                return false;
+            }
+
+            LevelObject& object = level.objects[i];
+            object.type = static_cast<LevelObjectType>(record.type);
+            object.x = record.x;
+            object.y = record.y;
+            object.w = record.w;
+            object.h = record.h;
+            object.from = record.from;
+            object.to = record.to;
+            object.speed = record.speed;
+            if (!readString(strings, header.stringsSize, record.image, object.image, error) ||
+                !readString(strings, header.stringsSize, record.pressedImage, object.pressedImage, error)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Binary form of a level, identical image paths are stored once
+    static void writeBinary(const LevelDescription& level, std::vector<char>& out) {
+        std::string strings;
+        std::vector<LevelRecord> records(level.objects.size());
+
+        LevelHeader header;
+        memcpy(header.magic, LEVEL_MAGIC, 4);
+        header.version = LEVEL_VERSION;
+        header.recordCount = static_cast<uint32_t>(records.size());
+        header.width = level.width;
+        header.background = addString(strings, level.background);
+
+        for (size_t i = 0; i < records.size(); i++) {
+            const LevelObject& object = level.objects[i];
+            LevelRecord& record = records[i];
+            memset(&record, 0, sizeof(record));
+            record.type = static_cast<uint8_t>(object.type);
+            record.image = addString(strings, object.image);
+            record.pressedImage = addString(strings, object.pressedImage);
+            record.x = object.x;
+            record.y = object.y;
+            record.w = object.w;
+            record.h = object.h;
+            record.from = object.from;
+            record.to = object.to;
+            record.speed = object.speed;
+        }
+        header.stringsSize = static_cast<uint32_t>(strings.size());
+
+        out.resize(sizeof(header) + records.size() * sizeof(LevelRecord) + strings.size());
+        memcpy(out.data(), &header, sizeof(header));
+        if (!records.empty()) {
+            memcpy(out.data() + sizeof(header), records.data(), records.size() * sizeof(LevelRecord));
+        }
+        if (!strings.empty()) {
+            memcpy(out.data() + sizeof(header) + records.size() * sizeof(LevelRecord), strings.data(), strings.size());
+        }
+    }
+
+    // Either form, told apart by the magic
+    static bool read(const void* data, size_t size, LevelDescription& level, std::string& error) {
+        if (size >= 4 && memcmp(data, LEVEL_MAGIC, 4) == 0) return readBinary(data, size, level, error);
+        return parseText(static_cast<const char*>(data), size, level, error);
+    }
+
+private:
+    // Strings are stored zero terminated
+    static uint32_t addString(std::string& strings, const std::string& value) {
+        if (value.empty()) return LEVEL_NO_STRING;
+        size_t found = 0;
+        while ((found = strings.find(value, found)) != std::string::npos) {
+            bool starts = found == 0 || strings[found - 1] == '\0';
+            bool ends = found + value.size() < strings.size() && strings[found + value.size()] == '\0';
+            if (starts && ends) return static_cast<uint32_t>(found);
+            found++;
+        }
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings += value;
+        strings += '\0';
+        return offset;
+    }
+
+    static bool readString(const char* strings, uint32_t stringsSize, uint32_t offset,
+                           std::string& value, std::string& error) {
+        value.clear();
+        if (offset == LEVEL_NO_STRING) return true;
+        if (offset >= stringsSize) {
+            error = "string offset out of range";
+            return false;
+        }
+        const void* end = memchr(strings + offset, '\0', stringsSize - offset);
+        if (end == nullptr) {
+            error = "unterminated string";
+            return false;
+        }
+        value.assign(strings + offset, static_cast<const char*>(end));
+        return true;
+    }
+};
+
+#endif
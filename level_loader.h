@@ -0,0 +1,136 @@
+#ifndef _LEVELLOADER__H
+#define _LEVELLOADER__H
+#include <SDL.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "asset_archive.h"
+#include "graphics.h"
+#include "level_format.h"
+#include "texture_atlas.h"
+
+// Everything about the loaded level that is not a platform, the PLAYING state reads its rules from here
+struct LevelRules {
+    std::string background;
+    int width;                  // world width, 0 = one screen
+    bool hasFinish;
+    SDL_Rect finishRect;
+    int buttonCount;
+    int pressedButtons;
+    bool gatesOpen;             // true from the start when the level has no buttons
+    bool hasSpikeWall;
+    SDL_Rect spikeWallRect;
+    Sprite spikeWallSprite;
+    float spikeWallSpeed;
+
+    LevelRules() : width(0), hasFinish(false), finishRect{0, 0, 0, 0}, buttonCount(0), pressedButtons(0),
+                   gatesOpen(true), hasSpikeWall(false), spikeWallRect{0, 0, 0, 0}, spikeWallSpeed(0) {}
+};
+
+// Reads levels/levelN.lvb (or the text levels/levelN.lvl when no compiled file is shipped) and turns
+// it into platforms and rules; LevelStreamer decides when each platform exists. Nothing here knows
+// about individual levels, editing or adding a level file needs no recompile.
+class LevelLoader {
+public:
+    static bool load(int number, LevelDescription& level) {
+        std::string base = "levels/level" + std::to_string(number);
+        std::string name = base + ".lvb";
+        std::vector<char> data;
+        if (!readAsset(name.c_str(), data)) {
+            name = base + ".lvl";
+            if (!readAsset(name.c_str(), data)) {
+                SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                               "Level %d: no %s.lvb or %s.lvl", number, base.c_str(), base.c_str());
+                return false;
+            }
+        }
+
+        std::string error;
+        if (!LevelFormat::read(data.data(), data.size(), level, error)) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "%s: %s", name.c_str(), error.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Images that are not streamed with the chunks (background, spike wall)
+    static std::vector<std::string> imagePaths(const LevelDescription& level) {
+        std::vector<std::string> paths;
+        addPath(paths, level.background);
+        for (const LevelObject& object : level.objects) {
+            if (object.type == LEVEL_SPIKEWALL) addPath(paths, object.image);
+        }
+        return paths;
+    }
+
+    // The rules live for the whole level, one pass over the objects
+    static void readRules(const LevelDescription& level, SDL_Renderer* renderer, LevelRules& rules) {
+        rules = LevelRules();
+        rules.background = level.background;
+        rules.width = level.width;
+
+        for (const LevelObject& object : level.objects) {
+            SDL_Rect rect = {object.x, object.y, object.w, object.h};
+            switch (object.type) {
+                case LEVEL_BUTTON:
+                    rules.buttonCount++;
+                    break;
+                case LEVEL_SPIKEWALL:
+                    rules.hasSpikeWall = true;
+                    rules.spikeWallRect = rect;
+                    rules.spikeWallSprite = sprite(renderer, object.image);
+                    rules.spikeWallSpeed = object.speed;
+                    break;
+                case LEVEL_FINISH:
+                    rules.hasFinish = true;
+                    rules.finishRect = rect;
+                    break;
+                default:
+                    break;
+            }
+        }
+        rules.gatesOpen = rules.buttonCount == 0;
+    }
+
+    // Runtime platform for a platform, spike, mover, button or gate object
+    static Platform makePlatform(const LevelObject& object, SDL_Renderer* renderer) {
+        SDL_Rect rect = {object.x, object.y, object.w, object.h};
+        switch (object.type) {
+            case LEVEL_SPIKE:
+                return Platform(rect, sprite(renderer, object.image), true);
+            case LEVEL_MOVER:
+                return Platform(rect, sprite(renderer, object.image), object.from, object.to, object.speed);
+            case LEVEL_BUTTON:
+                return Platform(rect, sprite(renderer, object.image), sprite(renderer, object.pressedImage));
+            default:
+                return Platform(rect, sprite(renderer, object.image));
+        }
+    }
+
+private:
+    static Sprite sprite(SDL_Renderer* renderer, const std::string& image) {
+        return image.empty() ? Sprite() : TextureAtlas::sprite(renderer, image.c_str());
+    }
+
+    static void addPath(std::vector<std::string>& paths, const std::string& path) {
+        if (path.empty() || std::find(paths.begin(), paths.end(), path) != paths.end()) return;
+        paths.push_back(path);
+    }
+
+    static bool readAsset(const char* name, std::vector<char>& data) {
+        SDL_RWops* rw = AssetArchive::openRW(name);
+        if (rw == nullptr) return false;
+
+        Sint64 size = SDL_RWsize(rw);
+        bool ok = size >= 0;
+        if (ok) {
+            data.resize(static_cast<size_t>(size));
+            ok = size == 0 || SDL_RWread(rw, data.data(), static_cast<size_t>(size), 1) == 1;
+        }
+        SDL_RWclose(rw);
+        return ok;
+    }
+};
+
+#endif
@@ -0,0 +1,353 @@
+#ifndef _LEVELSTREAMER__H
+#define _LEVELSTREAMER__H
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "alloc_tracker.h"
+#include "asset_loader.h"
+#include "defs.h"
+#include "graphics.h"
+#include "heap_check.h"
+#include "level_loader.h"
+#include "texture_cache.h"
+
+// Streams a level in fixed-width world chunks around the camera, so the platforms that are
+// simulated, filed in the grid and drawn, and the textures kept alive for them, depend on the
+// view size instead of the level length.
+//
+// Each chunk moves through three stages as the camera gets closer:
+//   prefetch  its images are queued on the AssetLoader threads and held once uploaded
+//   resident  its platforms are spawned into Graphics::platforms and the grid
+//   unloaded  platforms despawned and texture handles dropped, the cache frees what nobody holds
+// An object touching several chunks (long platforms, mover paths) stays spawned while any of them
+// is resident. Platform indices are slots: a despawned platform leaves a dead slot that the next
+// spawn reuses, so the indices held by the grid and by grabbing hands never shift.
+// Only the level description (a few dozen bytes per object) and one pressed flag per object are
+// kept for the whole level. Movers restart at their fromX when their chunk comes back.
+class LevelStreamer {
+public:
+    static const int CHUNK_WIDTH = 1024;          // world pixels, about half a screen
+    static const int LOAD_MARGIN = 1024;          // chunks this close to the view are resident
+    static const int UNLOAD_MARGIN = 1536;        // and stay resident until this far, so no ping-pong
+    static const int PREFETCH_MARGIN = 2048;      // images start decoding this far out
+    static const int MAX_RESIDENT_CHUNKS = 8;     // the load window never needs more than 6
+
+    LevelStreamer() : gatesOpen(false) {}
+
+    // Start streaming a new level, everything from the previous one is dropped. The images of the
+    // chunks around cameraX are queued on the loader, the first update() spawns them.
+    // Without a loader (headless, no renderer) nothing is prefetched and platforms get no sprites.
+    void open(Graphics& core, const LevelDescription& description, double cameraX, AssetLoader* loader) {
+        core.platforms.clear();
+        core.platformGrid.clear();
+        level = description;
+        gatesOpen = false;
+        freeSlots.clear();
+        slotObject.clear();
+        resident.clear();
+        prefetched.clear();
+
+        // Level extent: its width, or further if objects stick out past it
+        int right = std::max(level.width, static_cast<int>(SCREEN_WIDTH));
+        for (const LevelObject& object : level.objects) {
+            if (isStreamed(object.type)) right = std::max(right, extentRight(object));
+        }
+        chunks.assign(right / CHUNK_WIDTH + 1, Chunk());
+
+        objectSlot.assign(level.objects.size(), -1);
+        objectRefs.assign(level.objects.size(), 0);
+        pressed.assign(level.objects.size(), 0);
+        for (int i = 0; i < static_cast<int>(level.objects.size()); i++) {
+            const LevelObject& object = level.objects[i];
+            if (!isStreamed(object.type)) continue;
+            int first = chunkAt(extentLeft(object));
+            int last = chunkAt(extentRight(object));
+            for (int c = first; c <= last; c++) chunks[c].objects.push_back(i);
+        }
+
+        // Slots never outnumber the streamed objects, with room for all of them up front spawning
+        // while playing does not grow these (the Debug build checks the PLAYING loop for allocations)
+        size_t streamed = 0;
+        for (const LevelObject& object : level.objects) {
+            if (isStreamed(object.type)) streamed++;
+        }
+        core.platforms.reserve(streamed);
+        slotObject.reserve(streamed);
+        freeSlots.reserve(streamed);
+        resident.reserve(chunks.size());
+        prefetched.reserve(chunks.size());
+
+        prefetch(cameraX, loader);
+    }
+
+    // Every physics step, at the start of GameSimulation::step, so a respawn far back already stands
+    // on its platforms. The chunks holding a grabbed platform are never unloaded, whatever the
+    // camera does.
+    void update(Graphics& core, double cameraX, const Character& player, AssetLoader* loader) {
+        int loadFirst = chunkAt(cameraX - LOAD_MARGIN);
+        int loadLast = chunkAt(cameraX + SCREEN_WIDTH + LOAD_MARGIN);
+        int keepFirst = chunkAt(cameraX - UNLOAD_MARGIN);
+        int keepLast = chunkAt(cameraX + SCREEN_WIDTH + UNLOAD_MARGIN);
+        int pinnedA = player.leftHand.isGrabbingObject ? player.leftHand.grabbedPlatformIndex : -1;
+        int pinnedB = player.rightHand.isGrabbingObject ? player.rightHand.grabbedPlatformIndex : -1;
+
+        // Unload chunks that fell behind (or got too far ahead)
+        for (size_t i = 0; i < resident.size();) {
+            int c = resident[i];
+            if ((c < keepFirst || c > keepLast) && !holdsSlot(c, pinnedA, pinnedB)) {
+                unloadChunk(core, c);
+                resident.erase(resident.begin() + i);
+            } else {
+                i++;
+            }
+        }
+
+        prefetch(cameraX, loader);
+
+        // Spawn the load window, the chunks under the view first
+        double center = cameraX + SCREEN_WIDTH / 2.0;
+        for (int step = 0; step <= 2 * (loadLast - loadFirst); step++) {
+            int c = chunkAt(center) + ((step % 2) ? (step + 1) / 2 : -(step / 2));
+            if (c < loadFirst || c > loadLast || chunks[c].resident) continue;
+
+            if (static_cast<int>(resident.size()) >= MAX_RESIDENT_CHUNKS &&
+                !evictFarthest(core, loadFirst, loadLast, center, pinnedA, pinnedB)) {
+                SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                               "LevelStreamer: residency budget of %d chunks is full", MAX_RESIDENT_CHUNKS);
+                break;
+            }
+            loadChunk(core, c);
+            resident.push_back(c);
+        }
+
+        // Everything queued so far is held by a chunk now, the loader can let go of its copies
+        if (loader != nullptr && loader->done()) loader->finishBatch();
+    }
+
+    // Every button is pressed: despawn the gates, and never spawn them again
+    void openGates(Graphics& core) {
+        gatesOpen = true;
+        for (int slot = 0; slot < static_cast<int>(slotObject.size()); slot++) {
+            int object = slotObject[slot];
+            if (object >= 0 && level.objects[object].type == LEVEL_GATE) despawn(core, object);
+        }
+    }
+
+    int chunkCount() const { return static_cast<int>(chunks.size()); }
+    int residentChunkCount() const { return static_cast<int>(resident.size()); }
+    int prefetchedChunkCount() const { return static_cast<int>(prefetched.size()); }
+
+    // Level object living in a platform slot, -1 for a dead slot
+    int objectInSlot(int slot) const {
+        return slot >= 0 && slot < static_cast<int>(slotObject.size()) ? slotObject[slot] : -1;
+    }
+
+    int livePlatformCount() const {
+        return static_cast<int>(slotObject.size() - freeSlots.size());
+    }
+
+private:
+    struct Chunk {
+        std::vector<int> objects;               // every streamed object touching the chunk
+        std::vector<std::string> images;        // queued on the loader, waiting for the upload
+        std::vector<TextureHandle> textures;    // held while prefetched or resident
+        bool queued;
+        bool resident;
+
+        Chunk() : queued(false), resident(false) {}
+    };
+
+    LevelDescription level;
+    std::vector<Chunk> chunks;
+    std::vector<int> objectSlot;      // per object: its platform slot, -1 while despawned
+    std::vector<int> objectRefs;      // per object: how many resident chunks it touches
+    std::vector<char> pressed;        // per object: button state survives unloading
+    std::vector<int> slotObject;      // per slot: the object living there, -1 for a dead slot
+    std::vector<int> freeSlots;
+    std::vector<int> resident;        // chunk indices
+    std::vector<int> prefetched;      // chunk indices holding (or waiting for) textures
+    bool gatesOpen;
+
+    static bool isStreamed(LevelObjectType type) {
+        return type == LEVEL_PLATFORM || type == LEVEL_SPIKE || type == LEVEL_MOVER ||
+               type == LEVEL_BUTTON || type == LEVEL_GATE;
+    }
+
+    // World x range the object can cover, a mover covers its whole path
+    static int extentLeft(const LevelObject& object) {
+        if (object.type != LEVEL_MOVER) return object.x;
+        return static_cast<int>(std::floor(std::min(object.from, object.to)));
+    }
+
+    static int extentRight(const LevelObject& object) {
+        if (object.type != LEVEL_MOVER) return object.x + object.w;
+        return static_cast<int>(std::ceil(std::max(object.from, object.to))) + object.w;
+    }
+
+    int chunkAt(double x) const {
+        int c = static_cast<int>(std::floor(x / CHUNK_WIDTH));
+        return std::max(0, std::min(c, static_cast<int>(chunks.size()) - 1));
+    }
+
+    // Queue the images of the prefetch window, promote finished ones to held handles and release
+    // chunks that left the window without ever becoming resident
+    void prefetch(double cameraX, AssetLoader* loader) {
+        if (loader == nullptr) return;
+
+        int first = chunkAt(cameraX - PREFETCH_MARGIN);
+        int last = chunkAt(cameraX + SCREEN_WIDTH + PREFETCH_MARGIN);
+
+        for (size_t i = 0; i < prefetched.size();) {
+            Chunk& chunk = chunks[prefetched[i]];
+            if (!chunk.resident && (prefetched[i] < first || prefetched[i] > last)) {
+                chunk.images.clear();
+                chunk.textures.clear();
+                chunk.queued = false;
+                prefetched.erase(prefetched.begin() + i);
+            } else {
+                i++;
+            }
+        }
+
+        for (int c = first; c <= last; c++) {
+            Chunk& chunk = chunks[c];
+            if (chunk.queued) continue;
+            ALLOC_SCOPE(ALLOC_LEVEL_LOAD);
+            HEAP_CHECK_ALLOW();     // a chunk entering the window: image names, loader requests
+            chunk.queued = true;
+            prefetched.push_back(c);
+            for (int object : chunk.objects) {
+                queueImage(chunk, loader, level.objects[object].image);
+                queueImage(chunk, loader, level.objects[object].pressedImage);
+            }
+        }
+
+        // Take our own handle as soon as the upload happened; a failed decode stays pending until
+        // the loader is done and is then left to the synchronous load in spawn()
+        for (int c : prefetched) {
+            Chunk& chunk = chunks[c];
+            if (chunk.images.empty()) continue;
+            HEAP_CHECK_ALLOW();
+            for (size_t i = 0; i < chunk.images.size();) {
+                TextureHandle texture = TextureCache::get(chunk.images[i].c_str());
+                if (texture || loader->done()) {
+                    if (texture) chunk.textures.push_back(texture);
+                    chunk.images.erase(chunk.images.begin() + i);
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+
+    static void queueImage(Chunk& chunk, AssetLoader* loader, const std::string& image) {
+        if (image.empty() || TextureAtlas::contains(image.c_str())) return;
+        if (std::find(chunk.images.begin(), chunk.images.end(), image) != chunk.images.end()) return;
+        chunk.images.push_back(image);
+        loader->requestTexture(image.c_str());
+    }
+
+    void loadChunk(Graphics& core, int c) {
+        ALLOC_SCOPE(ALLOC_LEVEL_LOAD);
+        HEAP_CHECK_ALLOW();     // atlas lookups and new grid cells
+        Chunk& chunk = chunks[c];
+        chunk.resident = true;
+        for (int object : chunk.objects) {
+            if (objectRefs[object]++ == 0) spawn(core, object);
+        }
+        reserveMoverPaths(core);
+    }
+
+    // A mover crossing into a cell for the first time would allocate its list mid-level, so the
+    // cells along every live mover's path get room for all of them now
+    void reserveMoverPaths(Graphics& core) {
+        int movers = 0;
+        for (int object : slotObject) {
+            if (object >= 0 && level.objects[object].type == LEVEL_MOVER) movers++;
+        }
+        for (int object : slotObject) {
+            if (object < 0 || level.objects[object].type != LEVEL_MOVER) continue;
+            const LevelObject& mover = level.objects[object];
+            int left = extentLeft(mover);
+            SDL_Rect path = {left, mover.y, extentRight(mover) - left, mover.h};
+            core.platformGrid.reserve(path, movers);
+        }
+    }
+
+    void unloadChunk(Graphics& core, int c) {
+        Chunk& chunk = chunks[c];
+        chunk.resident = false;
+        for (int object : chunk.objects) {
+            if (--objectRefs[object] == 0) despawn(core, object);
+        }
+    }
+
+    // Make room in the budget: the resident chunk farthest from the view that is outside the load
+    // window and holds no grabbed platform
+    bool evictFarthest(Graphics& core, int loadFirst, int loadLast, double center, int pinnedA, int pinnedB) {
+        int victim = -1;
+        double victimDistance = -1;
+        for (int i = 0; i < static_cast<int>(resident.size()); i++) {
+            int c = resident[i];
+            if ((c >= loadFirst && c <= loadLast) || holdsSlot(c, pinnedA, pinnedB)) continue;
+            double distance = std::fabs((c + 0.5) * CHUNK_WIDTH - center);
+            if (distance > victimDistance) {
+                victim = i;
+                victimDistance = distance;
+            }
+        }
+        if (victim < 0) return false;
+        unloadChunk(core, resident[victim]);
+        resident.erase(resident.begin() + victim);
+        return true;
+    }
+
+    bool holdsSlot(int c, int slotA, int slotB) const {
+        for (int object : chunks[c].objects) {
+            int slot = objectSlot[object];
+            if (slot >= 0 && (slot == slotA || slot == slotB)) return true;
+        }
+        return false;
+    }
+
+    void spawn(Graphics& core, int object) {
+        const LevelObject& description = level.objects[object];
+        if (description.type == LEVEL_GATE && gatesOpen) return;
+
+        Platform platform = LevelLoader::makePlatform(description, core.renderer);
+        if (pressed[object]) platform.activate();
+
+        int slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            core.platforms[slot] = platform;
+        } else {
+            slot = static_cast<int>(core.platforms.size());
+            core.platforms.push_back(platform);
+            slotObject.push_back(-1);
+        }
+        slotObject[slot] = object;
+        objectSlot[object] = slot;
+        core.platformGrid.insert(slot, platform.rect);
+    }
+
+    void despawn(Graphics& core, int object) {
+        int slot = objectSlot[object];
+        if (slot < 0) return;
+
+        Platform& platform = core.platforms[slot];
+        if (platform.isInteractive) pressed[object] = platform.activated;
+        core.platformGrid.remove(slot, platform.rect);
+
+        // Dead slot: no sprite, no size, not moving, not in the grid
+        platform = Platform(SDL_Rect{0, 0, 0, 0}, Sprite());
+        slotObject[slot] = -1;
+        objectSlot[object] = -1;
+        freeSlots.push_back(slot);
+    }
+};
+
+#endif
@@ -1,3 +1,7 @@
+// The global operator new/delete replacements of the Debug (heap_check.h) and Tracking
+// (alloc_tracker.h) builds live in this file
+#define HEAP_CHECK_DEFINE_OPERATORS
+#define ALLOC_TRACKING_DEFINE_OPERATORS
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_mixer.h>
@@ -8,7 +12,21 @@
 #include "graphics.h"
 #include "menupanel.h"
 #include "music.h"
-#include "level_platforms.h"
+#include "level_loader.h"
+#include "input_source.h"
+#include "replay.h"
+#include "simulation.h"
+#include "visibility.h"
+#include "texture_cache.h"
+#include "texture_atlas.h"
+#include "asset_archive.h"
+#include "asset_loader.h"
+#include "frame_interpolation.h"
+#include "camera.h"
+#include "profiler.h"
+#include "frame_arena.h"
+#include "heap_check.h"
+#include "alloc_tracker.h"
 
 using namespace std;
 
@@ -16,6 +34,7 @@ enum GameState {
     MENU,
     CHARACTER_SELECTION,
     LEVEL_SELECTION,
+    LOADING,
     PLAYING,
     OPTIONS,
     HOWTOPLAY,
@@ -25,79 +44,157 @@ enum GameState {
 int currentCharacterIndex = 0;  // 0: red, 1: mint, 2: black, 3: sabrina
 // Character images shown in the menu
 const char* characterMenuPaths[] = {
-    "F:\\Game\\graphic\\red-Photoroom.png",
-    "F:\\Game\\graphic\\mint (2)-Photoroom.png",
-    "F:\\Game\\graphic\\againblac-Photoroom.png",
-    "F:\\Game\\graphic\\allhailsabrina-Photoroom.png"
+    "graphic/red-Photoroom.png",
+    "graphic/mint (2)-Photoroom.png",
+    "graphic/againblac-Photoroom.png",
+    "graphic/allhailsabrina-Photoroom.png"
 };
 // Actual character images used during gameplay
 const char* characterGamePaths[] = {
-    "F:\\Game\\graphic\\character.png",
-    "F:\\Game\\graphic\\mintchar-Photoroom.png",
-    "F:\\Game\\graphic\\blackchar-Photoroom.png",
-    "F:\\Game\\graphic\\3735783d-bb0e-422b-870a-5176cba98eaf-Photoroom.png"
+    "graphic/character.png",
+    "graphic/mintchar-Photoroom.png",
+    "graphic/blackchar-Photoroom.png",
+    "graphic/3735783d-bb0e-422b-870a-5176cba98eaf-Photoroom.png"
 };
 SDL_Rect leftArrowRect, rightArrowRect, characterRect;  // Add characterRect to global variables
 
 // Add these global variables after the character paths
 const char* levelPaths[] = {
-    "F:\\Game\\graphic\\lv1-Photoroom (1).png",
-    "F:\\Game\\graphic\\lv2-Photoroom (1).png",
-    "F:\\Game\\graphic\\lv3-Photoroom (1).png",
-    "F:\\Game\\graphic\\lv4-Photoroom (1).png",
-    "F:\\Game\\graphic\\lv5-Photoroom (1).png"
+    "graphic/lv1-Photoroom (1).png",
+    "graphic/lv2-Photoroom (1).png",
+    "graphic/lv3-Photoroom (1).png",
+    "graphic/lv4-Photoroom (1).png",
+    "graphic/lv5-Photoroom (1).png"
 };
 SDL_Rect levelRects[5];  // Array to store level button rectangles
 
+// Small sprites packed into the texture atlas at startup: hands, level platforms and menu buttons.
+// The full screen images (backgrounds, congrat, guide...) stay standalone textures.
+const std::vector<const char*> atlasSpritePaths = {
+    // Hands
+    "graphic/lefthandrelease.png", "graphic/righthandrelease.png", "graphic/grableft.png", "graphic/grabright.png",
+    "graphic/mintleftrelease-Photoroom.png", "graphic/mintleftrelease-Photoroom - Copy.png",
+    "graphic/mintrightgrab-Photoroom.png", "graphic/mintrightgrab-Photoroom - Copy.png",
+    "graphic/blackreleaseleft-Photoroom.png", "graphic/blackreleaseleft-Photoroom - Copy.png",
+    "graphic/blacklefthand-Photoroom - Copy.png", "graphic/blacklefthand-Photoroom - Copy - Copy.png",
+    "graphic/sabrinaleftrelease-removebg-preview.png", "graphic/sabrinaleftrelease-removebg-preview - Copy.png",
+    "graphic/sabrinaleftgrab-removebg-preview.png", "graphic/sabrinaleftgrab-removebg-preview - Copy.png",
+    // Platforms
+    "graphic/platform.png", "graphic/squarething.png", "graphic/smallblackpf-Photoroom.png", "graphic/poll.png",
+    "graphic/ngang.png", "graphic/pressme-Photoroom.png", "graphic/wow-Photoroom.png", "graphic/finish.png",
+    // Menu
+    "graphic/startbut.png", "graphic/optionsbut.png", "graphic/waybut.png", "graphic/quitbut.png",
+    "graphic/volume.png", "graphic/sfx.png", "graphic/lock-removebg-preview.png", "graphic/back (2).png",
+    "graphic/chontrai-Photoroom.png", "graphic/chonphai-Photoroom.png",
+    "graphic/chooseyourchar-Photoroom.png", "graphic/levil-Photoroom.png",
+    "graphic/lv1-Photoroom (1).png", "graphic/lv2-Photoroom (1).png", "graphic/lv3-Photoroom (1).png",
+    "graphic/lv4-Photoroom (1).png", "graphic/lv5-Photoroom (1).png"
+};
+
 // Add these global variables after the character paths
 bool characterUnlocked[] = {true, false, false, false};  // Only red character is unlocked initially
-SDL_Texture* lockTexture = nullptr;  // Will store the lock image texture
+Sprite lockTexture;  // Will store the lock image sprite
 
 // Add these global variables after the level paths
 bool levelUnlocked[] = {true, false, false, false, false};  // Only level 1 is unlocked initially
-SDL_Texture* levelLockTexture = nullptr;  // Will store the level lock image texture
+Sprite levelLockTexture;  // Will store the level lock image sprite
 int selectedLevel = 1;  // Currently selected level, starts at 1
 
-// Add these global variables after the other global variables
-double cameraOffsetX = 0;
-int currentScreenIndex = 0;  // Which screen the player is on (0-based)
-const int SCREEN_COUNT = 3;  // Total number of screens in level 2
-const int SCREEN_TRANSITION_X = SCREEN_WIDTH - 200;  // Trigger transition when near right edge
-Uint32 lastTransitionTime = 0;  // Time of last screen transition
-const Uint32 TRANSITION_COOLDOWN = 500;  // Minimum time between transitions (milliseconds)
-double playerWorldX = 300;  // Track player's actual world position
-
-// Add global variables for the spike walls at the top of the file with other globals
-MovingObject* spikeWall = nullptr;
-bool isSpikewallActive = false;
-
-// Add finish line tracking flags
-SDL_Rect level1FinishRect = {SCREEN_WIDTH - 300, 400, 100, 50};
-SDL_Rect level2FinishRect = {SCREEN_WIDTH * 3 - 300, 350, 200, 100};
-SDL_Rect level3FinishRect = {SCREEN_WIDTH * 3 - 300, 350, 200, 100};
-SDL_Rect level4FinishRect = {SCREEN_WIDTH * 3 - 300, 350, 200, 100};
-SDL_Rect level5FinishRect = {SCREEN_WIDTH - 300, 400, 100, 50}; // Finish rect for level 5
-bool finishLineEnabled = true;
+// Visibility pass of the PLAYING renderer, counters logged (debug priority) every CULL_REPORT_FRAMES
+CullStats cullStats;
+const int CULL_REPORT_FRAMES = 300;
+
+// Background of the current level, loaded once when the level is selected
+TextureHandle levelBackgroundTexture;
 
 // Back button variables
-SDL_Texture* backButtonTexture = nullptr;
+Sprite backButtonSprite;
 SDL_Rect backButtonRect = {20, 20, 60, 60}; // Position in top-left corner with size 60x60
 
 // Check new character prompt variables
-SDL_Texture* checkNewCharTexture = nullptr;
+Sprite checkNewCharSprite;
 SDL_Rect checkNewCharRect = {0, 0, 0, 0}; // Will be set when loaded
 bool showingNewCharPrompt = false;
 bool hasUnlockedNewChar = false;
 // Variables to save camera position when showing prompt
-int savedScreenIndex = 0;
-double savedCameraOffsetX = 0;
+
+// Hand the sound effects decoded by the loader threads over to the music player
+static void collectLoadedSounds(AssetLoader& loader, Music& music) {
+    if (Mix_Chunk* chunk = loader.takeSound("sounds/grabbing.mp3")) music.setGrabSound(chunk);
+    if (Mix_Chunk* chunk = loader.takeSound("sounds/huhu.mp3")) music.setFallSound(chunk);
+    if (Mix_Chunk* chunk = loader.takeSound("sounds/applause.mp3")) music.setApplauseSound(chunk);
+}
+
+// Simple progress bar shown while level assets stream in
+static void renderLoadingScreen(SDL_Renderer* renderer, float progress) {
+    SDL_Rect track = {SCREEN_WIDTH / 2 - 400, SCREEN_HEIGHT / 2 - 20, 800, 40};
+    SDL_Rect filled = track;
+    filled.w = static_cast<int>(track.w * progress);
+
+    SDL_SetRenderDrawColor(renderer, 150, 150, 150, 255);  // Light gray
+    SDL_RenderFillRect(renderer, &track);
+    SDL_SetRenderDrawColor(renderer, 70, 130, 180, 255);   // Steel blue, same as the volume sliders
+    SDL_RenderFillRect(renderer, &filled);
+    SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
+    SDL_RenderDrawRect(renderer, &track);
+}
+
+// Sounds for what happened during a physics step
+static void playSimulationSounds(const SimEvents& events, Music& music) {
+    if (events.grabPresses > 0) music.playGrabSound();
+    if (events.buttonsPressed > 0) music.playApplauseSound();
+    if (events.finished) {
+        // Buttons may have played it already, force it again
+        music.resetApplause();
+        music.playApplauseSound();
+    }
+}
+
+// Keep the finished run as levelN_last.sgr, and as levelN_best.sgr when it beat the best one so far
+static void saveReplays(ReplayLog& replay, const GameSimulation& sim) {
+    replay.finish(sim);
+    std::string prefix = "level" + std::to_string(replay.level);
+    replay.save(AssetArchive::userPath((prefix + "_last.sgr").c_str()));
+
+    ReplayLog best;
+    std::string bestPath = AssetArchive::userPath((prefix + "_best.sgr").c_str());
+    if (!best.load(bestPath) || replay.steps < best.steps) {
+        replay.save(bestPath);
+    }
+}
 
 int SDL_main(int argc, char* argv[]) {
+#ifdef ALLOC_TRACKING_ENABLED
+    // Before any other SDL call, everything SDL allocates from here on is tracked
+    AllocTracker::install(argc, argv);
+#endif
+
+    // Map the packed assets before anything is loaded, falls back to the loose graphic/ and sounds/ folders
+    AssetArchive::mount("assets.pak");
+
+#ifdef PROFILER_ENABLED
+    // --trace <file> or SWING_TRACE=<file>: stream every profiler zone to a Chrome trace
+    const char* tracePath = SDL_getenv("SWING_TRACE");
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+    }
+    if (tracePath != nullptr && tracePath[0] != '\0') ChromeTrace::open(tracePath);
+#endif
+
+    // --bot: BotInput plays the level instead of the keyboard, for soak runs with textures and sound
+    bool botPlays = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bot") == 0) botPlays = true;
+    }
+
     Graphics core;
     core.init();
 
+    // Pack the small sprites before anything asks for them, every load below gets an atlas region
+    TextureAtlas::build(core.renderer, atlasSpritePaths);
+
     // Create character with medium radius (30 pixels = 60x60 total size)
-    Character player(core.renderer, 300, 100, 30, 10);  // x, y, radius=30, particles=10
+    Character player(core.renderer, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
 
     // Set the initial character texture to the currently selected character
     player.setTexture(core.renderer, characterGamePaths[currentCharacterIndex]);
@@ -106,70 +203,96 @@ int SDL_main(int argc, char* argv[]) {
     MenuPanel menu(core.renderer, 0, 0, 0, 0);  // Position and size are handled internally
 
     // Add menu items
-    menu.addItem("F:\\Game\\graphic\\startbut.png", []() {
+    menu.addItem("graphic/startbut.png", []() {
         // Start game logic
     });
 
-    menu.addItem("F:\\Game\\graphic\\optionsbut.png", []() {
+    menu.addItem("graphic/optionsbut.png", []() {
         // Options logic
     });
 
-    menu.addItem("F:\\Game\\graphic\\waybut.png", []() {
+    menu.addItem("graphic/waybut.png", []() {
         // How to play logic
     });
 
-    menu.addItem("F:\\Game\\graphic\\quitbut.png", []() {
+    menu.addItem("graphic/quitbut.png", []() {
         // Quit game logic
     });
 
-    // Initialize music
+    // Worker threads that decode images and sounds off the render thread
+    AssetLoader loader;
+
+    // Everything the PLAYING state simulates: level, sim.camera, spike wall and the rules
+    GameSimulation sim(core, player, &loader);
+
+    // Initialize music, the sound effects are decoded in the background and attached once ready
     Music backgroundMusic;
-    backgroundMusic.loadMusic("F:\\Game\\sounds\\bgmusic.mp3");
-    backgroundMusic.loadSound("F:\\Game\\sounds\\grabbing.mp3");
-    backgroundMusic.loadFallSound("F:\\Game\\sounds\\huhu.mp3");
-    backgroundMusic.loadApplauseSound("F:\\Game\\sounds\\applause.mp3");
-    backgroundMusic.play();
+    {
+        ALLOC_SCOPE(ALLOC_AUDIO);
+        backgroundMusic.loadMusic("sounds/bgmusic.mp3");
+        loader.requestSound("sounds/grabbing.mp3");
+        loader.requestSound("sounds/huhu.mp3");
+        loader.requestSound("sounds/applause.mp3");
+        backgroundMusic.play();
+    }
 
     // Load back button texture
-    backButtonTexture = IMG_LoadTexture(core.renderer, "F:\\Game\\graphic\\back (2).png");
-    if (!backButtonTexture) {
+    backButtonSprite = TextureAtlas::sprite(core.renderer, "graphic/back (2).png");
+    if (!backButtonSprite) {
         // SDL_Log("Failed to load back button texture: %s", IMG_GetError());
     }
 
     // Load check new character texture
-    checkNewCharTexture = IMG_LoadTexture(core.renderer, "F:\\Game\\graphic\\checknewchar.png");
+    checkNewCharSprite = TextureAtlas::sprite(core.renderer, "graphic/checknewchar.png");
         // Get texture dimensions and center it on screen
-        int texWidth, texHeight;
-        SDL_QueryTexture(checkNewCharTexture, NULL, NULL, &texWidth, &texHeight);
+        int texWidth = checkNewCharSprite.src.w;
+        int texHeight = checkNewCharSprite.src.h;
         checkNewCharRect = {
             (SCREEN_WIDTH - texWidth) / 2,
             (SCREEN_HEIGHT - texHeight) / 2,
             texWidth,
             texHeight
         };
-    // Initialize level-specific objects
-    if (spikeWall == nullptr) {
-        // Create the spike wall - full screen height
-        SDL_Rect spikeRect = {-200, 0, 200, SCREEN_HEIGHT}; // Full screen height
-        SDL_Texture* spikeTexture = IMG_LoadTexture(core.renderer, "F:\\Game\\graphic\\spikewall.png");
-        spikeWall = new MovingObject(spikeRect, spikeTexture, 1.0, 0);
-    }
-
     bool running = true;
     GameState currentState = MENU;
     SDL_Event event;
 
-    // Add delta time tracking for consistent physics
-    Uint32 previousTicks = SDL_GetTicks();
-    const double dt = 1.0 / 60.0;  // Fixed time step (60 FPS)
+    // Fixed-step physics: one simulation step every STEP_SECONDS, rendering blends the last two states
+    const double MAX_FRAME_TIME = 0.25;  // after a stall, drop time instead of running hundreds of steps
+    const double counterFrequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+    Uint8 tappedButtons = 0;  // grab keys pressed since the last physics step
+    ReplayLog replay;         // inputs of the current run, saved when the level is finished
+    KeyboardInput keyboard;
+    BotInput bot;
+    InputSource* inputSource = botPlays ? static_cast<InputSource*>(&bot) : &keyboard;
+    PhysicsSnapshot previousPhysics, currentPhysics, blendedPhysics;
+    FrameArena frameArena;    // whatever only lives until the frame is presented
+
+    // With vsync SDL_RenderPresent already waits for the display, only sleep when it does not
+    SDL_RendererInfo rendererInfo;
+    bool hasVsync = SDL_GetRendererInfo(core.renderer, &rendererInfo) == 0 &&
+                    (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
 
     while (running) {
+        PROFILE_NEW_FRAME();
+
         // Handle events
+        PROFILE_ZONE_NAMED(eventsZone, ZONE_EVENTS);
         while (SDL_PollEvent(&event)) {
+            ALLOC_SCOPE(ALLOC_MENU);
             if (event.type == SDL_QUIT) {
                 running = false;
             }
 
+#ifdef PROFILER_ENABLED
+            // F3 shows the frame profiler in any state
+            if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F3 && !event.key.repeat) {
+                Profiler::toggleOverlay();
+            }
+#endif
+
             if (currentState == MENU) {
                 menu.handleEvent(event);
 
@@ -239,7 +362,7 @@ int SDL_main(int argc, char* argv[]) {
 
                 // Load lock texture if not already loaded
                 if (!lockTexture) {
-                    lockTexture = IMG_LoadTexture(core.renderer, "F:\\Game\\graphic\\lock-removebg-preview.png");
+                    lockTexture = TextureAtlas::sprite(core.renderer, "graphic/lock-removebg-preview.png");
                 }
             }
             else if (currentState == LEVEL_SELECTION) {
@@ -265,43 +388,15 @@ int SDL_main(int argc, char* argv[]) {
 
                 // Use the menu's level selection handler
                 int clickedLevel = menu.handleLevelSelectionEvent(event, levelUnlocked);
+                // The textures are decoded on the loader threads, the LOADING state uploads them
+                // and spawns the first chunks once everything is in
                 if (clickedLevel > 0) {
-                    selectedLevel = clickedLevel;
-                    // Update platforms for the selected level
-                    core.platforms = LevelPlatforms::getPlatformsForLevel(selectedLevel, core.renderer);
-                    // Reset player position for the new level
-                    player.resetPosition();
-
-                    // Ensure character texture is set to the current selection
-                    player.setTexture(core.renderer, characterGamePaths[currentCharacterIndex]);
-
-                    // Reset screen tracking
-                    currentScreenIndex = 0;
-                    cameraOffsetX = 0;
-
-                    // Reset finish line state
-                    finishLineEnabled = true;
-                    player.hasReachedFinish = false;
-                    player.showingCongratulations = false;
-                    showingNewCharPrompt = false;
-                    hasUnlockedNewChar = false;
-
-                    // Reset applause sound flag so it can play again
-                    backgroundMusic.resetApplause();
-
-                    // If selecting Level 3, reset spike walls
-                    if (selectedLevel == 3) {
-                        if (spikeWall) {
-                            spikeWall->reset();
-                            // Set a slower speed specifically for Level 3
-                            spikeWall->velocityX = 1.0;
-                        }
-                        isSpikewallActive = true;
-                    } else {
-                        isSpikewallActive = false;
+                    PROFILE_ZONE(ZONE_LEVEL_LOAD);
+                    ALLOC_SCOPE(ALLOC_LEVEL_LOAD);
+                    if (sim.loadLevel(clickedLevel)) {
+                        selectedLevel = clickedLevel;
+                        currentState = LOADING;
                     }
-
-                    currentState = PLAYING;
                 }
             }
             else if (currentState == PLAYING) {
@@ -314,7 +409,7 @@ int SDL_main(int argc, char* argv[]) {
                                 hasUnlockedNewChar = false;
                                 currentState = CHARACTER_SELECTION;
                                 player.showingCongratulations = false;
-                                finishLineEnabled = true;
+                                sim.finishLineEnabled = true;
                                 // No need to restore camera position since leaving the level
                                 break;
 
@@ -323,7 +418,7 @@ int SDL_main(int argc, char* argv[]) {
                                 hasUnlockedNewChar = false;
                                 currentState = LEVEL_SELECTION;
                                 player.showingCongratulations = false;
-                                finishLineEnabled = true;
+                                sim.finishLineEnabled = true;
                                 // No need to restore camera position since leaving the level
                                 break;
 
@@ -334,39 +429,21 @@ int SDL_main(int argc, char* argv[]) {
                     } else {
                         // Handle normal gameplay keys
                         switch (event.key.keysym.scancode) {
-                            case SDL_SCANCODE_A:  // Left hand grab
-                                if (selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4) {
-                                    // Use the camera-aware grab method for levels with camera system
-                                    player.grabWithCamera(true, core.platforms, cameraOffsetX);
-                                } else {
-                                    player.grab(true, core.platforms);
-                                }
-                                if (!event.key.repeat) {  // Only play sound on initial press, not repeat
-                                    backgroundMusic.playGrabSound();
-                                }
+                            case SDL_SCANCODE_A:  // Left hand grab, held state is sampled every step
+                                tappedButtons |= InputFrame::GRAB_LEFT;  // a tap shorter than a frame still counts
                                 break;
                             case SDL_SCANCODE_D:  // Right hand grab
-                                if (selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4) {
-                                    // Use the camera-aware grab method for levels with camera system
-                                    player.grabWithCamera(false, core.platforms, cameraOffsetX);
-                                } else {
-                                    player.grab(false, core.platforms);
-                                }
-                                if (!event.key.repeat) {  // Only play sound on initial press, not repeat
-                                    backgroundMusic.playGrabSound();
-                                }
+                                tappedButtons |= InputFrame::GRAB_RIGHT;
                                 break;
                             case SDL_SCANCODE_ESCAPE:  // Return to menu
                                 currentState = MENU;
                                 // Reset finish line for next play
-                                finishLineEnabled = true;
+                                sim.finishLineEnabled = true;
                                 break;
                             case SDL_SCANCODE_C:  // Return to level selection after completing level
                                 if (player.showingCongratulations) {
                                     // Only show the character unlock prompt for levels 1-3
                                     if (hasUnlockedNewChar && selectedLevel >= 1 && selectedLevel <= 3) {
-                                        savedScreenIndex = currentScreenIndex;
-                                        savedCameraOffsetX = cameraOffsetX;
                                         showingNewCharPrompt = true;
                                     } else {
                                         // Either no new character unlocked or it's level 4 or 5
@@ -375,7 +452,7 @@ int SDL_main(int argc, char* argv[]) {
                                         currentState = LEVEL_SELECTION;
                                         player.showingCongratulations = false;  // Reset the congratulations flag
                                         // Reset finish line for next play
-                                        finishLineEnabled = true;
+                                        sim.finishLineEnabled = true;
                                     }
                                 }
                                 break;
@@ -384,22 +461,12 @@ int SDL_main(int argc, char* argv[]) {
                                     currentState = MENU;
                                     player.showingCongratulations = false;  // Reset the congratulations flag
                                     // Reset finish line for next play
-                                    finishLineEnabled = true;
+                                    sim.finishLineEnabled = true;
                                 }
                                 break;
                         }
                     }
                 }
-                else if (event.type == SDL_KEYUP) {
-                    switch (event.key.keysym.scancode) {
-                        case SDL_SCANCODE_A:  // Release left hand
-                            player.release(true);
-                            break;
-                        case SDL_SCANCODE_D:  // Release right hand
-                            player.release(false);
-                            break;
-                    }
-                }
                 else if (event.type == SDL_MOUSEBUTTONDOWN && !player.showingCongratulations) {
                     int mouseX = event.button.x;
                     int mouseY = event.button.y;
@@ -409,7 +476,7 @@ int SDL_main(int argc, char* argv[]) {
                         mouseY >= backButtonRect.y && mouseY <= backButtonRect.y + backButtonRect.h) {
                         currentState = LEVEL_SELECTION;
                         // Reset finish line for next play
-                        finishLineEnabled = true;
+                        sim.finishLineEnabled = true;
                         continue;  // Skip the rest of the event handling
                     }
                 }
@@ -441,7 +508,7 @@ int SDL_main(int argc, char* argv[]) {
                         hasUnlockedNewChar = false;
                         currentState = CHARACTER_SELECTION;
                         player.showingCongratulations = false;
-                        finishLineEnabled = true;
+                        sim.finishLineEnabled = true;
                         // No need to restore camera position since leaving the level
                     }
                     // Check if No button was clicked
@@ -452,7 +519,7 @@ int SDL_main(int argc, char* argv[]) {
                         hasUnlockedNewChar = false;
                         currentState = LEVEL_SELECTION;
                         player.showingCongratulations = false;
-                        finishLineEnabled = true;
+                        sim.finishLineEnabled = true;
                         // No need to restore camera position since leaving the level
                     }
                 }
@@ -480,7 +547,7 @@ int SDL_main(int argc, char* argv[]) {
                         backgroundMusic.setSfxVolume(menu.getSfxVolume());
 
                         // Store volume settings in a file
-                        FILE* volumeFile = fopen("F:\\Game\\volume_settings.dat", "wb");
+                        FILE* volumeFile = fopen(AssetArchive::userPath("volume_settings.dat").c_str(), "wb");
                         if (volumeFile) {
                             int musicVol = menu.getMusicVolume();
                             int sfxVol = menu.getSfxVolume();
@@ -493,492 +560,180 @@ int SDL_main(int argc, char* argv[]) {
             }
         }
 
+        PROFILE_ZONE_STOP(eventsZone);
+
+        // Upload whatever the loader threads finished decoding, a few textures per frame
+        {
+            PROFILE_ZONE(ZONE_ASSET_UPLOAD);
+            ALLOC_SCOPE(ALLOC_LEVEL_LOAD);
+            HEAP_CHECK_ALLOW();
+            loader.pump(core.renderer, 4);
+        }
+        if (loader.done()) {
+            ALLOC_SCOPE(ALLOC_AUDIO);
+            collectLoadedSounds(loader, backgroundMusic);
+        }
+
+        // Measure the real frame time and run as many physics steps as it covers
+        Uint64 frameCounter = SDL_GetPerformanceCounter();
+        double frameTime = (frameCounter - previousCounter) / counterFrequency;
+        previousCounter = frameCounter;
+        if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
+
+        double interpolationAlpha = 1.0;
+        if (currentState == PLAYING) {
+            accumulator += frameTime;
+            while (accumulator >= STEP_SECONDS) {
+                ALLOC_SCOPE(ALLOC_PHYSICS);
+                previousPhysics.capture(core, player, sim.camera.x, sim.spikeWall);
+
+                // The new character prompt freezes the whole level
+                if (!showingNewCharPrompt) {
+                    InputFrame input = inputSource->next(sim);
+                    input.buttons |= tappedButtons;
+                    tappedButtons = 0;
+
+                    SimEvents events;
+                    sim.step(input, events);
+                    playSimulationSounds(events, backgroundMusic);
+
+                    // Steps after the finish only idle behind the congratulations screen
+                    HEAP_CHECK_ALLOW();     // the replay log grows with the run
+                    if (!player.showingCongratulations || events.finished) replay.record(input, sim);
+                    if (events.finished) saveReplays(replay, sim);
+                }
+                accumulator -= STEP_SECONDS;
+            }
+            interpolationAlpha = accumulator / STEP_SECONDS;
+        } else {
+            // Nothing to blend with when the level (re)starts
+            accumulator = 0.0;
+            previousPhysics.valid = false;
+        }
+
         // Clear screen
         SDL_SetRenderDrawColor(core.renderer, 245, 245, 220, 255);  // Beige color
         SDL_RenderClear(core.renderer);
 
         if (currentState == MENU) {
+            ALLOC_SCOPE(ALLOC_MENU);
             // Render menu
             menu.render();
         }
         else if (currentState == CHARACTER_SELECTION) {
+            ALLOC_SCOPE(ALLOC_MENU);
             // Use the new method from MenuPanel to render character selection
             menu.renderCharacterSelection(currentCharacterIndex, characterMenuPaths, characterUnlocked);
 
             // Render back button
-            if (backButtonTexture) {
-                SDL_RenderCopy(core.renderer, backButtonTexture, NULL, &backButtonRect);
+            if (backButtonSprite) {
+                renderSprite(core.renderer, backButtonSprite, &backButtonRect);
             }
         }
         else if (currentState == LEVEL_SELECTION) {
+            ALLOC_SCOPE(ALLOC_MENU);
             // Use the new method from MenuPanel to render level selection
             menu.renderLevelSelection(levelPaths, levelUnlocked);
 
             // Render back button
-            if (backButtonTexture) {
-                SDL_RenderCopy(core.renderer, backButtonTexture, NULL, &backButtonRect);
+            if (backButtonSprite) {
+                renderSprite(core.renderer, backButtonSprite, &backButtonRect);
             }
         }
-        else if (currentState == PLAYING) {
-            // Update camera offset based on character position (for Level 2, 3, and 4)
-            if ((selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4) && !showingNewCharPrompt) {
-                // Get current time for transition cooldown
-                Uint32 currentTime = SDL_GetTicks();
-
-                // Check if we need to transition to the next screen
-                if (player.x > SCREEN_TRANSITION_X &&
-                    currentScreenIndex < SCREEN_COUNT - 1 &&
-                    currentTime - lastTransitionTime >= TRANSITION_COOLDOWN) {
-
-                    // Calculate player's position relative to the transition point
-                    double relativePos = player.x - SCREEN_TRANSITION_X;
-
-                    // Track grab states before transition
-                    bool wasLeftGrabbing = player.leftHand.isGrabbingObject;
-                    bool wasRightGrabbing = player.rightHand.isGrabbingObject;
-
-                    // Remember hand positions relative to character
-                    double leftHandX = player.leftHand.parti.back().xCurrent - player.x;
-                    double leftHandY = player.leftHand.parti.back().yCurrent - player.y;
-                    double rightHandX = player.rightHand.parti.back().xCurrent - player.x;
-                    double rightHandY = player.rightHand.parti.back().yCurrent - player.y;
-
-                    // Move to the next screen
-                    currentScreenIndex++;
-
-                    // Ensure currentScreenIndex is within valid range
-                    if (currentScreenIndex >= SCREEN_COUNT) {
-                        currentScreenIndex = SCREEN_COUNT - 1;
-                    }
-
-                    // Update camera offset for new screen
-                    cameraOffsetX = currentScreenIndex * SCREEN_WIDTH;
-
-                    // Position player at the beginning of the new screen
-                    // But maintain the same relative position to the platform
-                    double oldX = player.x;
-                    player.x = 150 + relativePos; // nhay sang man hinh tiep
-
-                    // Keep vertical position and velocity
-// ng nhay thi tay cung nhay
-                    // Update hand positions to maintain their relative positions
-                    for (size_t i = 0; i < player.leftHand.parti.size(); i++) {
-                        // Adjust for new player position
-                        double dx = player.x - oldX;
-
-                        player.leftHand.parti[i].xCurrent += dx;
-                        player.leftHand.parti[i].xPrevious += dx;
-                    }
-
-                    for (size_t i = 0; i < player.rightHand.parti.size(); i++) {
-                        // Adjust for new player position
-                        double dx = player.x - oldX;
-
-                        player.rightHand.parti[i].xCurrent += dx;
-                        player.rightHand.parti[i].xPrevious += dx;
-                    }
-
-                    // If hands were grabbing, ensure they remain grabbing at the right positions
-                    if (wasLeftGrabbing) {
-                        // Update the left hand's grab position on the duplicated platform
-                        double newGrabX = player.x + leftHandX;
-                        double newGrabY = player.y + leftHandY;
-                        player.leftHand.grab(newGrabX, newGrabY);
-                    }
-
-                    if (wasRightGrabbing) {
-                        // Update the right hand's grab position on the duplicated platform
-                        double newGrabX = player.x + rightHandX;
-                        double newGrabY = player.y + rightHandY;
-                        player.rightHand.grab(newGrabX, newGrabY);
-                    }
-
-                    // Record time of this transition
-                    lastTransitionTime = currentTime;
-
-                    // If this is Level 3, also move the spike wall to the next screen
-                    if (selectedLevel == 3 && spikeWall) {
-                        // Reset spike wall to the left of the new screen
-                        spikeWall->rect.x = -200 + (currentScreenIndex * SCREEN_WIDTH);
-                        // Ensure we maintain the slower velocity
-                        spikeWall->velocityX = 1.0;
-                    }
-                }
-
-                // Check if player fell off the screen
-                if (player.y > SCREEN_HEIGHT + 100 ||
-                    player.x < -100 ||
-                    player.x > SCREEN_WIDTH + 100) {
-                    // Reset to beginning of first screen
-                    currentScreenIndex = 0;
-                    cameraOffsetX = 0;
-                    player.resetPosition();
-
-                    // If level 3, reset the spike wall to the first screen
-                    if (selectedLevel == 3 && spikeWall) {
-                        spikeWall->reset();  // This resets to original start position (-200, 0)
-                        // Make sure velocity stays at the slower speed
-                        spikeWall->velocityX = 1.0;
-                    }
-
-                    // Reset transition timer
-                    lastTransitionTime = currentTime;
-                }
-            } else if (showingNewCharPrompt && (selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4)) {
-                // Restore saved camera position for rendering while showing the prompt
-                currentScreenIndex = savedScreenIndex;
-                cameraOffsetX = savedCameraOffsetX;
+        else if (currentState == LOADING) {
+            ALLOC_SCOPE(ALLOC_LEVEL_LOAD);
+            if (loader.done()) {
+                PROFILE_ZONE(ZONE_LEVEL_LOAD);
+                HEAP_CHECK_ALLOW();
+
+                // All textures are in the cache now, building the level no longer touches the disk
+                levelBackgroundTexture = sim.level.background.empty() ? TextureHandle()
+                                       : TextureCache::load(core.renderer, sim.level.background.c_str());
+
+                // Ensure character texture is set to the current selection
+                player.setTexture(core.renderer, characterGamePaths[currentCharacterIndex]);
+
+                // Rules, spike wall, player and camera back to the start, first chunks spawned
+                sim.startLevel();
+                inputSource->restart();
+                replay.begin(selectedLevel);
+                showingNewCharPrompt = false;
+                hasUnlockedNewChar = false;
+
+                // Reset applause sound flag so it can play again
+                backgroundMusic.resetApplause();
+
+                currentState = PLAYING;
+
+#ifdef ALLOC_TRACKING_ENABLED
+                // Live bytes per subsystem at every level start, whatever keeps growing from one
+                // start to the next is leaking
+                SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                               "Level %d starts with %d textures alive", selectedLevel,
+                               static_cast<int>(TextureCache::liveCount()));
+                AllocTracker::logSession("level start");
+#endif
             } else {
-                cameraOffsetX = 0;  // No sliding for other levels
-                currentScreenIndex = 0;  // Reset screen index for other levels
-            }
-
-            // Handle moving platform in Level 4 - only if not showing new character prompt
-            if (selectedLevel == 4 && !showingNewCharPrompt) {
-                // First, save current positions of platforms before updating
-                std::vector<int> oldPositions;
-                for (const auto& platform : core.platforms) {
-                    if (platform.isMoving) {
-                        oldPositions.push_back(platform.rect.x);
-                    }
-                }
-
-                // Update all moving platforms
-                int platformIndex = 0;
-                for (auto& platform : core.platforms) {
-                    if (platform.isMoving) {
-                        // Store the old position before updating
-                        int oldX = oldPositions[platformIndex++];
-
-                        // Update the platform position
-                        platform.update(1.0f);
-
-                        // Calculate the actual change in platform position
-                        int deltaX = platform.rect.x - oldX;
-
-                        // Check if platform is in current screen's range
-                        int worldX = platform.rect.x;
-                        int screenStartX = currentScreenIndex * SCREEN_WIDTH;
-                        int screenEndX = (currentScreenIndex + 1) * SCREEN_WIDTH;
-
-                        // Only process platforms that are either:
-                        // 1. Visible in the current screen, or
-                        // 2. Being grabbed by the player
-                        bool isInCurrentScreen = (worldX >= screenStartX - platform.rect.w &&
-                                                  worldX <= screenEndX);
-
-                        // If platform is on current screen or being grabbed, check for hand interaction
-                        if (isInCurrentScreen ||
-                            (player.leftHand.isGrabbingObject && player.leftHand.grabbedPlatformIndex == (&platform - &core.platforms[0])) ||
-                            (player.rightHand.isGrabbingObject && player.rightHand.grabbedPlatformIndex == (&platform - &core.platforms[0]))) {
-
-                            // Left hand check
-                            if (player.leftHand.isGrabbingObject) {
-                                double handX = player.leftHand.parti.back().xCurrent + cameraOffsetX; // Convert to world coordinates
-                                double handY = player.leftHand.parti.back().yCurrent;
-
-                                if (handX >= oldX && handX <= oldX + platform.rect.w &&
-                                    handY >= platform.rect.y && handY <= platform.rect.y + platform.rect.h) {
-                                    // Hand is on this platform - move all particles of the hand
-                                    for (auto& particle : player.leftHand.parti) {
-                                        particle.xCurrent += deltaX;
-                                        particle.xPrevious += deltaX;
-                                    }
-                                    // Move character too
-                                    player.x += deltaX;
-                                }
-                            }
-
-                            // Right hand check
-                            if (player.rightHand.isGrabbingObject) {
-                                double handX = player.rightHand.parti.back().xCurrent + cameraOffsetX; // Convert to world coordinates
-                                double handY = player.rightHand.parti.back().yCurrent;
-
-                                if (handX >= oldX && handX <= oldX + platform.rect.w &&
-                                    handY >= platform.rect.y && handY <= platform.rect.y + platform.rect.h) {
-                                    // Hand is on this platform - move all particles of the hand
-                                    for (auto& particle : player.rightHand.parti) {
-                                        particle.xCurrent += deltaX;
-                                        particle.xPrevious += deltaX;
-                                    }
-                                    // Move character too if not already moved by left hand
-                                    if (!player.leftHand.isGrabbingObject) {
-                                        player.x += deltaX;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // Provide current platforms to character for moving platform handling
-                player.setPlatformsReference(core.platforms);
-            }
-
-            // Update player physics - only if not showing congratulations or new character prompt
-            if (!player.showingCongratulations && !showingNewCharPrompt) {
-                player.update();
-            }
-
-            // Handle collisions with appropriate method based on level - only if not showing congratulations or new character prompt
-            if (!player.showingCongratulations && !showingNewCharPrompt) {
-                if (selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4) {
-                    // Adjust platforms for screen positioning in Level 2/3/4
-                    std::vector<Platform> adjustedPlatforms = core.platforms;
-                    for (auto& platform : adjustedPlatforms) {
-                        // If this is a platform that should appear on multiple screens:
-                        // For last platform of screen 0 (at x ~= SCREEN_WIDTH - 200)
-                        if ((selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4) && currentScreenIndex == 1 && platform.rect.x == SCREEN_WIDTH - 200) {
-                            // Create a copy positioned at the start of screen 1
-                            platform.rect.x = 150 - static_cast<int>(cameraOffsetX);
-                        }
-                        // For last platform of screen 1
-                        else if ((selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4) && currentScreenIndex == 2 && platform.rect.x == SCREEN_WIDTH * 2 - 200) {
-                            // Create a copy positioned at the start of screen 2
-                            platform.rect.x = SCREEN_WIDTH * 2 + 150 - static_cast<int>(cameraOffsetX);
-                        }
-                        else {
-                            // Regular platform adjustment
-                            platform.rect.x -= static_cast<int>(cameraOffsetX);
-                        }
-                    }
-
-                    // Special logic for Level 3 - moving spike wall
-                    if (selectedLevel == 3 && !showingNewCharPrompt) {
-                        // Activate the spike wall if not already active
-                        if (!isSpikewallActive) {
-                            spikeWall->reset();
-                            isSpikewallActive = true;
-                        }
-
-                        // Update spike wall position
-                        spikeWall->update();
-
-                        // Check if the spike wall has gone off the right side of the current screen
-                        if (spikeWall->rect.x > SCREEN_WIDTH * (currentScreenIndex + 1)) {
-                            // Reset to the left side of the current screen
-                            spikeWall->rect.x = -200 + (currentScreenIndex * SCREEN_WIDTH);
-                        }
-
-                        // Check collision with spike wall
-                        SDL_Rect adjustedSpikeRect = spikeWall->rect;
-                        adjustedSpikeRect.x -= static_cast<int>(cameraOffsetX);
-
-                        if (player.x + player.radius > adjustedSpikeRect.x &&
-                            player.x - player.radius < adjustedSpikeRect.x + adjustedSpikeRect.w &&
-                            player.y + player.radius > adjustedSpikeRect.y &&
-                            player.y - player.radius < adjustedSpikeRect.y + adjustedSpikeRect.h) {
-                            // Collision with spike wall - always reset to beginning of first screen
-                            currentScreenIndex = 0;  // Reset to first screen
-                            cameraOffsetX = 0;      // Reset camera offset
-                            player.resetPosition(); // Reset player position
-                            spikeWall->reset();     // Reset spike wall to first screen
-                            // Make sure velocity stays at the slower speed
-                            spikeWall->velocityX = 1.0;
-                        }
-                    } else {
-                        // Deactivate spike wall for other levels
-                        isSpikewallActive = false;
-                    }
-
-                    // Special finish line check for Level 2, 3, 4 & 5 - only on the last screen
-                    if (finishLineEnabled && (selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4 || selectedLevel == 5) && currentScreenIndex == SCREEN_COUNT - 1) {
-                        // Use the appropriate finish line rectangle for this level
-                        SDL_Rect finishRect;
-                        if (selectedLevel == 2) {
-                            finishRect = level2FinishRect;
-                        } else if (selectedLevel == 3) {
-                            finishRect = level3FinishRect;
-                        } else if (selectedLevel == 4) {
-                            finishRect = level4FinishRect;
-                        } else { // Level 5
-                            finishRect = level5FinishRect;
-                        }
-
-                        // Adjust for camera offset
-                        SDL_Rect adjustedFinishRect = finishRect;
-                        adjustedFinishRect.x -= static_cast<int>(cameraOffsetX);
-
-                        // Check if player is touching the finish line
-                        if (player.x + player.radius > adjustedFinishRect.x &&
-                            player.x - player.radius < adjustedFinishRect.x + adjustedFinishRect.w &&
-                            player.y + player.radius > adjustedFinishRect.y &&
-                            player.y - player.radius < adjustedFinishRect.y + adjustedFinishRect.h) {
-
-                            player.hasReachedFinish = true;
-                            player.showingCongratulations = true;
-                            player.vx = 0;
-                            player.vy = 0;
-
-                            // Disable finish line detection to prevent re-triggering
-                            finishLineEnabled = false;
-
-                            // Play applause sound
-                            backgroundMusic.playApplauseSound();
-                        }
-                    }
-
-                    // Handle normal collisions with screen-adjusted platforms
-                    player.handlecollision(adjustedPlatforms);
-                } else if (selectedLevel == 1) {
-                    // Special finish line check for Level 1 only
-                    if (finishLineEnabled) {
-                        SDL_Rect finishRect = level1FinishRect; // Use the global finish line rect for Level 1
-
-                        // Check if player is touching the finish line
-                        if (player.x + player.radius > finishRect.x &&
-                            player.x - player.radius < finishRect.x + finishRect.w &&
-                            player.y + player.radius > finishRect.y &&
-                            player.y - player.radius < finishRect.y + finishRect.h) {
-
-                            player.hasReachedFinish = true;
-                            player.showingCongratulations = true;
-                            player.vx = 0;
-                            player.vy = 0;
-
-                            // Disable finish line detection to prevent re-triggering
-                            finishLineEnabled = false;
-
-                            // Play applause sound
-                            backgroundMusic.playApplauseSound();
-                        }
-                    }
-
-                    // Standard collision detection for Level 1
-                    player.handlecollision(core.platforms);
-                } else {
-                    // For any other levels without special handling
-                    // Standard collision detection
-                    player.handlecollision(core.platforms);
-                }
+                renderLoadingScreen(core.renderer, loader.progress());
             }
+        }
+        else if (currentState == PLAYING) {
+            ALLOC_SCOPE(ALLOC_RENDER);
+            // Draw the state interpolated between the last two physics steps, restored after drawing
+            currentPhysics.capture(core, player, sim.camera.x, sim.spikeWall);
+            blendedPhysics.blend(previousPhysics, currentPhysics, interpolationAlpha);
+            blendedPhysics.apply(core, player, sim.camera.x, sim.spikeWall);
 
             // Clear screen
             SDL_SetRenderDrawColor(core.renderer, 245, 245, 220, 255);  // Beige color
             SDL_RenderClear(core.renderer);
 
-            // Render background with camera offset
-            SDL_Texture* backgroundTexture = nullptr;
-            const char* backgroundPath = "F:\\Game\\graphic\\level1_background.png";
-
-            if (selectedLevel == 2) {
-                backgroundPath = "F:\\Game\\graphic\\level2_background.png";
-            }
-            // All other levels use level1 background
-
-            backgroundTexture = IMG_LoadTexture(core.renderer, backgroundPath);
-
-            if (backgroundTexture) {
-                SDL_Rect bgRect = {
-                    static_cast<int>(-cameraOffsetX),
-                    0,
-                    SCREEN_WIDTH * ((selectedLevel == 2 || selectedLevel == 3 || selectedLevel == 4) ? 3 : 1),  // Extra wide background for multi-screen levels
-                    SCREEN_HEIGHT
-                };
-                SDL_RenderCopy(core.renderer, backgroundTexture, NULL, &bgRect);
-                SDL_DestroyTexture(backgroundTexture);
+            // Render background, stretched over the whole level: only the part under the view
+            PROFILE_ZONE_NAMED(backgroundZone, ZONE_BACKGROUND_DRAW);
+            SDL_Rect bgSource, bgRect;
+            if (levelBackgroundTexture &&
+                Visibility::backgroundRects(levelBackgroundTexture.get(), sim.camera, bgSource, bgRect)) {
+                SDL_RenderCopy(core.renderer, levelBackgroundTexture.get(), &bgSource, &bgRect);
             }
-
-            // Render platforms with camera offset
-            for (const auto& platform : core.platforms) {
-                SDL_Rect platformRect = platform.rect;
-                platformRect.x -= static_cast<int>(cameraOffsetX);
-                SDL_RenderCopy(core.renderer, platform.texture, NULL, &platformRect);
+            PROFILE_ZONE_STOP(backgroundZone);
+
+            // Render the platforms on screen with camera offset
+            PROFILE_ZONE_NAMED(platformZone, ZONE_PLATFORM_DRAW);
+            FrameVector<int> visiblePlatforms((FrameAllocator<int>(frameArena)));
+            visiblePlatforms.reserve(core.platforms.size());
+            Visibility::visiblePlatforms(core.platforms, core.platformGrid, sim.camera, visiblePlatforms);
+            cullStats.count(static_cast<int>(visiblePlatforms.size()), sim.streamer.livePlatformCount());
+            for (int index : visiblePlatforms) {
+                SDL_Rect platformRect = core.platforms[index].rect;
+                platformRect.x -= static_cast<int>(sim.camera.x);
+                renderSprite(core.renderer, core.platforms[index].sprite, &platformRect);
             }
 
-            // Special handling for Level 5 interactive platform
-            if (selectedLevel == 5 && !showingNewCharPrompt) {
-                // Count how many buttons are activated
-                int activatedButtonCount = 0;
-                int buttonIndex1 = -1;
-                int buttonIndex2 = -1;
-                int pollIndex = -1;
-
-                // Find the interactive platforms and the poll platform
-                for (int i = 0; i < core.platforms.size(); i++) {
-                    const auto& platform = core.platforms[i];
-                    if (platform.isInteractive) {
-                        if (buttonIndex1 == -1) {
-                            buttonIndex1 = i;
-                        } else {
-                            buttonIndex2 = i;
-                        }
-
-                        if (platform.activated) {
-                            activatedButtonCount++;
-                        }
-                    }
-
-                    // Find the poll platform (assuming it's the one closest to SCREEN_WIDTH - 350)
-                    if (abs(platform.rect.x - (SCREEN_WIDTH - 350)) < 10 && platform.rect.h == SCREEN_HEIGHT) {
-                        pollIndex = i;
-                    }
+            // Render the spike wall of levels that have one
+            if (sim.spikeWall && !showingNewCharPrompt) {
+                bool wallVisible = Visibility::isOnScreen(sim.spikeWall->rect, sim.camera);
+                cullStats.count(wallVisible ? 1 : 0, 1);
+                if (wallVisible) {
+                    SDL_Rect adjustedSpikeRect = sim.spikeWall->rect;
+                    adjustedSpikeRect.x -= static_cast<int>(sim.camera.x);
+                    renderSprite(core.renderer, sim.spikeWall->sprite, &adjustedSpikeRect);
                 }
+            }
 
-                // Check if both buttons have been activated
-                if (activatedButtonCount == 2 && pollIndex != -1) {
-                    // Move the poll off-screen to make it "disappear"
-                    core.platforms[pollIndex].rect.x = -1000;
-                }
+            PROFILE_ZONE_STOP(platformZone);
 
-                // Handle activation of individual buttons
-                for (auto& platform : core.platforms) {
-                    if (platform.isInteractive && !platform.activated) {
-                        // Check if player is touching the interactive platform
-                        SDL_Rect platformRect = platform.rect;
-
-                        // Check for any overlap with player
-                        if (player.x + player.radius > platformRect.x &&
-                            player.x - player.radius < platformRect.x + platformRect.w &&
-                            player.y + player.radius > platformRect.y &&
-                            player.y - player.radius < platformRect.y + platformRect.h) {
-
-                            // Activate the platform (swap textures) immediately
-                            platform.activate();
-                            // Play a sound for feedback
-                            backgroundMusic.playApplauseSound();
-                        }
-                    }
-                }
-
-                // Add finish line detection specific for Level 5
-                if (finishLineEnabled) {
-                    // Only check finish line if the poll is removed (both buttons activated)
-                    if (activatedButtonCount == 2) {
-                        SDL_Rect finishRect = level5FinishRect;
-
-                        // Check if player is touching the finish line
-                        if (player.x + player.radius > finishRect.x &&
-                            player.x - player.radius < finishRect.x + finishRect.w &&
-                            player.y + player.radius > finishRect.y &&
-                            player.y - player.radius < finishRect.y + finishRect.h) {
-
-                            // Player reached the finish line
-                            player.hasReachedFinish = true;
-                            player.showingCongratulations = true;
-                            player.vx = 0;
-                            player.vy = 0;
-
-                            // Disable finish line detection to prevent re-triggering
-                            finishLineEnabled = false;
-
-                            // Force reset and play applause sound regardless of previous state
-                            backgroundMusic.resetApplause();
-                            backgroundMusic.playApplauseSound();
-                        }
-                    }
-                }
+            if (++cullStats.frames == CULL_REPORT_FRAMES) {
+                SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_DEBUG,
+                               "Culling: %d drawn, %d culled over %d frames", cullStats.drawn,
+                               cullStats.culled, cullStats.frames);
+                cullStats.reset();
             }
 
-            // Render the spike wall for Level 3
-            if (selectedLevel == 3 && isSpikewallActive && spikeWall && !showingNewCharPrompt) {
-                SDL_Rect adjustedSpikeRect = spikeWall->rect;
-                adjustedSpikeRect.x -= static_cast<int>(cameraOffsetX);
-                SDL_RenderCopy(core.renderer, spikeWall->texture, NULL, &adjustedSpikeRect);
-            }
+            // Render player, the camera offset is applied only here
+            player.render(core.renderer, sim.camera.x);
 
-            // Render player
-            player.render(core.renderer);
+            // Back to the exact simulation state
+            currentPhysics.apply(core, player, sim.camera.x, sim.spikeWall);
 
             // Play falling sound when character is falling freely - but not during prompt
             if (!showingNewCharPrompt) {
@@ -1026,15 +781,16 @@ int SDL_main(int argc, char* argv[]) {
             }
 
             // Render back button (only if not in congratulations screen and not showing prompt)
-            if (backButtonTexture && !player.showingCongratulations && !showingNewCharPrompt) {
-                SDL_RenderCopy(core.renderer, backButtonTexture, NULL, &backButtonRect);
+            if (backButtonSprite && !player.showingCongratulations && !showingNewCharPrompt) {
+                renderSprite(core.renderer, backButtonSprite, &backButtonRect);
             }
         }
         else if (currentState == OPTIONS) {
+            ALLOC_SCOPE(ALLOC_MENU);
             // Initialize slider values with current volumes
             static bool volumeInitialized = false;
             if (!volumeInitialized) {
-                FILE* volumeFile = fopen("F:\\Game\\volume_settings.dat", "rb");
+                FILE* volumeFile = fopen(AssetArchive::userPath("volume_settings.dat").c_str(), "rb");
                 if (volumeFile) {
                     int musicVol, sfxVol;
                     if (fread(&musicVol, sizeof(int), 1, volumeFile) == 1 &&
@@ -1054,57 +810,70 @@ int SDL_main(int argc, char* argv[]) {
 
             menu.renderOptions();
 
-            if (backButtonTexture) {
-                SDL_RenderCopy(core.renderer, backButtonTexture, NULL, &backButtonRect);
+            if (backButtonSprite) {
+                renderSprite(core.renderer, backButtonSprite, &backButtonRect);
             }
         }
         else if (currentState == HOWTOPLAY) {
+            ALLOC_SCOPE(ALLOC_MENU);
             // Render how to play screen with guide image
             core.renderHowToPlay();
 
             // Render back button
-            if (backButtonTexture) {
-                SDL_RenderCopy(core.renderer, backButtonTexture, NULL, &backButtonRect);
+            if (backButtonSprite) {
+                renderSprite(core.renderer, backButtonSprite, &backButtonRect);
             }
         }
 
         // Render the new character prompt at the end, on top of everything else
-        if (showingNewCharPrompt && checkNewCharTexture) {
+        if (showingNewCharPrompt && checkNewCharSprite) {
             // SDL_Log("Rendering new character prompt at the end");
-            SDL_RenderCopy(core.renderer, checkNewCharTexture, NULL, &checkNewCharRect);
+            renderSprite(core.renderer, checkNewCharSprite, &checkNewCharRect);
         }
 
-        // Present the frame
-        SDL_RenderPresent(core.renderer);
+#ifdef PROFILER_ENABLED
+        // Frame graph on top of everything, F3
+        Profiler::renderOverlay(core.renderer);
+#endif
 
-        // Small delay to control frame rate
-        SDL_Delay(16);  // Approximately 60 FPS
+        // Present the frame
+        {
+            PROFILE_ZONE(ZONE_PRESENT);
+            ALLOC_SCOPE(ALLOC_RENDER);
+            SDL_RenderPresent(core.renderer);
+        }
+        frameArena.reset();
+        HEAP_CHECK_END_FRAME(currentState == PLAYING);
+        ALLOC_END_FRAME();
+
+        // Without vsync, sleep off whatever is left of this physics step instead of spinning
+        if (!hasVsync) {
+            double elapsed = (SDL_GetPerformanceCounter() - frameCounter) / counterFrequency;
+            if (elapsed < STEP_SECONDS) {
+                SDL_Delay(static_cast<Uint32>((STEP_SECONDS - elapsed) * 1000.0));
+            }
+        }
     }
 
+
+    // The renderer frees all remaining textures, handles released after this point must not touch them
+    TextureCache::shutdown();
+
+#ifdef ALLOC_TRACKING_ENABLED
+    AllocTracker::logSession("exit");
+#endif
+
+#ifdef PROFILER_ENABLED
+    ChromeTrace::close();
+#endif
+
     // Cleanup
     SDL_DestroyRenderer(core.renderer);
     SDL_DestroyWindow(core.window);
+    core.renderer = nullptr;
+    core.window = nullptr;
     Mix_CloseAudio();
     SDL_Quit();
 
-    // Cleanup spike wall
-    if (spikeWall) {
-        SDL_DestroyTexture(spikeWall->texture);
-        delete spikeWall;
-        spikeWall = nullptr;
-    }
-
-    // Cleanup back button texture
-    if (backButtonTexture) {
-        SDL_DestroyTexture(backButtonTexture);
-        backButtonTexture = nullptr;
-    }
-
-    // Cleanup check new character texture
-    if (checkNewCharTexture) {
-        SDL_DestroyTexture(checkNewCharTexture);
-        checkNewCharTexture = nullptr;
-    }
-
     return 0;
 }
@@ -6,9 +6,10 @@
 #include <string>
 #include <vector>
 #include "defs.h"
+#include "texture_atlas.h"
 
 struct MenuItem {
-    SDL_Texture* texture;
+    Sprite sprite;
     SDL_Rect rect;
     bool isSelected;
     void (*action)();  // Function pointer for the action to take when selected
@@ -161,76 +162,48 @@ private:
     SDL_Renderer* renderer;
     std::vector<MenuItem> items;
     int selectedIndex;
-    SDL_Texture* backgroundTexture;  // Background texture for right side
+    Sprite backgroundSprite;  // Background texture for right side
     int x, y, width, height;  // Add position and size members
 
     // Character selection variables
-    SDL_Texture* lockTexture;
+    Sprite lockSprite;
+    Sprite charSelectSprite;
+    Sprite leftArrowSprite;
+    Sprite rightArrowSprite;
+    Sprite characterSprites[4];  // Menu images of the selectable characters
     SDL_Rect leftArrowRect, rightArrowRect, characterRect;
 
     // Level selection variables
-    SDL_Texture* levelLockTexture;
+    Sprite levelLockSprite;
+    Sprite levelSelectSprite;
+    Sprite levelSprites[5];
     SDL_Rect levelRects[5];  // Array to store level button rectangles
 
     // Volume control sliders
     Slider musicVolumeSlider;
     Slider sfxVolumeSlider;
-    SDL_Texture* optionsTexture;  // For the options menu title
-    SDL_Texture* volumeTexture;   // Volume image
-    SDL_Texture* sfxTexture;      // SFX image
+    Sprite optionsSprite;  // For the options menu title
+    Sprite volumeSprite;   // Volume image
+    Sprite sfxSprite;      // SFX image
 
 public:
     MenuPanel(SDL_Renderer* renderer, int x, int y, int width, int height)
-        : renderer(renderer), selectedIndex(0), backgroundTexture(nullptr),
-          x(x), y(y), width(width), height(height), lockTexture(nullptr),
-          levelLockTexture(nullptr), optionsTexture(nullptr), volumeTexture(nullptr), sfxTexture(nullptr)
+        : renderer(renderer), selectedIndex(0),
+          x(x), y(y), width(width), height(height)
     {
         // Load background texture
-        backgroundTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\swingngrip.png");
+        backgroundSprite = TextureAtlas::sprite(renderer, "graphic/swingngrip.png");
 
         // Initialize volume sliders with consistent positions
         musicVolumeSlider.setPosition(SCREEN_WIDTH/2 - 150, SCREEN_HEIGHT/2 - 40, 300, 20);
         sfxVolumeSlider.setPosition(SCREEN_WIDTH/2 - 150, SCREEN_HEIGHT/2 + 40, 300, 20);
 
         // Load options title texture
-        optionsTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\optionsbut.png");
+        optionsSprite = TextureAtlas::sprite(renderer, "graphic/optionsbut.png");
 
         // Load volume and sfx textures
-        volumeTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\volume.png");
-        sfxTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\sfx.png");
-    }
-
-    ~MenuPanel() {
-        if (backgroundTexture) {
-            SDL_DestroyTexture(backgroundTexture);
-            backgroundTexture = nullptr;
-        }
-        if (lockTexture) {
-            SDL_DestroyTexture(lockTexture);
-            lockTexture = nullptr;
-        }
-        if (levelLockTexture) {
-            SDL_DestroyTexture(levelLockTexture);
-            levelLockTexture = nullptr;
-        }
-        if (optionsTexture) {
-            SDL_DestroyTexture(optionsTexture);
-            optionsTexture = nullptr;
-        }
-        if (volumeTexture) {
-            SDL_DestroyTexture(volumeTexture);
-            volumeTexture = nullptr;
-        }
-        if (sfxTexture) {
-            SDL_DestroyTexture(sfxTexture);
-            sfxTexture = nullptr;
-        }
-        for (auto& item : items) {
-            if (item.texture) {
-                SDL_DestroyTexture(item.texture);
-                item.texture = nullptr;
-            }
-        }
+        volumeSprite = TextureAtlas::sprite(renderer, "graphic/volume.png");
+        sfxSprite = TextureAtlas::sprite(renderer, "graphic/sfx.png");
     }
 
     // Volume slider getters and setters
@@ -264,9 +237,9 @@ public:
         SDL_RenderClear(renderer);
 
         // Draw title if texture is loaded
-        if (optionsTexture) {
-            int texWidth, texHeight;
-            SDL_QueryTexture(optionsTexture, NULL, NULL, &texWidth, &texHeight);
+        if (optionsSprite) {
+            int texWidth = optionsSprite.src.w;
+            int texHeight = optionsSprite.src.h;
 
             // Calculate scaled dimensions to maintain aspect ratio
             int targetHeight = 120;
@@ -279,7 +252,7 @@ public:
                 targetHeight
             };
 
-            SDL_RenderCopy(renderer, optionsTexture, NULL, &titleRect);
+            renderSprite(renderer, optionsSprite, &titleRect);
         }
 
         // Update slider positions
@@ -291,9 +264,9 @@ public:
         sfxVolumeSlider.render(renderer);
 
         // Render the volume icon
-        if (volumeTexture) {
-            int texWidth, texHeight;
-            SDL_QueryTexture(volumeTexture, NULL, NULL, &texWidth, &texHeight);
+        if (volumeSprite) {
+            int texWidth = volumeSprite.src.w;
+            int texHeight = volumeSprite.src.h;
 
             int iconHeight = 50;
             int iconWidth = (int)((float)texWidth * iconHeight / texHeight);
@@ -305,13 +278,13 @@ public:
                 iconHeight
             };
 
-            SDL_RenderCopy(renderer, volumeTexture, NULL, &iconRect);
+            renderSprite(renderer, volumeSprite, &iconRect);
         }
 
         // Render the sfx icon
-        if (sfxTexture) {
-            int texWidth, texHeight;
-            SDL_QueryTexture(sfxTexture, NULL, NULL, &texWidth, &texHeight);
+        if (sfxSprite) {
+            int texWidth = sfxSprite.src.w;
+            int texHeight = sfxSprite.src.h;
 
             int iconHeight = 50;
             int iconWidth = (int)((float)texWidth * iconHeight / texHeight);
@@ -323,23 +296,23 @@ public:
                 iconHeight
             };
 
-            SDL_RenderCopy(renderer, sfxTexture, NULL, &iconRect);
+            renderSprite(renderer, sfxSprite, &iconRect);
         }
     }
 
     void addItem(const char* imagePath, void (*action)()) {
         MenuItem item;
-        item.texture = IMG_LoadTexture(renderer, imagePath);
-        if (!item.texture) {
+        item.sprite = TextureAtlas::sprite(renderer, imagePath);
+        if (!item.sprite) {
             return;
         }
 
         item.isSelected = false;
         item.action = action;
 
-        // Get texture dimensions
-        int texWidth, texHeight;
-        SDL_QueryTexture(item.texture, NULL, NULL, &texWidth, &texHeight);
+        // Get sprite dimensions
+        int texWidth = item.sprite.src.w;
+        int texHeight = item.sprite.src.h;
 
         // Calculate item position with larger size
         int itemHeight = 150;
@@ -396,10 +369,10 @@ public:
 // ve cai hinh nen con mau do do
     void render() {
         // Draw background on right side
-        if (backgroundTexture) {
-            // Get original texture dimensions
-            int texWidth, texHeight;
-            SDL_QueryTexture(backgroundTexture, NULL, NULL, &texWidth, &texHeight);
+        if (backgroundSprite) {
+            // Get original image dimensions
+            int texWidth = backgroundSprite.src.w;
+            int texHeight = backgroundSprite.src.h;
 
             // Calculate destination rectangle for right side
             SDL_Rect destRect = {
@@ -424,15 +397,13 @@ public:
             }
 
             // Use the full source image
-            SDL_Rect srcRect = {0, 0, texWidth, texHeight};
-
-            SDL_RenderCopy(renderer, backgroundTexture, &srcRect, &destRect);
+            renderSprite(renderer, backgroundSprite, &destRect);
         }
 
         // Draw menu items (buttons) on left side
         for (const auto& item : items) {
             // Draw button texture
-            SDL_RenderCopy(renderer, item.texture, NULL, &item.rect);
+            renderSprite(renderer, item.sprite, &item.rect);
         }
     }
 
@@ -443,15 +414,17 @@ public:
     // New method for rendering character selection
     void renderCharacterSelection(int currentCharacterIndex, const char* characterPaths[], bool characterUnlocked[]) {
         // Load lock texture if not already loaded
-        if (!lockTexture) {
-            lockTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\lock-removebg-preview.png");
+        if (!lockSprite) {
+            lockSprite = TextureAtlas::sprite(renderer, "graphic/lock-removebg-preview.png");
         }
 
         // Render character selection screen
-        SDL_Texture* charSelectTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\chooseyourchar-Photoroom.png");
-        if (charSelectTexture) {
-            int texWidth, texHeight;
-            SDL_QueryTexture(charSelectTexture, NULL, NULL, &texWidth, &texHeight);
+        if (!charSelectSprite) {
+            charSelectSprite = TextureAtlas::sprite(renderer, "graphic/chooseyourchar-Photoroom.png");
+        }
+        if (charSelectSprite) {
+            int texWidth = charSelectSprite.src.w;
+            int texHeight = charSelectSprite.src.h;
 
             // Scale up the dimensions
             int scaledWidth = texWidth * 1.5;  // 150% of original width
@@ -465,15 +438,17 @@ public:
                 scaledHeight
             };
 
-            SDL_RenderCopy(renderer, charSelectTexture, NULL, &destRect);
-            SDL_DestroyTexture(charSelectTexture);
+            renderSprite(renderer, charSelectSprite, &destRect);
         }
 
         // Render current character in the middle of the screen
-        SDL_Texture* characterTexture = IMG_LoadTexture(renderer, characterPaths[currentCharacterIndex]);
-        if (characterTexture) {
-            int texWidth, texHeight;
-            SDL_QueryTexture(characterTexture, NULL, NULL, &texWidth, &texHeight);
+        Sprite& characterSprite = characterSprites[currentCharacterIndex];
+        if (!characterSprite) {
+            characterSprite = TextureAtlas::sprite(renderer, characterPaths[currentCharacterIndex]);
+        }
+        if (characterSprite) {
+            int texWidth = characterSprite.src.w;
+            int texHeight = characterSprite.src.h;
 
             // Scale down the dimensions
             int scaledWidth = texWidth * 0.7;  // 70% of original width
@@ -487,11 +462,10 @@ public:
                 scaledHeight
             };
 
-            SDL_RenderCopy(renderer, characterTexture, NULL, &characterRect);
-            SDL_DestroyTexture(characterTexture);
+            renderSprite(renderer, characterSprite, &characterRect);
 
             // Render lock if character is locked
-            if (!characterUnlocked[currentCharacterIndex] && lockTexture) {
+            if (!characterUnlocked[currentCharacterIndex] && lockSprite) {
                 int lockWidth = scaledWidth * 0.5;  // Lock size relative to character
                 int lockHeight = lockWidth;  // Keep aspect ratio
                 SDL_Rect lockRect = {
@@ -500,15 +474,17 @@ public:
                     lockWidth,
                     lockHeight
                 };
-                SDL_RenderCopy(renderer, lockTexture, NULL, &lockRect);
+                renderSprite(renderer, lockSprite, &lockRect);
             }
         }
 
         // Render left arrow
-        SDL_Texture* leftArrowTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\chontrai-Photoroom.png");
-        if (leftArrowTexture) {
-            int arrowWidth, arrowHeight;
-            SDL_QueryTexture(leftArrowTexture, NULL, NULL, &arrowWidth, &arrowHeight);
+        if (!leftArrowSprite) {
+            leftArrowSprite = TextureAtlas::sprite(renderer, "graphic/chontrai-Photoroom.png");
+        }
+        if (leftArrowSprite) {
+            int arrowWidth = leftArrowSprite.src.w;
+            int arrowHeight = leftArrowSprite.src.h;
 
             // Scale down the arrow dimensions
             int scaledArrowWidth = arrowWidth * 0.5;  // 50% of original width
@@ -522,15 +498,16 @@ public:
                 scaledArrowHeight
             };
 
-            SDL_RenderCopy(renderer, leftArrowTexture, NULL, &leftArrowRect);
-            SDL_DestroyTexture(leftArrowTexture);
+            renderSprite(renderer, leftArrowSprite, &leftArrowRect);
         }
 
         // Render right arrow
-        SDL_Texture* rightArrowTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\chonphai-Photoroom.png");
-        if (rightArrowTexture) {
-            int arrowWidth, arrowHeight;
-            SDL_QueryTexture(rightArrowTexture, NULL, NULL, &arrowWidth, &arrowHeight);
+        if (!rightArrowSprite) {
+            rightArrowSprite = TextureAtlas::sprite(renderer, "graphic/chonphai-Photoroom.png");
+        }
+        if (rightArrowSprite) {
+            int arrowWidth = rightArrowSprite.src.w;
+            int arrowHeight = rightArrowSprite.src.h;
 
             // Scale down the arrow dimensions
             int scaledArrowWidth = arrowWidth * 0.5;  // 50% of original width
@@ -544,8 +521,7 @@ public:
                 scaledArrowHeight
             };
 
-            SDL_RenderCopy(renderer, rightArrowTexture, NULL, &rightArrowRect);
-            SDL_DestroyTexture(rightArrowTexture);
+            renderSprite(renderer, rightArrowSprite, &rightArrowRect);
         }
     }
 
@@ -557,15 +533,17 @@ public:
     // New method for rendering level selection
     void renderLevelSelection(const char* levelPaths[], bool levelUnlocked[]) {
         // Load level lock texture if not already loaded
-        if (!levelLockTexture) {
-            levelLockTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\lock-removebg-preview.png");
+        if (!levelLockSprite) {
+            levelLockSprite = TextureAtlas::sprite(renderer, "graphic/lock-removebg-preview.png");
         }
 
         // Render level selection background
-        SDL_Texture* levelSelectTexture = IMG_LoadTexture(renderer, "F:\\Game\\graphic\\levil-Photoroom.png");
-        if (levelSelectTexture) {
-            int texWidth, texHeight;
-            SDL_QueryTexture(levelSelectTexture, NULL, NULL, &texWidth, &texHeight);
+        if (!levelSelectSprite) {
+            levelSelectSprite = TextureAtlas::sprite(renderer, "graphic/levil-Photoroom.png");
+        }
+        if (levelSelectSprite) {
+            int texWidth = levelSelectSprite.src.w;
+            int texHeight = levelSelectSprite.src.h;
 
             // Scale up the dimensions
             int scaledWidth = texWidth * 1.5;  // 150% of original width
@@ -579,14 +557,12 @@ public:
                 scaledHeight
             };
 
-            SDL_RenderCopy(renderer, levelSelectTexture, NULL, &destRect);
-            SDL_DestroyTexture(levelSelectTexture);
+            renderSprite(renderer, levelSelectSprite, &destRect);
         }
 
         // Calculate positions for level buttons with dynamic sizing
 
-        // Pre-load all level textures to get their dimensions
-        SDL_Texture* levelTextures[5];
+        // Level textures are loaded once and kept, only their dimensions are queried here
         int actualWidths[5];
         int actualHeights[5];
         const int BASE_BUTTON_WIDTH = 200;  // Base width, will be adjusted to actual image size
@@ -595,9 +571,12 @@ public:
         const int VERTICAL_SPACING = 100;
         // Load all textures and get dimensions
         for (int i = 0; i < 5; i++) {
-            levelTextures[i] = IMG_LoadTexture(renderer, levelPaths[i]);
-            if (levelTextures[i]) {
-                SDL_QueryTexture(levelTextures[i], NULL, NULL, &actualWidths[i], &actualHeights[i]);
+            if (!levelSprites[i]) {
+                levelSprites[i] = TextureAtlas::sprite(renderer, levelPaths[i]);
+            }
+            if (levelSprites[i]) {
+                actualWidths[i] = levelSprites[i].src.w;
+                actualHeights[i] = levelSprites[i].src.h;
             }
         }
 
@@ -606,7 +585,7 @@ public:
         int secondRowMaxHeight = 0;
 
         for (int i = 0; i < 5; i++) {
-            if (levelTextures[i] && actualHeights[i] > firstRowMaxHeight)
+            if (levelSprites[i] && actualHeights[i] > firstRowMaxHeight)
                 firstRowMaxHeight = actualHeights[i];
         }
 
@@ -639,7 +618,7 @@ public:
         int currentSecondRowX = secondRowStartX;
 
         for (int i = 0; i < 5; i++) {
-            if (levelTextures[i]) {
+            if (levelSprites[i]) {
                 SDL_Rect levelRect;
 
                 if (i < 3) {
@@ -662,13 +641,13 @@ public:
                     currentSecondRowX += actualWidths[i] + HORIZONTAL_SPACING;
                 }
 
-                SDL_RenderCopy(renderer, levelTextures[i], NULL, &levelRect);
+                renderSprite(renderer, levelSprites[i], &levelRect);
 
                 // Store level rectangle for click detection - USE THE EXACT SAME RECTANGLE
                 levelRects[i] = levelRect;
 
                 // Render lock if level is locked
-                if (!levelUnlocked[i] && levelLockTexture) {
+                if (!levelUnlocked[i] && levelLockSprite) {
                     int lockWidth = actualWidths[i] * 0.5;  // Lock size relative to level button
                     int lockHeight = lockWidth;  // Keep aspect ratio
                     SDL_Rect lockRect = {
@@ -677,17 +656,10 @@ public:
                         lockWidth,
                         lockHeight
                     };
-                    SDL_RenderCopy(renderer, levelLockTexture, NULL, &lockRect);
+                    renderSprite(renderer, levelLockSprite, &lockRect);
                 }
             }
         }
-
-        // Clean up textures
-        for (int i = 0; i < 5; i++) {
-            if (levelTextures[i]) {
-                SDL_DestroyTexture(levelTextures[i]);
-            }
-        }
     }
 
     // Handle level selection events, returns selectedLevel if a level was clicked, 0 otherwise
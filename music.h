@@ -1,5 +1,6 @@
 #pragma once
 #include <SDL_mixer.h>
+#include "asset_archive.h"
 
 class Music {
 private:
@@ -22,23 +23,39 @@ public:
               musicVolume(MIX_MAX_VOLUME), sfxVolume(MIX_MAX_VOLUME) {}
 
     Mix_Music* loadMusic(const char* path) {
-        gMusic = Mix_LoadMUS(path);
+        gMusic = Mix_LoadMUS_RW(AssetArchive::openRW(path), 1);
         return gMusic;
     }
  // load am thanh
     void loadSound(const char* path) {
-        grabSound = Mix_LoadWAV(path);
-        if (grabSound != nullptr) {
-            grabSound->alen = 44100 * 2 * 2; // cut xuong 1s
-        }
+        setGrabSound(Mix_LoadWAV_RW(AssetArchive::openRW(path), 1));
     }
 
     void loadFallSound(const char* path) {
-        fallSound = Mix_LoadWAV(path);
+        setFallSound(Mix_LoadWAV_RW(AssetArchive::openRW(path), 1));
     }
 
     void loadApplauseSound(const char* path) {
-        applauseSound = Mix_LoadWAV(path);
+        setApplauseSound(Mix_LoadWAV_RW(AssetArchive::openRW(path), 1));
+    }
+
+    // Take ownership of chunks decoded elsewhere (AssetLoader threads)
+    void setGrabSound(Mix_Chunk* chunk) {
+        if (grabSound != nullptr) Mix_FreeChunk(grabSound);
+        grabSound = chunk;
+        if (grabSound != nullptr && grabSound->alen > 44100 * 2 * 2) {
+            grabSound->alen = 44100 * 2 * 2; // cut xuong 1s
+        }
+    }
+
+    void setFallSound(Mix_Chunk* chunk) {
+        if (fallSound != nullptr) Mix_FreeChunk(fallSound);
+        fallSound = chunk;
+    }
+
+    void setApplauseSound(Mix_Chunk* chunk) {
+        if (applauseSound != nullptr) Mix_FreeChunk(applauseSound);
+        applauseSound = chunk;
     }
 
     void play() {
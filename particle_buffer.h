@@ -0,0 +1,236 @@
+#ifndef _PARTICLEBUFFER__H
+#define _PARTICLEBUFFER__H
+#include <SDL.h>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PARTICLE_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_SIMD_SSE2
+#endif
+
+// Structure-of-arrays store for Verlet particles: current position (x, y), previous position
+// (px, py) and a pinned mask, each array aligned and padded to ParticleBuffer::LANES doubles.
+// Pinned is kept as a full 64-bit mask (all ones = pinned) so the SIMD path can blend with it;
+// padding lanes are pinned so they never move.
+class ParticleBuffer {
+public:
+    static const int LANES = 4;  // one AVX register of doubles, also a multiple of the SSE2 width
+
+    double* x;
+    double* y;
+    double* px;
+    double* py;
+    uint64_t* pinned;
+
+    ParticleBuffer() : x(nullptr), y(nullptr), px(nullptr), py(nullptr), pinned(nullptr),
+                       block(nullptr), count(0), capacity(0) {}
+
+    explicit ParticleBuffer(int n) : ParticleBuffer() {
+        resize(n);
+    }
+
+    ParticleBuffer(const ParticleBuffer& other) : ParticleBuffer() {
+        *this = other;
+    }
+
+    ParticleBuffer(ParticleBuffer&& other) : ParticleBuffer() {
+        swap(other);
+    }
+
+    ParticleBuffer& operator=(const ParticleBuffer& other) {
+        if (this == &other) return *this;
+        resize(other.count);
+        if (count > 0) {
+            size_t bytes = count * sizeof(double);
+            memcpy(x, other.x, bytes);
+            memcpy(y, other.y, bytes);
+            memcpy(px, other.px, bytes);
+            memcpy(py, other.py, bytes);
+            memcpy(pinned, other.pinned, count * sizeof(uint64_t));
+        }
+        return *this;
+    }
+
+    ParticleBuffer& operator=(ParticleBuffer&& other) {
+        swap(other);
+        return *this;
+    }
+
+    ~ParticleBuffer() {
+        if (block != nullptr) SDL_SIMDFree(block);
+    }
+
+    // New particles start at the origin and free. Throws std::bad_alloc (size unchanged) when the
+    // buffer cannot grow.
+    void resize(int n) {
+        reserve(n);
+        for (int i = count; i < n; i++) {
+            x[i] = y[i] = px[i] = py[i] = 0.0;
+            pinned[i] = 0;
+        }
+        for (int i = n; i < capacity; i++) {
+            x[i] = y[i] = px[i] = py[i] = 0.0;
+            pinned[i] = ~uint64_t(0);
+        }
+        count = n;
+    }
+
+    int size() const { return count; }
+    int last() const { return count - 1; }
+
+    bool isPinned(int i) const { return pinned[i] != 0; }
+    void setPinned(int i, bool value) { pinned[i] = value ? ~uint64_t(0) : 0; }
+
+    // Place a particle at rest (previous position = current position)
+    void place(int i, double newX, double newY) {
+        x[i] = px[i] = newX;
+        y[i] = py[i] = newY;
+    }
+
+    // Shift every particle, velocity is kept because previous positions move too
+    void translate(double dx, double dy) {
+        for (int i = 0; i < count; i++) {
+            x[i] += dx;
+            px[i] += dx;
+            y[i] += dy;
+            py[i] += dy;
+        }
+    }
+
+    // One Verlet step for every free particle:
+    //   v = (current - previous) * damping, v.y += gravityStep, previous = current, current += v
+    // The SIMD paths do the exact same operations in the same order, so results are bit-identical
+    // to the scalar loop.
+    void integrate(double damping, double gravityStep) {
+        integrateLanes(x, y, px, py, pinned, pinned, 0, count, damping, gravityStep);
+    }
+
+    // The same step over lanes [first, end) of raw arrays, a lane stays put when either mask is set.
+    // first must be a multiple of LANES and the arrays LANES aligned; SimulationBatch runs it across
+    // instances (one array per rope particle, one lane per instance) with frozen = not stepping.
+    static void integrateLanes(double* x, double* y, double* px, double* py, const uint64_t* pinned,
+                               const uint64_t* frozen, int first, int end, double damping, double gravityStep) {
+        int i = first;
+#if defined(PARTICLE_SIMD_AVX)
+        const __m256d vDamping = _mm256_set1_pd(damping);
+        const __m256d vGravity = _mm256_set1_pd(gravityStep);
+        for (; i + 4 <= end; i += 4) {
+            __m256d cx = _mm256_load_pd(x + i);
+            __m256d cy = _mm256_load_pd(y + i);
+            __m256d ox = _mm256_load_pd(px + i);
+            __m256d oy = _mm256_load_pd(py + i);
+            __m256d mask = _mm256_or_pd(
+                _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i*>(pinned + i))),
+                _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i*>(frozen + i))));
+
+            __m256d vx = _mm256_mul_pd(_mm256_sub_pd(cx, ox), vDamping);
+            __m256d vy = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(cy, oy), vDamping), vGravity);
+            __m256d nx = _mm256_add_pd(cx, vx);
+            __m256d ny = _mm256_add_pd(cy, vy);
+
+            // Pinned lanes keep their old values
+            _mm256_store_pd(x + i, _mm256_or_pd(_mm256_and_pd(mask, cx), _mm256_andnot_pd(mask, nx)));
+            _mm256_store_pd(y + i, _mm256_or_pd(_mm256_and_pd(mask, cy), _mm256_andnot_pd(mask, ny)));
+            _mm256_store_pd(px + i, _mm256_or_pd(_mm256_and_pd(mask, ox), _mm256_andnot_pd(mask, cx)));
+            _mm256_store_pd(py + i, _mm256_or_pd(_mm256_and_pd(mask, oy), _mm256_andnot_pd(mask, cy)));
+        }
+#elif defined(PARTICLE_SIMD_SSE2)
+        const __m128d vDamping = _mm_set1_pd(damping);
+        const __m128d vGravity = _mm_set1_pd(gravityStep);
+        for (; i + 2 <= end; i += 2) {
+            __m128d cx = _mm_load_pd(x + i);
+            __m128d cy = _mm_load_pd(y + i);
+            __m128d ox = _mm_load_pd(px + i);
+            __m128d oy = _mm_load_pd(py + i);
+            __m128d mask = _mm_or_pd(_mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(pinned + i))),
+                                     _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(frozen + i))));
+
+            __m128d vx = _mm_mul_pd(_mm_sub_pd(cx, ox), vDamping);
+            __m128d vy = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(cy, oy), vDamping), vGravity);
+            __m128d nx = _mm_add_pd(cx, vx);
+            __m128d ny = _mm_add_pd(cy, vy);
+
+            _mm_store_pd(x + i, _mm_or_pd(_mm_and_pd(mask, cx), _mm_andnot_pd(mask, nx)));
+            _mm_store_pd(y + i, _mm_or_pd(_mm_and_pd(mask, cy), _mm_andnot_pd(mask, ny)));
+            _mm_store_pd(px + i, _mm_or_pd(_mm_and_pd(mask, ox), _mm_andnot_pd(mask, cx)));
+            _mm_store_pd(py + i, _mm_or_pd(_mm_and_pd(mask, oy), _mm_andnot_pd(mask, cy)));
+        }
+#endif
+        // Scalar fallback (and the whole loop when no SIMD is available)
+        for (; i < end; i++) {
+            if (pinned[i] || frozen[i]) continue;
+            double velocityX = (x[i] - px[i]) * damping;
+            double velocityY = (y[i] - py[i]) * damping + gravityStep;
+            px[i] = x[i];
+            py[i] = y[i];
+            x[i] += velocityX;
+            y[i] += velocityY;
+        }
+    }
+
+private:
+    void* block;   // single SDL_SIMDAlloc block holding all five arrays
+    int count;
+    int capacity;  // multiple of LANES
+
+    static size_t blockBytes(int cap) {
+        return static_cast<size_t>(cap) * (4 * sizeof(double) + sizeof(uint64_t));
+    }
+
+    void reserve(int n) {
+        int needed = (n + LANES - 1) / LANES * LANES;
+        if (needed <= capacity && block != nullptr) return;
+        if (needed == 0) needed = LANES;
+
+        void* newBlock = SDL_SIMDAlloc(blockBytes(needed));
+        if (newBlock == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "Could not allocate %d particles", n);
+            throw std::bad_alloc();
+        }
+        double* base = static_cast<double*>(newBlock);
+        double* nx = base;
+        double* ny = base + needed;
+        double* npx = base + needed * 2;
+        double* npy = base + needed * 3;
+        uint64_t* npinned = reinterpret_cast<uint64_t*>(base + needed * 4);
+
+        // Keep existing particles, everything past them is padding until resize() fills it in
+        for (int i = 0; i < needed; i++) {
+            bool keep = i < count;
+            nx[i] = keep ? x[i] : 0.0;
+            ny[i] = keep ? y[i] : 0.0;
+            npx[i] = keep ? px[i] : 0.0;
+            npy[i] = keep ? py[i] : 0.0;
+            npinned[i] = keep ? pinned[i] : ~uint64_t(0);
+        }
+
+        if (block != nullptr) SDL_SIMDFree(block);
+        block = newBlock;
+        capacity = needed;
+        x = nx;
+        y = ny;
+        px = npx;
+        py = npy;
+        pinned = npinned;
+    }
+
+    void swap(ParticleBuffer& other) {
+        std::swap(x, other.x);
+        std::swap(y, other.y);
+        std::swap(px, other.px);
+        std::swap(py, other.py);
+        std::swap(pinned, other.pinned);
+        std::swap(block, other.block);
+        std::swap(count, other.count);
+        std::swap(capacity, other.capacity);
+    }
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef _PROFILER__H
+#define _PROFILER__H
+#include <SDL.h>
+#include <algorithm>
+#include "chrome_trace.h"
+
+// Frame profiler for the main loop. PROFILE_ZONE(ZONE_X) at the top of a block adds the time until
+// the end of the block to zone X for the current frame; a zone hit several times in one frame
+// (two physics steps, two ropes) adds up. The last HISTORY frames are kept in a ring buffer for
+// the per zone min / avg / max and the frame graph that F3 toggles.
+//
+// With a trace open (ChromeTrace::open, --trace in the game) every zone and frame is also streamed
+// to a Chrome trace file.
+//
+// Only compiled in with -DPROFILER_ENABLED. Without it PROFILE_ZONE expands to nothing and the
+// Profiler class is never used, so the headless build and the tools pay nothing for the zones in
+// simulation.h and graphics.h.
+enum ProfileZone {
+    ZONE_EVENTS,            // SDL_PollEvent loop and menu input
+    ZONE_CAMERA,            // camera follow and chunk streaming
+    ZONE_MOVING_PLATFORMS,
+    ZONE_PLAYER_UPDATE,     // player.update: swing forces, ropes, integration
+    ZONE_COLLISION,         // body and rope collisions
+    ZONE_BACKGROUND_DRAW,
+    ZONE_PLATFORM_DRAW,     // platforms and spike wall
+    ZONE_ROPE_DRAW,
+    ZONE_PRESENT,           // SDL_RenderPresent, includes the vsync wait
+    ZONE_LEVEL_LOAD,        // reading a level and building its first chunks
+    ZONE_ASSET_UPLOAD,      // textures the loader threads decoded, uploaded by the main thread
+    ZONE_COUNT
+};
+
+class Profiler {
+public:
+    static const int HISTORY = 240;             // frames in the ring buffer, 4 seconds at 60 fps
+    static constexpr float GRAPH_SCALE = 6.0f;  // pixels per millisecond in the frame graph
+
+    struct ZoneStats {
+        float min, avg, max;    // milliseconds, over the frames in the ring that hit the zone
+        int frames;
+    };
+
+    static const char* zoneName(ProfileZone zone) {
+        static const char* names[ZONE_COUNT] = {
+            "events", "camera", "moving platforms", "player update", "collision",
+            "background draw", "platform draw", "rope draw", "present", "level load", "asset upload"
+        };
+        return names[zone];
+    }
+
+    static void add(ProfileZone zone, Uint64 start, Uint64 end) {
+        state().current.zones[zone] += static_cast<float>((end - start) * state().msPerTick);
+        ChromeTrace::record(zoneName(zone), start, end);
+    }
+
+    // Call at the top of the main loop: the frame that just ended goes into the ring buffer
+    static void newFrame() {
+        State& s = state();
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (s.frameStart != 0) {
+            ChromeTrace::record("frame", s.frameStart, now);
+            s.current.total = static_cast<float>((now - s.frameStart) * s.msPerTick);
+            s.ring[s.head] = s.current;
+            s.head = (s.head + 1) % HISTORY;
+            s.count = std::min(s.count + 1, HISTORY);
+
+            // While the overlay is up, the numbers behind it go to the log once per ring
+            if (s.overlay && ++s.framesSinceReport == HISTORY) {
+                report();
+                s.framesSinceReport = 0;
+            }
+        }
+        s.current = Frame();
+        s.frameStart = now;
+    }
+
+    static ZoneStats stats(ProfileZone zone) {
+        const State& s = state();
+        ZoneStats result = {0, 0, 0, 0};
+        float sum = 0;
+        for (int i = 0; i < s.count; i++) {
+            float ms = s.ring[i].zones[zone];
+            if (ms <= 0) continue;
+            result.min = result.frames == 0 ? ms : std::min(result.min, ms);
+            result.max = std::max(result.max, ms);
+            sum += ms;
+            result.frames++;
+        }
+        if (result.frames > 0) result.avg = sum / result.frames;
+        return result;
+    }
+
+    static void toggleOverlay() {
+        state().overlay = !state().overlay;
+        state().framesSinceReport = 0;
+    }
+
+    static bool overlayVisible() { return state().overlay; }
+
+    static void report() {
+        for (int zone = 0; zone < ZONE_COUNT; zone++) {
+            ZoneStats z = stats(static_cast<ProfileZone>(zone));
+            if (z.frames == 0) continue;
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                           "Profiler %-16s min %6.3f  avg %6.3f  max %6.3f ms", zoneName(static_cast<ProfileZone>(zone)),
+                           z.min, z.avg, z.max);
+        }
+    }
+
+    // Frame graph (one column per frame, zones stacked in their colors over the whole frame time in
+    // gray, lines at 16.7 and 33.3 ms) and below it one row per zone: min..max line, avg bar
+    static void renderOverlay(SDL_Renderer* renderer) {
+        const State& s = state();
+        if (!s.overlay) return;
+
+        const int COLUMN = 3, LEFT = 20, TOP = 20;
+        const int GRAPH_HEIGHT = static_cast<int>(40 * GRAPH_SCALE);
+        const int ROW = 18, ROW_SCALE = 8;  // zone rows are drawn larger, most zones take well under 1 ms
+        const int width = HISTORY * COLUMN;
+
+        SDL_BlendMode oldBlend;
+        SDL_GetRenderDrawBlendMode(renderer, &oldBlend);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+        SDL_Rect panel = {LEFT - 10, TOP - 10, width + 20, GRAPH_HEIGHT + ZONE_COUNT * ROW + 30};
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+        SDL_RenderFillRect(renderer, &panel);
+
+        // Oldest frame on the left
+        int baseline = TOP + GRAPH_HEIGHT;
+        for (int i = 0; i < s.count; i++) {
+            const Frame& frame = s.ring[(s.head - s.count + i + HISTORY) % HISTORY];
+            int x = LEFT + (HISTORY - s.count + i) * COLUMN;
+
+            int totalHeight = std::min(GRAPH_HEIGHT, static_cast<int>(frame.total * GRAPH_SCALE));
+            SDL_Rect total = {x, baseline - totalHeight, COLUMN - 1, totalHeight};
+            SDL_SetRenderDrawColor(renderer, 90, 90, 90, 255);
+            SDL_RenderFillRect(renderer, &total);
+
+            int y = baseline;
+            for (int zone = 0; zone < ZONE_COUNT && y > TOP; zone++) {
+                int height = static_cast<int>(frame.zones[zone] * GRAPH_SCALE + 0.5f);
+                if (height <= 0) continue;
+                height = std::min(height, y - TOP);
+                y -= height;
+                SDL_Rect segment = {x, y, COLUMN - 1, height};
+                setZoneColor(renderer, static_cast<ProfileZone>(zone), 255);
+                SDL_RenderFillRect(renderer, &segment);
+            }
+        }
+
+        // Frame budgets at 60 and 30 fps
+        SDL_SetRenderDrawColor(renderer, 0, 200, 0, 255);
+        int line60 = baseline - static_cast<int>(1000.0f / 60 * GRAPH_SCALE);
+        SDL_RenderDrawLine(renderer, LEFT, line60, LEFT + width, line60);
+        SDL_SetRenderDrawColor(renderer, 220, 0, 0, 255);
+        int line30 = baseline - static_cast<int>(1000.0f / 30 * GRAPH_SCALE);
+        SDL_RenderDrawLine(renderer, LEFT, line30, LEFT + width, line30);
+
+        for (int zone = 0; zone < ZONE_COUNT; zone++) {
+            ZoneStats z = stats(static_cast<ProfileZone>(zone));
+            int y = baseline + 10 + zone * ROW;
+
+            SDL_Rect swatch = {LEFT, y, ROW - 4, ROW - 4};
+            setZoneColor(renderer, static_cast<ProfileZone>(zone), 255);
+            SDL_RenderFillRect(renderer, &swatch);
+            if (z.frames == 0) continue;
+
+            int barLeft = LEFT + ROW + 4;
+            int barMax = width - ROW - 4;
+            SDL_Rect avg = {barLeft, y + 2, std::min(barMax, static_cast<int>(z.avg * GRAPH_SCALE * ROW_SCALE) + 1), ROW - 8};
+            setZoneColor(renderer, static_cast<ProfileZone>(zone), 200);
+            SDL_RenderFillRect(renderer, &avg);
+
+            int minX = barLeft + std::min(barMax, static_cast<int>(z.min * GRAPH_SCALE * ROW_SCALE));
+            int maxX = barLeft + std::min(barMax, static_cast<int>(z.max * GRAPH_SCALE * ROW_SCALE));
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+            SDL_RenderDrawLine(renderer, minX, y + ROW / 2 - 2, maxX, y + ROW / 2 - 2);
+            SDL_RenderDrawLine(renderer, maxX, y, maxX, y + ROW - 5);
+        }
+
+        SDL_SetRenderDrawBlendMode(renderer, oldBlend);
+    }
+
+private:
+    struct Frame {
+        float zones[ZONE_COUNT];
+        float total;
+
+        Frame() : total(0) {
+            std::fill(zones, zones + ZONE_COUNT, 0.0f);
+        }
+    };
+
+    struct State {
+        Frame ring[HISTORY];
+        Frame current;
+        int head = 0;
+        int count = 0;
+        int framesSinceReport = 0;
+        bool overlay = false;
+        Uint64 frameStart = 0;
+        double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static void setZoneColor(SDL_Renderer* renderer, ProfileZone zone, Uint8 alpha) {
+        static const SDL_Color colors[ZONE_COUNT] = {
+            {230, 230, 230, 255},   // events
+            {255, 215, 0, 255},     // camera
+            {255, 140, 0, 255},     // moving platforms
+            {220, 20, 60, 255},     // player update
+            {186, 85, 211, 255},    // collision
+            {70, 130, 180, 255},    // background draw
+            {0, 191, 255, 255},     // platform draw
+            {50, 205, 50, 255},     // rope draw
+            {128, 128, 0, 255},     // present
+            {255, 0, 255, 255},     // level load
+            {139, 69, 19, 255},     // asset upload
+        };
+        SDL_SetRenderDrawColor(renderer, colors[zone].r, colors[zone].g, colors[zone].b, alpha);
+    }
+};
+
+// Times the enclosing block; stop() ends it early for phases that are not a block of their own
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileZone z) : zone(z), start(SDL_GetPerformanceCounter()), running(true) {}
+
+    ~ProfileScope() {
+        stop();
+    }
+
+    void stop() {
+        if (!running) return;
+        Profiler::add(zone, start, SDL_GetPerformanceCounter());
+        running = false;
+    }
+
+private:
+    ProfileZone zone;
+    Uint64 start;
+    bool running;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_ZONE(zone) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(zone)
+#define PROFILE_ZONE_NAMED(name, zone) ProfileScope name(zone)
+#define PROFILE_ZONE_STOP(name) name.stop()
+#define PROFILE_NEW_FRAME() Profiler::newFrame()
+#else
+#define PROFILE_ZONE(zone) ((void)0)
+#define PROFILE_ZONE_NAMED(name, zone) ((void)0)
+#define PROFILE_ZONE_STOP(name) ((void)0)
+#define PROFILE_NEW_FRAME() ((void)0)
+#endif
+
+#endif
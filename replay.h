@@ -0,0 +1,281 @@
+#ifndef _REPLAY__H
+#define _REPLAY__H
+#include <SDL.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "input_frame.h"
+#include "simulation.h"
+
+// Recorded runs. GameSimulation::step only depends on the level, the fixed dt and the InputFrame it
+// is given (no clock, no rand, SIMD paths bit-identical to the scalar ones), so the inputs of every
+// step are enough to play a run again exactly. The game keeps the last and the best run of each
+// level (levelN_last.sgr / levelN_best.sgr in the user folder), Game_headless records and replays them.
+//
+// File form, little endian:
+//   ReplayHeader
+//   ReplayRun[runCount]                 identical inputs for count steps in a row
+//   uint64_t[checkpointCount]           stateHash() after every REPLAY_CHECKPOINT_INTERVAL steps
+// Holding a key for a second is one run, so a whole level is usually a few hundred bytes.
+const char REPLAY_MAGIC[4] = {'S', 'G', 'R', 'P'};
+const uint32_t REPLAY_VERSION = 1;
+const uint32_t REPLAY_CHECKPOINT_INTERVAL = 60;
+
+struct ReplayHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t level;
+    uint32_t steps;
+    uint32_t runCount;
+    uint32_t checkpointCount;
+    uint64_t finalHash;     // stateHash() after the last step
+};
+
+struct ReplayRun {
+    uint8_t buttons;        // InputFrame::buttons
+    uint8_t reserved;
+    uint16_t count;         // longer runs are split
+};
+
+static_assert(sizeof(ReplayHeader) == 32, "ReplayHeader must stay 32 bytes");
+static_assert(sizeof(ReplayRun) == 4, "ReplayRun must stay 4 bytes");
+
+// FNV-1a over the exact bits of everything a step moves, two runs hash the same only when they
+// are identical down to the last bit of every double
+class StateHash {
+public:
+    StateHash() : value(14695981039346656037ull) {}
+
+    void add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+    }
+
+    void add(double v) { add(&v, sizeof(v)); }
+    void add(int v) { add(&v, sizeof(v)); }
+    void add(bool v) { add(static_cast<int>(v)); }
+    void add(const SDL_Rect& r) { add(r.x); add(r.y); add(r.w); add(r.h); }
+
+    void add(const ropehand& hand) {
+        const ParticleBuffer& p = hand.parti;
+        for (int i = 0; i < p.size(); i++) {
+            add(p.x[i]); add(p.y[i]); add(p.px[i]); add(p.py[i]);
+        }
+        add(hand.isGrabbingObject);
+        add(hand.grabbedPlatformIndex);
+    }
+
+    uint64_t result() const { return value; }
+
+private:
+    uint64_t value;
+};
+
+inline uint64_t stateHash(const GameSimulation& sim) {
+    StateHash hash;
+    const Character& player = sim.player;
+    hash.add(player.x); hash.add(player.y);
+    hash.add(player.vx); hash.add(player.vy);
+    hash.add(player.leftHand);
+    hash.add(player.rightHand);
+    hash.add(player.hasReachedFinish);
+    hash.add(sim.camera.x);
+    for (const Platform& platform : sim.world.platforms) {
+        hash.add(platform.rect);
+        hash.add(platform.activated);
+    }
+    if (sim.spikeWall) hash.add(sim.spikeWall->rect);
+    hash.add(sim.rules.pressedButtons);
+    hash.add(sim.rules.gatesOpen);
+    return hash.result();
+}
+
+// The inputs of one run plus the hashes to check a replay against
+class ReplayLog {
+public:
+    int level;
+    uint32_t steps;
+    std::vector<ReplayRun> runs;
+    std::vector<uint64_t> checkpoints;
+    uint64_t finalHash;
+
+    ReplayLog() { begin(0); }
+
+    // Start recording a run of this level, call right after GameSimulation::startLevel
+    void begin(int levelNumber) {
+        level = levelNumber;
+        steps = 0;
+        runs.clear();
+        checkpoints.clear();
+        finalHash = 0;
+    }
+
+    // Call after every sim.step(input, ...)
+    void record(const InputFrame& input, const GameSimulation& sim) {
+        if (!runs.empty() && runs.back().buttons == input.buttons && runs.back().count < UINT16_MAX) {
+            runs.back().count++;
+        } else {
+            ReplayRun run;
+            run.buttons = input.buttons;
+            run.reserved = 0;
+            run.count = 1;
+            runs.push_back(run);
+        }
+        steps++;
+        if (steps % REPLAY_CHECKPOINT_INTERVAL == 0) checkpoints.push_back(stateHash(sim));
+    }
+
+    // Call once the run is over, before save()
+    void finish(const GameSimulation& sim) {
+        finalHash = stateHash(sim);
+    }
+
+    void write(std::vector<char>& out) const {
+        ReplayHeader header;
+        memcpy(header.magic, REPLAY_MAGIC, 4);
+        header.version = REPLAY_VERSION;
+        header.level = level;
+        header.steps = steps;
+        header.runCount = static_cast<uint32_t>(runs.size());
+        header.checkpointCount = static_cast<uint32_t>(checkpoints.size());
+        header.finalHash = finalHash;
+
+        size_t runBytes = runs.size() * sizeof(ReplayRun);
+        out.resize(sizeof(header) + runBytes + checkpoints.size() * sizeof(uint64_t));
+        memcpy(out.data(), &header, sizeof(header));
+        if (!runs.empty()) memcpy(out.data() + sizeof(header), runs.data(), runBytes);
+        if (!checkpoints.empty()) {
+            memcpy(out.data() + sizeof(header) + runBytes, checkpoints.data(), checkpoints.size() * sizeof(uint64_t));
+        }
+    }
+
+    // Everything is checked before it is trusted, the run lengths must add up to steps
+    bool read(const void* data, size_t size, std::string& error) {
+        begin(0);
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        ReplayHeader header;
+        if (size < sizeof(header)) {
+            error = "file too small";
+            return false;
+        }
+        memcpy(&header, bytes, sizeof(header));
+        if (memcmp(header.magic, REPLAY_MAGIC, 4) != 0 || header.version != REPLAY_VERSION) {
+            error = "not a replay file or wrong version";
+            return false;
+        }
+
+        size_t runBytes = static_cast<size_t>(header.runCount) * sizeof(ReplayRun);
+        size_t checkpointBytes = static_cast<size_t>(header.checkpointCount) * sizeof(uint64_t);
+        if (size - sizeof(header) < runBytes || size - sizeof(header) - runBytes < checkpointBytes) {
+            error = "truncated";
+            return false;
+        }
+
+        runs.resize(header.runCount);
+        if (runBytes > 0) memcpy(runs.data(), bytes + sizeof(header), runBytes);
+        checkpoints.resize(header.checkpointCount);
+        if (checkpointBytes > 0) memcpy(checkpoints.data(), bytes + sizeof(header) + runBytes, checkpointBytes);
+
+        uint64_t total = 0;
+        for (const ReplayRun& run : runs) total += run.count;
+        if (total != header.steps || header.checkpointCount != header.steps / REPLAY_CHECKPOINT_INTERVAL) {
+            error = "step count does not match the runs";
+            return false;
+        }
+
+        level = header.level;
+        steps = header.steps;
+        finalHash = header.finalHash;
+        return true;
+    }
+
+    bool save(const std::string& path) const {
+        std::vector<char> out;
+        write(out);
+        SDL_RWops* rw = SDL_RWFromFile(path.c_str(), "wb");
+        if (rw == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "Cannot write replay %s: %s", path.c_str(), SDL_GetError());
+            return false;
+        }
+        bool ok = SDL_RWwrite(rw, out.data(), 1, out.size()) == out.size();
+        SDL_RWclose(rw);
+        return ok;
+    }
+
+    // A missing file is not an error (no run recorded yet), a broken one is logged
+    bool load(const std::string& path) {
+        SDL_RWops* rw = SDL_RWFromFile(path.c_str(), "rb");
+        if (rw == nullptr) return false;
+        std::vector<char> data;
+        Sint64 size = SDL_RWsize(rw);
+        if (size > 0) {
+            data.resize(static_cast<size_t>(size));
+            if (SDL_RWread(rw, data.data(), 1, data.size()) != data.size()) data.clear();
+        }
+        SDL_RWclose(rw);
+
+        std::string error = "read failed";
+        if (data.empty() || !read(data.data(), data.size(), error)) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "Bad replay %s: %s", path.c_str(), error.c_str());
+            begin(0);
+            return false;
+        }
+        return true;
+    }
+};
+
+// Feeds a ReplayLog back into a simulation and checks it stays on the recorded path:
+//   while (player.next(input)) { sim.step(input, events); if (!player.check(sim)) break; }
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(const ReplayLog& replayLog)
+        : log(replayLog), run(0), runLeft(replayLog.runs.empty() ? 0 : replayLog.runs[0].count),
+          step(0), divergedAt(0) {}
+
+    // Input for the next step, false once the log is used up
+    bool next(InputFrame& input) {
+        while (run < log.runs.size() && runLeft == 0) {
+            run++;
+            runLeft = run < log.runs.size() ? log.runs[run].count : 0;
+        }
+        if (run >= log.runs.size()) return false;
+        input = InputFrame();
+        input.buttons = log.runs[run].buttons;
+        runLeft--;
+        return true;
+    }
+
+    // Call after each step, false when the state no longer matches the recording
+    bool check(const GameSimulation& sim) {
+        step++;
+        bool atCheckpoint = step % REPLAY_CHECKPOINT_INTERVAL == 0;
+        bool atEnd = step == log.steps;
+        if (!atCheckpoint && !atEnd) return true;
+
+        uint64_t hash = stateHash(sim);
+        bool ok = true;
+        if (atCheckpoint) ok = hash == log.checkpoints[step / REPLAY_CHECKPOINT_INTERVAL - 1];
+        if (atEnd) ok = ok && hash == log.finalHash;
+        if (!ok && divergedAt == 0) divergedAt = step;
+        return ok;
+    }
+
+    uint32_t stepsPlayed() const { return step; }
+    uint32_t firstDivergence() const { return divergedAt; }  // 0 = none so far
+
+private:
+    const ReplayLog& log;
+    size_t run;
+    uint32_t runLeft;
+    uint32_t step;
+    uint32_t divergedAt;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef _ROPERENDERER__H
+#define _ROPERENDERER__H
+#include <SDL.h>
+#include <cmath>
+#include <vector>
+
+// Draws a rope polyline as one triangle strip with mitered joins, submitted in a single
+// SDL_RenderGeometry call (needs SDL 2.0.18+). Buffers are reused between frames so a
+// steady-state frame does not allocate.
+//   usage: clear(), addPoint() for every particle, draw()
+class RopeRenderer {
+public:
+    explicit RopeRenderer(float thickness = 5.0f, float miterLimit = 2.0f)
+        : thickness(thickness), miterLimit(miterLimit) {}
+
+    void setThickness(float value) { thickness = value; }
+    float getThickness() const { return thickness; }
+
+    // Longest miter allowed, in multiples of half the thickness, sharper joins get clamped
+    void setMiterLimit(float value) { miterLimit = value; }
+
+    void clear() {
+        points.clear();
+    }
+
+    void addPoint(double x, double y) {
+        SDL_FPoint p = {static_cast<float>(x), static_cast<float>(y)};
+        points.push_back(p);
+    }
+
+    void draw(SDL_Renderer* renderer, SDL_Color color) {
+        int count = static_cast<int>(points.size());
+        if (count < 2) return;
+
+        vertices.resize(count * 2);
+        indices.resize((count - 1) * 6);
+
+        float halfWidth = thickness * 0.5f;
+        // Normal of the previous segment, carried over so a zero length segment keeps a valid direction
+        float prevNx = 0.0f, prevNy = -1.0f;
+        bool havePrev = false;
+
+        for (int i = 0; i < count; i++) {
+            float nx, ny;
+            bool haveNext = i + 1 < count && segmentNormal(points[i], points[i + 1], nx, ny);
+            if (!haveNext) {
+                nx = prevNx;
+                ny = prevNy;
+            }
+            if (!havePrev) {
+                prevNx = nx;
+                prevNy = ny;
+            }
+
+            // Miter direction is the average of both segment normals, scaled so the strip keeps
+            // its width across the join: length = halfWidth / cos(theta / 2)
+            float mx = prevNx + nx;
+            float my = prevNy + ny;
+            float mLength = std::sqrt(mx * mx + my * my);
+            float extent = halfWidth;
+            if (mLength > 1e-6f) {
+                mx /= mLength;
+                my /= mLength;
+                float cosHalf = mx * nx + my * ny;
+                extent = cosHalf > 1e-6f ? halfWidth / cosHalf : halfWidth * miterLimit;
+                if (extent > halfWidth * miterLimit) extent = halfWidth * miterLimit;
+            } else {
+                // Rope folds back on itself, fall back to the segment normal
+                mx = nx;
+                my = ny;
+            }
+
+            SDL_Vertex& left = vertices[i * 2];
+            SDL_Vertex& right = vertices[i * 2 + 1];
+            left.position = {points[i].x + mx * extent, points[i].y + my * extent};
+            right.position = {points[i].x - mx * extent, points[i].y - my * extent};
+            left.color = right.color = color;
+            left.tex_coord = right.tex_coord = {0.0f, 0.0f};
+
+            prevNx = nx;
+            prevNy = ny;
+            havePrev = true;
+        }
+
+        // Two triangles per segment
+        for (int i = 0; i < count - 1; i++) {
+            int* quad = &indices[i * 6];
+            int l0 = i * 2, r0 = i * 2 + 1, l1 = i * 2 + 2, r1 = i * 2 + 3;
+            quad[0] = l0; quad[1] = r0; quad[2] = l1;
+            quad[3] = r0; quad[4] = r1; quad[5] = l1;
+        }
+
+        SDL_RenderGeometry(renderer, NULL, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+    }
+
+private:
+    float thickness;
+    float miterLimit;
+    std::vector<SDL_FPoint> points;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    // Unit normal of the segment a -> b, false when the two points coincide
+    static bool segmentNormal(const SDL_FPoint& a, const SDL_FPoint& b, float& nx, float& ny) {
+        float dx = b.x - a.x;
+        float dy = b.y - a.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < 1e-6f) return false;
+        nx = -dy / length;
+        ny = dx / length;
+        return true;
+    }
+};
+
+#endif
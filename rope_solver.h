@@ -0,0 +1,238 @@
+#ifndef _ROPESOLVER__H
+#define _ROPESOLVER__H
+#include <cmath>
+#include <vector>
+#include "particle_buffer.h"
+
+// Distance constraint backends for a rope (a chain of particles, segment j joins j and j+1)
+enum RopeSolver {
+    ROPE_SOLVER_JAKOBSEN,     // Gauss-Seidel relaxation, stiffness depends on the iteration count
+    ROPE_SOLVER_XPBD,         // XPBD with compliance, stiffness independent of iterations
+    ROPE_SOLVER_TRIDIAGONAL   // whole chain solved at once, the chain's system is tridiagonal
+};
+
+// Keeps its scratch buffers between frames, one per rope
+class RopeConstraintSolver {
+public:
+    static const int JAKOBSEN_ITERATIONS = 10;        // slack rope
+    static const int JAKOBSEN_TAUT_ITERATIONS = 20;   // the hand holds something
+    static const int XPBD_ITERATIONS = 4;
+    static const int TRIDIAGONAL_ITERATIONS = 2;      // Newton steps, the first one does nearly all the work
+
+    explicit RopeConstraintSolver(RopeSolver type = ROPE_SOLVER_JAKOBSEN)
+        : type(type), slackCompliance(0.00025) {}
+
+    RopeSolver getType() const { return type; }
+
+    // Compliance used while the rope is slack (inverse stiffness, 0 = rigid). Taut ropes are rigid.
+    // The default gives about the half-strength correction the Jakobsen solver uses for a slack rope.
+    void setSlackCompliance(double value) { slackCompliance = value; }
+
+    // Pull every segment back to restLength, pinned particles never move
+    void solve(ParticleBuffer& p, double restLength, bool taut, double dt) {
+        if (p.size() < 2) return;
+        switch (type) {
+            case ROPE_SOLVER_XPBD: solveXpbd(p, restLength, taut ? 0.0 : slackCompliance, dt); break;
+            case ROPE_SOLVER_TRIDIAGONAL: solveTridiagonal(p, restLength, taut ? 0.0 : slackCompliance, dt); break;
+            default: solveJakobsen(p, restLength, taut); break;
+        }
+    }
+
+private:
+    RopeSolver type;
+    double slackCompliance;
+
+    // Scratch, sized to the segment count
+    std::vector<double> lambda;
+    std::vector<double> nx, ny, error;
+    std::vector<double> diag, upper, sweep, rhs;
+    std::vector<double> stepX, stepY, savedX, savedY;
+
+    static double inverseMass(const ParticleBuffer& p, int i) {
+        return p.isPinned(i) ? 0.0 : 1.0;
+    }
+
+    // Jakobsen relaxation, same result as the old ropehand::enforceConstraint but with one sqrt per segment
+    void solveJakobsen(ParticleBuffer& p, double restLength, bool taut) {
+        const int iterations = taut ? JAKOBSEN_TAUT_ITERATIONS : JAKOBSEN_ITERATIONS;  // More iterations when grabbing
+        const double correction = taut ? 1.0 : 0.5;             // Full correction when grabbing
+        for (int i = 0; i < iterations; i++) {
+            for (int j = 1; j < p.size(); j++) {
+                double xDifference = p.x[j] - p.x[j-1];
+                double yDifference = p.y[j] - p.y[j-1];
+                double distance = sqrt(xDifference * xDifference + yDifference * yDifference);
+                // Avoid division by zero
+                if (distance < 0.0001) continue;
+
+                double distanceError = distance - restLength;
+                double xDirection = xDifference / distance;
+                double yDirection = yDifference / distance;
+
+                bool pinned1 = p.isPinned(j-1);
+                bool pinned2 = p.isPinned(j);
+// p1 fixed , p2 ko fixed thi p2 dich ve p1
+                if (pinned1 && !pinned2) {
+                    p.x[j] -= xDirection * distanceError * correction;
+                    p.y[j] -= yDirection * distanceError * correction;
+                }
+                else if (pinned2 && !pinned1) {
+                    p.x[j-1] += xDirection * distanceError * correction;
+                    p.y[j-1] += yDirection * distanceError * correction;
+                }
+                else if (!pinned1 && !pinned2) {
+                    p.x[j] -= xDirection * distanceError * correction * 0.5;
+                    p.y[j] -= yDirection * distanceError * correction * 0.5;
+                    p.x[j-1] += xDirection * distanceError * correction * 0.5;
+                    p.y[j-1] += yDirection * distanceError * correction * 0.5;
+                }
+            }
+        }
+    }
+
+    // XPBD: C = |p2 - p1| - rest, alphaTilde = compliance / dt^2,
+    //   dLambda = (-C - alphaTilde * lambda) / (w1 + w2 + alphaTilde), p1 -= w1 n dLambda, p2 += w2 n dLambda
+    void solveXpbd(ParticleBuffer& p, double restLength, double compliance, double dt) {
+        int segments = p.size() - 1;
+        lambda.assign(segments, 0.0);
+        double alphaTilde = compliance / (dt * dt);
+
+        for (int i = 0; i < XPBD_ITERATIONS; i++) {
+            for (int j = 0; j < segments; j++) {
+                double w1 = inverseMass(p, j);
+                double w2 = inverseMass(p, j + 1);
+                double denominator = w1 + w2 + alphaTilde;
+                if (w1 + w2 == 0.0) continue;
+
+                double dx = p.x[j+1] - p.x[j];
+                double dy = p.y[j+1] - p.y[j];
+                double distance = sqrt(dx * dx + dy * dy);
+                if (distance < 0.0001) continue;
+                dx /= distance;
+                dy /= distance;
+
+                double c = distance - restLength;
+                double dLambda = (-c - alphaTilde * lambda[j]) / denominator;
+                lambda[j] += dLambda;
+
+                p.x[j] -= w1 * dx * dLambda;
+                p.y[j] -= w1 * dy * dLambda;
+                p.x[j+1] += w2 * dx * dLambda;
+                p.y[j+1] += w2 * dy * dLambda;
+            }
+        }
+    }
+
+    // Direct solve of all chain constraints together. Linearising C around the current positions gives
+    //   (J W J^T + alphaTilde I) dLambda = -C
+    // and for a chain J W J^T is tridiagonal:
+    //   diag_j = w_j + w_{j+1},  offdiag_{j,j+1} = -w_{j+1} (n_j . n_{j+1})
+    // which the Thomas algorithm solves in O(n).
+    void solveTridiagonal(ParticleBuffer& p, double restLength, double compliance, double dt) {
+        int segments = p.size() - 1;
+        nx.resize(segments);
+        ny.resize(segments);
+        error.resize(segments);
+        diag.resize(segments);
+        upper.resize(segments);
+        sweep.resize(segments);
+        rhs.resize(segments);
+        lambda.resize(segments);
+        double alphaTilde = compliance / (dt * dt);
+
+        for (int iteration = 0; iteration < TRIDIAGONAL_ITERATIONS; iteration++) {
+            for (int j = 0; j < segments; j++) {
+                double dx = p.x[j+1] - p.x[j];
+                double dy = p.y[j+1] - p.y[j];
+                double distance = sqrt(dx * dx + dy * dy);
+                if (distance < 0.0001) {
+                    // No direction, the segment takes no part in this step
+                    nx[j] = ny[j] = 0.0;
+                    error[j] = 0.0;
+                } else {
+                    nx[j] = dx / distance;
+                    ny[j] = dy / distance;
+                    error[j] = distance - restLength;
+                }
+            }
+
+            for (int j = 0; j < segments; j++) {
+                double wNext = inverseMass(p, j + 1);
+                double normal = nx[j] * nx[j] + ny[j] * ny[j];  // 1, or 0 for a collapsed segment
+                diag[j] = (inverseMass(p, j) + wNext) * normal + alphaTilde;
+                upper[j] = j + 1 < segments ? -wNext * (nx[j] * nx[j+1] + ny[j] * ny[j+1]) : 0.0;
+                rhs[j] = -error[j];
+            }
+
+            // Thomas algorithm, forward sweep then back substitution (lambda holds the solution).
+            // The matrix is symmetric so the sub-diagonal of row j is upper[j-1].
+            for (int j = 0; j < segments; j++) {
+                if (j > 0) {
+                    double lower = upper[j-1];
+                    diag[j] -= lower * sweep[j-1];
+                    rhs[j] -= lower * rhs[j-1];
+                }
+                if (std::fabs(diag[j]) < 1e-12) {
+                    // Both ends pinned or segment collapsed, nothing to solve here
+                    diag[j] = 1.0;
+                    rhs[j] = 0.0;
+                }
+                sweep[j] = upper[j] / diag[j];
+                rhs[j] /= diag[j];
+            }
+            for (int j = segments - 1; j >= 0; j--) {
+                lambda[j] = rhs[j] - (j + 1 < segments ? sweep[j] * lambda[j+1] : 0.0);
+            }
+
+            // dp = W J^T dLambda
+            int count = p.size();
+            stepX.assign(count, 0.0);
+            stepY.assign(count, 0.0);
+            for (int j = 0; j < segments; j++) {
+                double w1 = inverseMass(p, j);
+                double w2 = inverseMass(p, j + 1);
+                stepX[j] -= w1 * nx[j] * lambda[j];
+                stepY[j] -= w1 * ny[j] * lambda[j];
+                stepX[j+1] += w2 * nx[j] * lambda[j];
+                stepY[j+1] += w2 * ny[j] * lambda[j];
+            }
+
+            // A rope stretched between two pins further apart than its length has no exact solution
+            // and the linearised system is close to singular there, so the step is halved until it
+            // actually reduces the total squared error instead of flinging particles around
+            double before = 0.0;
+            for (int j = 0; j < segments; j++) before += error[j] * error[j];
+            savedX.assign(p.x, p.x + count);
+            savedY.assign(p.y, p.y + count);
+
+            bool improved = false;
+            double scale = 1.0;
+            for (int attempt = 0; attempt < 4 && !improved; attempt++, scale *= 0.5) {
+                for (int i = 0; i < count; i++) {
+                    p.x[i] = savedX[i] + stepX[i] * scale;
+                    p.y[i] = savedY[i] + stepY[i] * scale;
+                }
+                improved = squaredError(p, restLength) <= before;
+            }
+            if (!improved) {
+                for (int i = 0; i < count; i++) {
+                    p.x[i] = savedX[i];
+                    p.y[i] = savedY[i];
+                }
+                break;
+            }
+        }
+    }
+
+    static double squaredError(const ParticleBuffer& p, double restLength) {
+        double total = 0.0;
+        for (int j = 1; j < p.size(); j++) {
+            double dx = p.x[j] - p.x[j-1];
+            double dy = p.y[j] - p.y[j-1];
+            double c = sqrt(dx * dx + dy * dy) - restLength;
+            total += c * c;
+        }
+        return total;
+    }
+};
+
+#endif
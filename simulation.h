@@ -0,0 +1,283 @@
+#ifndef _SIMULATION__H
+#define _SIMULATION__H
+#include <SDL.h>
+#include "asset_loader.h"
+#include "camera.h"
+#include "defs.h"
+#include "graphics.h"
+#include "input_frame.h"
+#include "level_format.h"
+#include "level_loader.h"
+#include "level_streamer.h"
+#include "profiler.h"
+
+// What happened during one step, the game turns these into sounds, headless runs into statistics
+struct SimEvents {
+    int grabPresses;      // grab keys going down (the grab sound plays whether it caught or not)
+    int buttonsPressed;
+    int respawns;
+    bool finished;
+
+    SimEvents() { clear(); }
+
+    void clear() {
+        grabPresses = 0;
+        buttonsPressed = 0;
+        respawns = 0;
+        finished = false;
+    }
+};
+
+// The PLAYING state without rendering or audio: level streaming, the player, moving platforms,
+// the spike wall, buttons and gates, the finish zone and the camera, advanced one fixed step at a
+// time from an InputFrame. The game drives it from the keyboard and draws the result; the headless
+// build drives it from an input stream as fast as the CPU allows.
+//
+// The platform list and grid live in world (Graphics::platforms / platformGrid); its renderer is
+// only used to give new platforms their sprites and may be null.
+class GameSimulation {
+public:
+    Graphics& world;
+    Character& player;
+    Camera camera;
+    LevelDescription level;
+    LevelRules rules;
+    LevelStreamer streamer;
+    MovingObject* spikeWall;    // only levels that declare one have it
+    bool finishLineEnabled;
+
+    GameSimulation(Graphics& w, Character& p, AssetLoader* assetLoader = nullptr)
+        : world(w), player(p), spikeWall(nullptr), finishLineEnabled(true), loader(assetLoader) {}
+
+    ~GameSimulation() {
+        delete spikeWall;
+    }
+
+    GameSimulation(const GameSimulation&) = delete;
+    GameSimulation& operator=(const GameSimulation&) = delete;
+
+    // Read levels/levelN and queue the images the first chunks need; startLevel() once they are in
+    bool loadLevel(int number) {
+        LevelDescription description;
+        if (!LevelLoader::load(number, description)) return false;
+        loadLevel(description);
+        return true;
+    }
+
+    // Same from a level that is already in memory (tools running one level many times)
+    void loadLevel(const LevelDescription& description) {
+        level = description;
+
+        // Player and camera start where the level begins, so the streamer knows which chunks
+        // are needed first
+        player.resetPosition();
+        camera.setLevelWidth(level.width);
+        camera.snapTo(player.x);
+
+        if (loader != nullptr) {
+            for (const std::string& path : LevelLoader::imagePaths(level)) {
+                loader->requestTexture(path.c_str());
+            }
+        }
+        streamer.open(world, level, camera.x, loader);
+    }
+
+    // Rules, spike wall and the chunks around the start, the level is ready to step afterwards
+    void startLevel() {
+        LevelLoader::readRules(level, world.renderer, rules);
+
+        // Reset player position for the new level
+        player.resetPosition();
+        player.reserveQueries(world.platforms.capacity());   // the streamer reserved a slot per object
+
+        // Camera back to the start, limited to this level's width
+        camera.setLevelWidth(rules.width);
+        camera.snapTo(player.x);
+        player.levelWidth = camera.getLevelWidth();
+
+        // Reset finish line state
+        finishLineEnabled = true;
+        player.hasReachedFinish = false;
+        player.showingCongratulations = false;
+        previousInput = InputFrame();
+
+        // A fresh spike wall when the level has one
+        delete spikeWall;
+        spikeWall = nullptr;
+        if (rules.hasSpikeWall) {
+            spikeWall = new MovingObject(rules.spikeWallRect, rules.spikeWallSprite, rules.spikeWallSpeed, 0);
+        }
+
+        // Spawn the chunks around the start
+        streamer.update(world, camera.x, player, loader);
+    }
+
+    // One fixed physics step: grabs, moving platforms, player physics, collisions, the level's rules
+    // and the camera. Everything level specific comes from rules, nothing here checks which level it is.
+    void step(const InputFrame& input, SimEvents& events) {
+        events.clear();
+
+        // Bring the chunks around the camera in and drop the ones left behind, every step so a
+        // respawn far back already stands on its platforms
+        {
+            PROFILE_ZONE(ZONE_CAMERA);
+            streamer.update(world, camera.x, player, loader);
+        }
+
+        // Grab keys: try to catch while held, let go when released
+        handleGrab(input, previousInput, InputFrame::GRAB_LEFT, true, events);
+        handleGrab(input, previousInput, InputFrame::GRAB_RIGHT, false, events);
+        previousInput = input;
+
+        // Check if player fell out of the level
+        if (player.y > SCREEN_HEIGHT + 100 ||
+            player.x < -100 ||
+            player.x > camera.getLevelWidth() + 100) {
+            respawn(events);
+        }
+
+        {
+            PROFILE_ZONE(ZONE_MOVING_PLATFORMS);
+            updateMovingPlatforms();
+        }
+
+        // Update player physics and collisions - only if not showing congratulations
+        if (!player.showingCongratulations) {
+            {
+                PROFILE_ZONE(ZONE_PLAYER_UPDATE);
+                player.update(input);
+            }
+
+            if (spikeWall) {
+                // Update spike wall position
+                spikeWall->update();
+
+                // Keep the wall chasing the player: never more than its width behind the left edge of
+                // the view, and back to that spot once it has crossed the whole screen
+                if (spikeWall->rect.x < camera.x - spikeWall->rect.w || spikeWall->rect.x > camera.x + SCREEN_WIDTH) {
+                    spikeWall->rect.x = static_cast<int>(camera.x) - spikeWall->rect.w;
+                }
+
+                // Collision with spike wall - always reset to the beginning of the level
+                if (touchesPlayer(spikeWall->rect)) {
+                    respawn(events);
+                }
+            }
+
+            // Finish zone, only reachable once the gates are open
+            if (finishLineEnabled && rules.hasFinish && rules.gatesOpen && touchesPlayer(rules.finishRect)) {
+                player.hasReachedFinish = true;
+                player.showingCongratulations = true;
+                player.vx = 0;
+                player.vy = 0;
+
+                // Disable finish line detection to prevent re-triggering
+                finishLineEnabled = false;
+                events.finished = true;
+            }
+
+            // Collide against the live platforms in world space, a spike sends the player back
+            PROFILE_ZONE(ZONE_COLLISION);
+            if (player.handlecollision(world.platforms, world.platformGrid)) {
+                camera.snapTo(player.x);
+                events.respawns++;
+            }
+        }
+
+        // Camera follows the player's world position
+        {
+            PROFILE_ZONE(ZONE_CAMERA);
+            camera.follow(player.x, dt);
+        }
+
+        // Buttons: pressed when touched, once all of them are the gates go away
+        for (Platform& button : world.platforms) {
+            if (button.isInteractive && !button.activated && touchesPlayer(button.rect)) {
+                // Activate the platform (swap textures) immediately
+                button.activate();
+                rules.pressedButtons++;
+                events.buttonsPressed++;
+            }
+        }
+
+        if (!rules.gatesOpen && rules.pressedButtons >= rules.buttonCount) {
+            rules.gatesOpen = true;
+            streamer.openGates(world);
+        }
+    }
+
+private:
+    AssetLoader* loader;        // null when headless
+    InputFrame previousInput;
+
+    // Does the player's bounding box overlap the rect (world space)
+    bool touchesPlayer(const SDL_Rect& rect) const {
+        return player.x + player.radius > rect.x &&
+               player.x - player.radius < rect.x + rect.w &&
+               player.y + player.radius > rect.y &&
+               player.y - player.radius < rect.y + rect.h;
+    }
+
+    // Back to the start of the level: player, camera and spike wall
+    void respawn(SimEvents& events) {
+        player.resetPosition();
+        camera.snapTo(player.x);
+        if (spikeWall) spikeWall->reset();
+        events.respawns++;
+    }
+
+    void handleGrab(const InputFrame& input, const InputFrame& previous, InputFrame::Button button,
+                    bool isLeft, SimEvents& events) {
+        bool held = input.held(button);
+        bool wasHeld = previous.held(button);
+        ropehand& hand = isLeft ? player.leftHand : player.rightHand;
+
+        if (held && !wasHeld) events.grabPresses++;
+        if (held && !hand.isGrabbingObject) {
+            player.grab(isLeft, world.platforms, world.platformGrid);
+        } else if (!held && wasHeld) {
+            player.release(isLeft);
+        }
+    }
+
+    // Moving platforms carry the hands holding them, and the player with them
+    void updateMovingPlatforms() {
+        for (int i = 0; i < static_cast<int>(world.platforms.size()); i++) {
+            Platform& platform = world.platforms[i];
+            if (!platform.isMoving) continue;
+
+            // Store the old position before updating
+            int oldX = platform.rect.x;
+
+            // Update the platform position (and its grid cells)
+            platform.update(1.0f, &world.platformGrid, i);
+
+            // Calculate the actual change in platform position
+            int deltaX = platform.rect.x - oldX;
+
+            // Only process platforms that are either:
+            // 1. Visible on screen, or
+            // 2. Being grabbed by the player
+            bool isInCurrentScreen = camera.isVisible(platform.rect.x, platform.rect.x + platform.rect.w);
+
+            // If platform is on current screen or being grabbed, check for hand interaction
+            if (isInCurrentScreen ||
+                (player.leftHand.isGrabbingObject && player.leftHand.grabbedPlatformIndex == i) ||
+                (player.rightHand.isGrabbingObject && player.rightHand.grabbedPlatformIndex == i)) {
+
+                // Hands on this platform move with it, and the character too (once, when both hold on)
+                if (player.leftHand.isGrabbingObject &&
+                    PlayerPhysics::carryHand(player.leftHand.view(), oldX, platform.rect, deltaX)) {
+                    player.x += deltaX;
+                }
+                if (player.rightHand.isGrabbingObject &&
+                    PlayerPhysics::carryHand(player.rightHand.view(), oldX, platform.rect, deltaX) &&
+                    !player.leftHand.isGrabbingObject) {
+                    player.x += deltaX;
+                }
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,838 @@
+#ifndef _SIMULATIONBATCH__H
+#define _SIMULATIONBATCH__H
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "camera.h"
+#include "defs.h"
+#include "graphics.h"
+#include "input_frame.h"
+#include "level_format.h"
+#include "level_loader.h"
+#include "level_streamer.h"
+#include "particle_buffer.h"
+#include "rope_solver.h"
+#include "simulation.h"
+
+// Many players on one level at once, for tools that need thousands of runs (solvability search,
+// bots). A GameSimulation per run costs a Character with two ropehands (heap buffers, solver
+// scratch, sprites), a Graphics, a LevelStreamer and its own copy of the platforms. Here the level
+// is built once (BatchLevel, read only) and every player is one lane of flat arrays: body state in
+// one array per field, rope particle p of hand h in a run of rope[h] with one lane per instance. All
+// instances step in lockstep; the rope integration and constraint kernels run across instances in
+// SIMD registers, everything else is per instance, and the instances are split over worker threads.
+//
+// The physics is GameSimulation::step's: the scalar player step is PlayerPhysics (graphics.h), the
+// one Character runs, and only the rope kernels are the batch's own (the same operations in the same
+// order as ParticleBuffer::integrate and the Jakobsen solver, so the same bits). What differs is the
+// world: the whole level is resident from the first step (each instance has its own movers, started
+// with it), where the game streams chunks around the camera (a mover restarts when its chunk comes
+// back, and platform order follows spawn order). Platforms
+// are kept in the order the game spawns the first chunks, so while a run stays inside the first
+// load window it is identical to GameSimulation; past that it is a close approximation, and
+// anything a tool finds should be confirmed with a GameSimulation (solvability does, and its
+// --check-batch compares the two step by step inside that window).
+// Only the Jakobsen rope solver (the game's) and the game's player size are supported.
+
+// The level every instance of a batch plays: all platforms at once, and a broad phase grid over
+// the ones that never move. Built once, then only read, by every worker at the same time.
+class BatchLevel {
+public:
+    std::vector<Platform> platforms;    // slots of the game's first chunks, then the rest in level order
+    std::vector<int> objects;           // per platform: its object in the level description
+    int firstWindow;                    // platforms [0, firstWindow) are the game's first chunks, slot for slot
+    std::vector<int> movers;            // indices into platforms, in order
+    std::vector<int> moverOf;           // per platform: its mover number, -1 when it does not move
+    std::vector<int> buttonOf;          // per platform: its button number, -1 when it is not a button
+    std::vector<char> isGate;
+    LevelRules rules;
+    double levelWidth;                  // Camera::getLevelWidth() for the level
+    int buttonCount;
+
+    BatchLevel() : firstWindow(0), levelWidth(SCREEN_WIDTH), buttonCount(0), gridLeft(0), gridTop(0), gridColumns(0), gridRows(0) {}
+
+    void build(const LevelDescription& description) {
+        platforms.clear();
+        objects.clear();
+        movers.clear();
+        moverOf.clear();
+        buttonOf.clear();
+        isGate.clear();
+
+        // Spawn the first chunks the way GameSimulation::loadLevel + startLevel do, to get the slots
+        Graphics scratch;
+        Character player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+        Camera camera;
+        LevelStreamer streamer;
+        player.resetPosition();
+        camera.setLevelWidth(description.width);
+        camera.snapTo(player.x);
+        streamer.open(scratch, description, camera.x, nullptr);
+        LevelLoader::readRules(description, nullptr, rules);
+        camera.setLevelWidth(rules.width);
+        camera.snapTo(player.x);
+        streamer.update(scratch, camera.x, player, nullptr);
+        levelWidth = camera.getLevelWidth();
+
+        std::vector<char> placed(description.objects.size(), 0);
+        std::vector<int> order;
+        for (int slot = 0; slot < static_cast<int>(scratch.platforms.size()); slot++) {
+            int object = streamer.objectInSlot(slot);
+            if (object < 0) continue;
+            order.push_back(object);
+            placed[object] = 1;
+        }
+        firstWindow = static_cast<int>(order.size());
+        for (int object = 0; object < static_cast<int>(description.objects.size()); object++) {
+            LevelObjectType type = description.objects[object].type;
+            bool streamed = type == LEVEL_PLATFORM || type == LEVEL_SPIKE || type == LEVEL_MOVER ||
+                            type == LEVEL_BUTTON || type == LEVEL_GATE;
+            if (streamed && !placed[object]) order.push_back(object);
+        }
+
+        buttonCount = 0;
+        for (int object : order) {
+            const LevelObject& source = description.objects[object];
+            int index = static_cast<int>(platforms.size());
+            platforms.push_back(LevelLoader::makePlatform(source, nullptr));
+            objects.push_back(object);
+            moverOf.push_back(platforms.back().isMoving ? static_cast<int>(movers.size()) : -1);
+            if (platforms.back().isMoving) movers.push_back(index);
+            buttonOf.push_back(source.type == LEVEL_BUTTON ? buttonCount++ : -1);
+            isGate.push_back(source.type == LEVEL_GATE);
+        }
+        buildGrid();
+    }
+
+    int platformCount() const { return static_cast<int>(platforms.size()); }
+
+    // Same cells as PlatformGrid: [left, right] x [top, bottom] floored to CELL_SIZE
+    static void cellRange(double left, double top, double right, double bottom, int& x0, int& y0, int& x1, int& y1) {
+        x0 = static_cast<int>(std::floor(left / PlatformGrid::CELL_SIZE));
+        y0 = static_cast<int>(std::floor(top / PlatformGrid::CELL_SIZE));
+        x1 = static_cast<int>(std::floor(right / PlatformGrid::CELL_SIZE));
+        y1 = static_cast<int>(std::floor(bottom / PlatformGrid::CELL_SIZE));
+    }
+
+    // Static platforms filed in the cells, each reported once per stamp (appended, unsorted)
+    void queryStatic(int x0, int y0, int x1, int y1, std::vector<int>& out, std::vector<uint32_t>& stamps,
+                     uint32_t stamp) const {
+        x0 = std::max(x0, gridLeft);
+        y0 = std::max(y0, gridTop);
+        x1 = std::min(x1, gridLeft + gridColumns - 1);
+        y1 = std::min(y1, gridTop + gridRows - 1);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                int cell = (cy - gridTop) * gridColumns + (cx - gridLeft);
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                    int index = cellItems[k];
+                    if (stamps[index] == stamp) continue;
+                    stamps[index] = stamp;
+                    out.push_back(index);
+                }
+            }
+        }
+    }
+
+private:
+    // Dense grid over the static platforms' cells, items of cell c are cellItems[cellStart[c] .. cellStart[c + 1])
+    int gridLeft, gridTop, gridColumns, gridRows;
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+
+    void buildGrid() {
+        bool any = false;
+        int left = 0, top = 0, right = -1, bottom = -1;
+        for (const Platform& platform : platforms) {
+            if (platform.isMoving) continue;
+            int x0, y0, x1, y1;
+            cellRange(platform.rect.x, platform.rect.y, platform.rect.x + platform.rect.w,
+                      platform.rect.y + platform.rect.h, x0, y0, x1, y1);
+            left = any ? std::min(left, x0) : x0;
+            top = any ? std::min(top, y0) : y0;
+            right = any ? std::max(right, x1) : x1;
+            bottom = any ? std::max(bottom, y1) : y1;
+            any = true;
+        }
+        gridLeft = left;
+        gridTop = top;
+        gridColumns = right - left + 1;
+        gridRows = bottom - top + 1;
+
+        // Count, prefix sum, fill
+        int cells = gridColumns * gridRows;
+        cellStart.assign(cells + 1, 0);
+        for (int pass = 0; pass < 2; pass++) {
+            std::vector<int> fill;
+            if (pass == 1) {
+                for (int c = 0; c < cells; c++) cellStart[c + 1] += cellStart[c];
+                cellItems.assign(cellStart[cells], 0);
+                fill.assign(cellStart.begin(), cellStart.end() - 1);
+            }
+            for (int index = 0; index < platformCount(); index++) {
+                const Platform& platform = platforms[index];
+                if (platform.isMoving) continue;
+                int x0, y0, x1, y1;
+                cellRange(platform.rect.x, platform.rect.y, platform.rect.x + platform.rect.w,
+                          platform.rect.y + platform.rect.h, x0, y0, x1, y1);
+                for (int cy = y0; cy <= y1; cy++) {
+                    for (int cx = x0; cx <= x1; cx++) {
+                        int cell = (cy - gridTop) * gridColumns + (cx - gridLeft);
+                        if (pass == 0) cellStart[cell + 1]++;
+                        else cellItems[fill[cell]++] = index;
+                    }
+                }
+            }
+        }
+    }
+};
+
+class SimulationBatch {
+public:
+    static const int HAND_PARTICLES = PLAYER_HAND_PARTICLES;
+
+    // Per instance, one lane each. Public like Character's fields, tools read them directly.
+    std::vector<InputFrame> input;              // set before step()
+    std::vector<SimEvents> events;              // what happened to each instance in the last step
+    std::vector<double> x, y, vx, vy;
+    std::vector<double> swingEnergy, maxSwingSpeed, facingDirection;
+    std::vector<Camera> cameras;
+    std::vector<int> spikeWallX;
+    std::vector<Uint8> grabbing[2];             // [0] left hand, [1] right hand
+    std::vector<int> grabbedPlatform[2];        // mover being held, -1 otherwise
+    std::vector<Uint8> finished;                // reached the finish (the game shows the congratulations)
+    std::vector<Uint8> gatesOpen;
+    std::vector<int> pressedButtons;
+    std::vector<Uint8> running;                 // cleared by the caller for runs it is done with, restart(i) sets it again
+    ParticleBuffer rope[2];                     // hand h, particle p of instance i at p * laneCount() + i, see hand()
+
+    // threads <= 0: one per CPU
+    SimulationBatch(const BatchLevel& batchLevel, int count, int threads = 0)
+        : level(batchLevel), instances(count), stepCount(0), masks(nullptr),
+          mutex(nullptr), startWork(nullptr), workDone(nullptr), generation(0), pending(0), stopping(false) {
+        input.resize(count);
+        previousInput.resize(count);
+        events.resize(count);
+        x.resize(count);
+        y.resize(count);
+        vx.resize(count);
+        vy.resize(count);
+        swingEnergy.resize(count);
+        maxSwingSpeed.resize(count);
+        facingDirection.resize(count);
+        cameras.resize(count);
+        spikeWallX.resize(count);
+        pressedButtons.resize(count);
+        finished.resize(count);
+        gatesOpen.resize(count);
+        running.resize(count);
+        buttons.resize(static_cast<size_t>(count) * level.buttonCount);
+        // Rope particles and the frozen, active, taut[0], taut[1] masks, padded to whole SIMD registers
+        padded = (count + ParticleBuffer::LANES - 1) / ParticleBuffer::LANES * ParticleBuffer::LANES;
+        for (int h = 0; h < 2; h++) {
+            grabbing[h].resize(count);
+            grabbedPlatform[h].resize(count);
+            rope[h].resize(HAND_PARTICLES * padded);
+        }
+
+        // Rope lengths of the Character the game builds, so the lanes cannot drift from it
+        Character player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, HAND_PARTICLES);
+        maxLength = player.leftHand.maxLength;
+        restLength = player.leftHand.restLength();
+
+        // Every step reads all of them, a batch without its lanes cannot run at all. The rope
+        // buffers throw std::bad_alloc themselves when they cannot grow.
+        masks = static_cast<uint64_t*>(SDL_SIMDAlloc(sizeof(uint64_t) * padded * 4));
+        if (masks == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "SimulationBatch: could not allocate %d instances", count);
+            throw std::bad_alloc();
+        }
+        // Lanes past the last instance are padding, pinned like a ParticleBuffer's own
+        for (int h = 0; h < 2; h++) {
+            for (int p = 0; p < HAND_PARTICLES; p++) {
+                for (int i = count; i < padded; i++) rope[h].setPinned(p * padded + i, true);
+            }
+        }
+
+        // Contiguous ranges starting on a register boundary, the first one runs on the calling thread
+        if (threads <= 0) threads = SDL_GetCPUCount();
+        threads = std::max(1, std::min(threads, (count + ParticleBuffer::LANES - 1) / ParticleBuffer::LANES));
+        int chunk = ((count + threads - 1) / threads + ParticleBuffer::LANES - 1) / ParticleBuffer::LANES *
+                    ParticleBuffer::LANES;
+        for (int first = 0; first < count; first += chunk) {
+            Worker worker;
+            worker.batch = this;
+            worker.first = first;
+            worker.end = std::min(count, first + chunk);
+            worker.thread = nullptr;
+            worker.stamps.assign(level.platformCount(), 0);
+            worker.stamp = 0;
+            workers.push_back(worker);
+        }
+        if (workers.size() > 1) {
+            mutex = SDL_CreateMutex();
+            startWork = SDL_CreateCond();
+            workDone = SDL_CreateCond();
+            for (size_t w = 1; w < workers.size(); w++) {
+                workers[w].thread = SDL_CreateThread(workerMain, "SimulationBatch", &workers[w]);
+            }
+        }
+
+        moverCount = static_cast<int>(level.movers.size());
+        movers.reserve(static_cast<size_t>(count) * moverCount);
+        for (int i = 0; i < count; i++) {
+            for (int index : level.movers) movers.push_back(level.platforms[index]);
+        }
+        reset();
+    }
+
+    ~SimulationBatch() {
+        if (mutex != nullptr) {
+            SDL_LockMutex(mutex);
+            stopping = true;
+            SDL_CondBroadcast(startWork);
+            SDL_UnlockMutex(mutex);
+            for (Worker& worker : workers) {
+                if (worker.thread != nullptr) SDL_WaitThread(worker.thread, nullptr);
+            }
+            SDL_DestroyCond(workDone);
+            SDL_DestroyCond(startWork);
+            SDL_DestroyMutex(mutex);
+        }
+        if (masks != nullptr) SDL_SIMDFree(masks);
+    }
+
+    SimulationBatch(const SimulationBatch&) = delete;
+    SimulationBatch& operator=(const SimulationBatch&) = delete;
+
+    int size() const { return instances; }
+    int threadCount() const { return static_cast<int>(workers.size()); }
+    long steps() const { return stepCount; }
+    int laneCount() const { return padded; }
+
+    // Rope h of instance i
+    RopeView hand(int i, int h) {
+        return RopeView(rope[h], i, padded, HAND_PARTICLES, maxLength);
+    }
+
+    // Instance i's player as PlayerPhysics sees it
+    PlayerBody body(int i) {
+        return PlayerBody{x[i], y[i], vx[i], vy[i], swingEnergy[i], maxSwingSpeed[i], facingDirection[i],
+                          PLAYER_RADIUS,
+                          {hand(i, 0), hand(i, 1)},
+                          {grabbing[0][i] != 0, grabbing[1][i] != 0}};
+    }
+
+    // Platform index as instance i sees it, movers where its own copy is
+    const Platform& platform(int i, int index) const {
+        int m = level.moverOf[index];
+        return m < 0 ? level.platforms[index] : movers[mover(i, m)];
+    }
+
+    bool buttonPressed(int i, int button) const {
+        return buttons[static_cast<size_t>(i) * level.buttonCount + button] != 0;
+    }
+
+    // Every instance at the start of the level (GameSimulation::startLevel)
+    void reset() {
+        stepCount = 0;
+        for (int i = 0; i < instances; i++) restart(i);
+    }
+
+    // Instance i back to the start with a fresh player and its movers at their start, the others
+    // carry on. Tools refill the lane of a run that is over with the next run this way.
+    void restart(int i) {
+        for (int m = 0; m < moverCount; m++) {
+            movers[mover(i, m)] = level.platforms[level.movers[m]];
+        }
+        resetInstance(i);
+    }
+
+    // Advance every running instance by one fixed step with its input[i]
+    void step() {
+        if (mutex != nullptr) {
+            SDL_LockMutex(mutex);
+            generation++;
+            pending = static_cast<int>(workers.size()) - 1;
+            SDL_CondBroadcast(startWork);
+            SDL_UnlockMutex(mutex);
+        }
+        stepRange(workers[0]);
+        if (mutex != nullptr) {
+            SDL_LockMutex(mutex);
+            while (pending > 0) SDL_CondWait(workDone, mutex);
+            SDL_UnlockMutex(mutex);
+        }
+        stepCount++;
+    }
+
+private:
+    struct Worker {
+        SimulationBatch* batch;
+        int first, end;
+        SDL_Thread* thread;
+        std::vector<int> nearby;                // broad phase results, reused
+        std::vector<uint32_t> stamps;
+        uint32_t stamp;
+    };
+
+    const BatchLevel& level;
+    int instances;
+    int padded;
+    long stepCount;
+    double maxLength, restLength;
+    int moverCount;
+    std::vector<Platform> movers;               // each instance's own movers, mover(i, m)
+    std::vector<InputFrame> previousInput;
+    std::vector<Uint8> buttons;                 // instance * buttonCount + button: pressed
+    uint64_t* masks;
+    std::vector<Worker> workers;
+
+    SDL_mutex* mutex;
+    SDL_cond* startWork;
+    SDL_cond* workDone;
+    unsigned generation;
+    int pending;
+    bool stopping;
+
+    int mover(int i, int m) const { return i * moverCount + m; }
+
+    // Particle p of hand h across instances, the arrays the SIMD kernels run along
+    struct Lanes {
+        double* x;
+        double* y;
+        double* px;
+        double* py;
+        uint64_t* pinned;
+
+        bool isPinned(int i) const { return pinned[i] != 0; }
+    };
+
+    Lanes particleLanes(int h, int p) {
+        size_t first = static_cast<size_t>(p) * padded;
+        Lanes lane = {rope[h].x + first, rope[h].y + first, rope[h].px + first, rope[h].py + first,
+                      rope[h].pinned + first};
+        return lane;
+    }
+
+    uint64_t* frozenMask() { return masks; }                    // all ones: no player update this step
+    uint64_t* activeMask() { return masks + padded; }           // the opposite, for the constraint kernel
+    uint64_t* tautMask(int h) { return masks + padded * (2 + h); }
+
+    static int workerMain(void* data) {
+        Worker& worker = *static_cast<Worker*>(data);
+        SimulationBatch& batch = *worker.batch;
+        unsigned seen = 0;
+        for (;;) {
+            SDL_LockMutex(batch.mutex);
+            while (batch.generation == seen && !batch.stopping) SDL_CondWait(batch.startWork, batch.mutex);
+            if (batch.stopping) {
+                SDL_UnlockMutex(batch.mutex);
+                return 0;
+            }
+            seen = batch.generation;
+            SDL_UnlockMutex(batch.mutex);
+
+            batch.stepRange(worker);
+
+            SDL_LockMutex(batch.mutex);
+            if (--batch.pending == 0) SDL_CondSignal(batch.workDone);
+            SDL_UnlockMutex(batch.mutex);
+        }
+    }
+
+    void resetInstance(int i) {
+        facingDirection[i] = 1.0;
+        for (int h = 0; h < 2; h++) {
+            RopeView view = hand(i, h);
+            for (int p = 0; p < HAND_PARTICLES; p++) view.setPinned(p, p == 0);
+        }
+        resetPosition(i);
+        cameras[i] = Camera();
+        cameras[i].setLevelWidth(level.levelWidth);
+        cameras[i].snapTo(x[i]);
+        spikeWallX[i] = level.rules.spikeWallRect.x;
+        finished[i] = 0;
+        gatesOpen[i] = level.rules.gatesOpen;
+        pressedButtons[i] = 0;
+        std::fill(buttons.begin() + static_cast<size_t>(i) * level.buttonCount,
+                  buttons.begin() + static_cast<size_t>(i + 1) * level.buttonCount, 0);
+        input[i] = InputFrame();
+        previousInput[i] = InputFrame();
+        events[i].clear();
+        running[i] = 1;
+    }
+
+    // Character::resetPosition
+    void resetPosition(int i) {
+        releaseHand(i, 0);
+        releaseHand(i, 1);
+        PlayerBody player = body(i);
+        PlayerPhysics::resetBody(player);
+    }
+
+    // ropehand::release
+    void releaseHand(int i, int h) {
+        hand(i, h).setPinned(HAND_PARTICLES - 1, false);
+        grabbing[h][i] = 0;
+        grabbedPlatform[h][i] = -1;
+    }
+
+    // GameSimulation::respawn
+    void respawn(int i) {
+        resetPosition(i);
+        cameras[i].snapTo(x[i]);
+        spikeWallX[i] = level.rules.spikeWallRect.x;
+        events[i].respawns++;
+    }
+
+    bool touches(int i, const SDL_Rect& rect) const {
+        return x[i] + PLAYER_RADIUS > rect.x &&
+               x[i] - PLAYER_RADIUS < rect.x + rect.w &&
+               y[i] + PLAYER_RADIUS > rect.y &&
+               y[i] - PLAYER_RADIUS < rect.y + rect.h;
+    }
+
+    // PlatformGrid::query over the batch's platforms as instance i sees them (gates gone once open)
+    void query(Worker& worker, int i, double left, double top, double right, double bottom) {
+        std::vector<int>& out = worker.nearby;
+        out.clear();
+        if (++worker.stamp == 0) {
+            std::fill(worker.stamps.begin(), worker.stamps.end(), 0);
+            worker.stamp = 1;
+        }
+        int x0, y0, x1, y1;
+        BatchLevel::cellRange(left, top, right, bottom, x0, y0, x1, y1);
+        level.queryStatic(x0, y0, x1, y1, out, worker.stamps, worker.stamp);
+        for (int m = 0; m < moverCount; m++) {
+            const SDL_Rect& rect = movers[mover(i, m)].rect;
+            int mx0, my0, mx1, my1;
+            BatchLevel::cellRange(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, mx0, my0, mx1, my1);
+            if (mx1 >= x0 && mx0 <= x1 && my1 >= y0 && my0 <= y1) out.push_back(level.movers[m]);
+        }
+        if (gatesOpen[i]) {
+            out.erase(std::remove_if(out.begin(), out.end(), [this](int index) { return level.isGate[index] != 0; }),
+                      out.end());
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    void stepRange(Worker& worker) {
+        const int first = worker.first, end = worker.end;
+        const Uint8 GRAB[2] = {InputFrame::GRAB_LEFT, InputFrame::GRAB_RIGHT};
+        uint64_t* frozen = frozenMask();
+        uint64_t* active = activeMask();
+
+        // Grabs, out of the level, moving platforms carrying hands, then who gets a player update
+        for (int i = first; i < end; i++) {
+            events[i].clear();
+            bool updating = false;
+            if (running[i]) {
+                const InputFrame& now = input[i];
+                for (int h = 0; h < 2; h++) handleGrab(worker, i, h, now, GRAB[h]);
+                previousInput[i] = now;
+
+                if (y[i] > SCREEN_HEIGHT + 100 || x[i] < -100 || x[i] > level.levelWidth + 100) respawn(i);
+                carryHands(i);
+
+                // Character::update returns straight after its own out of bounds reset
+                if (!finished[i]) {
+                    if (y[i] > SCREEN_HEIGHT + 500 || y[i] < -500 || x[i] > level.levelWidth + 500 || x[i] < -500) {
+                        resetPosition(i);
+                    } else {
+                        updating = true;
+                        if (now.held(InputFrame::LEFT)) facingDirection[i] = -1.0;
+                        if (now.held(InputFrame::RIGHT)) facingDirection[i] = 1.0;
+                    }
+                }
+            }
+            frozen[i] = updating ? 0 : ~uint64_t(0);
+            active[i] = ~frozen[i];
+            for (int h = 0; h < 2; h++) tautMask(h)[i] = updating && grabbing[h][i] ? ~uint64_t(0) : 0;
+        }
+
+        // ropehand::step for both hands, one register of instances at a time so the whole rope stays
+        // in cache, registers where nobody is updated (finished, stopped runs) are skipped
+        for (int block = first; block < end; block += ParticleBuffer::LANES) {
+            int blockEnd = std::min(end, block + ParticleBuffer::LANES);
+            bool any = false;
+            for (int i = block; i < blockEnd; i++) any = any || !frozen[i];
+            if (!any) continue;
+
+            for (int h = 0; h < 2; h++) {
+                for (int p = 0; p < HAND_PARTICLES; p++) {
+                    Lanes lane = particleLanes(h, p);
+                    ParticleBuffer::integrateLanes(lane.x, lane.y, lane.px, lane.py, lane.pinned, frozen, block,
+                                                   blockEnd, 0.99, 5.0 * dt);
+                }
+                solveRopes(h, block, blockEnd);
+            }
+        }
+
+        for (int i = first; i < end; i++) {
+            if (!running[i]) continue;
+            if (!frozen[i]) updatePlayer(i);
+            if (!finished[i]) {
+                if (level.rules.hasSpikeWall) {
+                    spikeWallX[i] = static_cast<int>(spikeWallX[i] + level.rules.spikeWallSpeed);
+                    const int wallWidth = level.rules.spikeWallRect.w;
+                    if (spikeWallX[i] < cameras[i].x - wallWidth || spikeWallX[i] > cameras[i].x + SCREEN_WIDTH) {
+                        spikeWallX[i] = static_cast<int>(cameras[i].x) - wallWidth;
+                    }
+                    SDL_Rect wall = level.rules.spikeWallRect;
+                    wall.x = spikeWallX[i];
+                    if (touches(i, wall)) respawn(i);
+                }
+
+                if (level.rules.hasFinish && gatesOpen[i] && touches(i, level.rules.finishRect)) {
+                    finished[i] = 1;
+                    vx[i] = 0;
+                    vy[i] = 0;
+                    events[i].finished = true;
+                }
+
+                if (bodyCollision(worker, i)) {
+                    cameras[i].snapTo(x[i]);
+                    events[i].respawns++;
+                }
+            }
+            cameras[i].follow(x[i], dt);
+
+            for (int index = 0; index < level.platformCount(); index++) {
+                int button = level.buttonOf[index];
+                if (button < 0) continue;
+                Uint8& pressed = buttons[static_cast<size_t>(i) * level.buttonCount + button];
+                if (!pressed && touches(i, level.platforms[index].rect)) {
+                    pressed = 1;
+                    pressedButtons[i]++;
+                    events[i].buttonsPressed++;
+                }
+            }
+            if (!gatesOpen[i] && pressedButtons[i] >= level.buttonCount) gatesOpen[i] = 1;
+        }
+    }
+
+    // GameSimulation::handleGrab, Character::grab and Character::release
+    void handleGrab(Worker& worker, int i, int h, const InputFrame& now, Uint8 button) {
+        bool held = (now.buttons & button) != 0;
+        bool wasHeld = (previousInput[i].buttons & button) != 0;
+        if (held && !wasHeld) events[i].grabPresses++;
+        if (held && !grabbing[h][i]) {
+            RopeView view = hand(i, h);
+            double handX = view.handX(), handY = view.handY();
+            query(worker, i, handX, handY, handX, handY);
+            for (int index : worker.nearby) {
+                if (PlayerPhysics::grab(view, platform(i, index).rect)) {
+                    grabbing[h][i] = 1;
+                    if (level.platforms[index].isMoving) grabbedPlatform[h][i] = index;
+                    break;
+                }
+            }
+        } else if (!held && wasHeld) {
+            PlayerBody player = body(i);
+            PlayerPhysics::releaseBoost(player);
+            releaseHand(i, h);
+        }
+    }
+
+    // GameSimulation::updateMovingPlatforms: the instance's movers move and carry the hands on them
+    void carryHands(int i) {
+        for (int m = 0; m < moverCount; m++) {
+            int index = level.movers[m];
+            Platform& moving = movers[mover(i, m)];
+            int oldX = moving.rect.x;
+            moving.update(1.0f);
+            const SDL_Rect& rect = moving.rect;
+            int deltaX = rect.x - oldX;
+            bool held = (grabbing[0][i] && grabbedPlatform[0][i] == index) ||
+                        (grabbing[1][i] && grabbedPlatform[1][i] == index);
+            if (!cameras[i].isVisible(rect.x, rect.x + rect.w) && !held) continue;
+
+            for (int h = 0; h < 2; h++) {
+                if (grabbing[h][i] && PlayerPhysics::carryHand(hand(i, h), oldX, rect, deltaX) &&
+                    (h == 0 || !grabbing[0][i])) {
+                    x[i] += deltaX;
+                }
+            }
+        }
+    }
+
+    // RopeConstraintSolver::solveJakobsen across instances: a lane takes part while its player is
+    // updated, for JAKOBSEN_ITERATIONS when slack and JAKOBSEN_TAUT_ITERATIONS when its hand holds on.
+    // Every lane does the same operations as the scalar solver, a lane that would skip a segment
+    // (too short, both ends pinned) keeps its values through a blend.
+    void solveRopes(int h, int first, int end) {
+        const uint64_t* active = activeMask();
+        const uint64_t* taut = tautMask(h);
+        bool anyTaut = false;
+        for (int i = first; i < end && !anyTaut; i++) anyTaut = taut[i] != 0;
+        const int iterations = anyTaut ? RopeConstraintSolver::JAKOBSEN_TAUT_ITERATIONS
+                                       : RopeConstraintSolver::JAKOBSEN_ITERATIONS;
+
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            const uint64_t* lanes = iteration < RopeConstraintSolver::JAKOBSEN_ITERATIONS ? active : taut;
+            for (int j = 1; j < HAND_PARTICLES; j++) {
+                Lanes a = particleLanes(h, j - 1);
+                Lanes b = particleLanes(h, j);
+                int i = first;
+#if defined(PARTICLE_SIMD_AVX)
+                const __m256d rest = _mm256_set1_pd(restLength);
+                const __m256d minimum = _mm256_set1_pd(0.0001);
+                const __m256d half = _mm256_set1_pd(0.5);
+                const __m256d one = _mm256_set1_pd(1.0);
+                for (; i + 4 <= end; i += 4) {
+                    __m256d lane = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes + i)));
+                    __m256d tight = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i*>(taut + i)));
+                    __m256d pinned1 = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i*>(a.pinned + i)));
+                    __m256d pinned2 = _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i*>(b.pinned + i)));
+                    __m256d x1 = _mm256_load_pd(a.x + i), y1 = _mm256_load_pd(a.y + i);
+                    __m256d x2 = _mm256_load_pd(b.x + i), y2 = _mm256_load_pd(b.y + i);
+
+                    __m256d xDifference = _mm256_sub_pd(x2, x1);
+                    __m256d yDifference = _mm256_sub_pd(y2, y1);
+                    __m256d distance = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(xDifference, xDifference),
+                                                                    _mm256_mul_pd(yDifference, yDifference)));
+                    lane = _mm256_and_pd(lane, _mm256_cmp_pd(distance, minimum, _CMP_NLT_UQ));
+                    __m256d correction = _mm256_or_pd(_mm256_and_pd(tight, one), _mm256_andnot_pd(tight, half));
+                    __m256d distanceError = _mm256_sub_pd(distance, rest);
+                    __m256d xMove = _mm256_mul_pd(_mm256_mul_pd(_mm256_div_pd(xDifference, distance), distanceError), correction);
+                    __m256d yMove = _mm256_mul_pd(_mm256_mul_pd(_mm256_div_pd(yDifference, distance), distanceError), correction);
+
+                    // Only the second end moves, only the first, or both by half
+                    __m256d moveSecond = _mm256_and_pd(lane, _mm256_andnot_pd(pinned2, pinned1));
+                    __m256d moveFirst = _mm256_and_pd(lane, _mm256_andnot_pd(pinned1, pinned2));
+                    __m256d moveBoth = _mm256_andnot_pd(_mm256_or_pd(pinned1, pinned2), lane);
+                    __m256d xHalf = _mm256_mul_pd(xMove, half), yHalf = _mm256_mul_pd(yMove, half);
+
+                    __m256d nx2 = _mm256_or_pd(_mm256_and_pd(moveSecond, _mm256_sub_pd(x2, xMove)),
+                                               _mm256_and_pd(moveBoth, _mm256_sub_pd(x2, xHalf)));
+                    __m256d ny2 = _mm256_or_pd(_mm256_and_pd(moveSecond, _mm256_sub_pd(y2, yMove)),
+                                               _mm256_and_pd(moveBoth, _mm256_sub_pd(y2, yHalf)));
+                    __m256d nx1 = _mm256_or_pd(_mm256_and_pd(moveFirst, _mm256_add_pd(x1, xMove)),
+                                               _mm256_and_pd(moveBoth, _mm256_add_pd(x1, xHalf)));
+                    __m256d ny1 = _mm256_or_pd(_mm256_and_pd(moveFirst, _mm256_add_pd(y1, yMove)),
+                                               _mm256_and_pd(moveBoth, _mm256_add_pd(y1, yHalf)));
+                    __m256d second = _mm256_or_pd(moveSecond, moveBoth);
+                    __m256d firstEnd = _mm256_or_pd(moveFirst, moveBoth);
+                    _mm256_store_pd(b.x + i, _mm256_or_pd(nx2, _mm256_andnot_pd(second, x2)));
+                    _mm256_store_pd(b.y + i, _mm256_or_pd(ny2, _mm256_andnot_pd(second, y2)));
+                    _mm256_store_pd(a.x + i, _mm256_or_pd(nx1, _mm256_andnot_pd(firstEnd, x1)));
+                    _mm256_store_pd(a.y + i, _mm256_or_pd(ny1, _mm256_andnot_pd(firstEnd, y1)));
+                }
+#elif defined(PARTICLE_SIMD_SSE2)
+                const __m128d rest = _mm_set1_pd(restLength);
+                const __m128d minimum = _mm_set1_pd(0.0001);
+                const __m128d half = _mm_set1_pd(0.5);
+                const __m128d one = _mm_set1_pd(1.0);
+                for (; i + 2 <= end; i += 2) {
+                    __m128d lane = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes + i)));
+                    __m128d tight = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(taut + i)));
+                    __m128d pinned1 = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(a.pinned + i)));
+                    __m128d pinned2 = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(b.pinned + i)));
+                    __m128d x1 = _mm_load_pd(a.x + i), y1 = _mm_load_pd(a.y + i);
+                    __m128d x2 = _mm_load_pd(b.x + i), y2 = _mm_load_pd(b.y + i);
+
+                    __m128d xDifference = _mm_sub_pd(x2, x1);
+                    __m128d yDifference = _mm_sub_pd(y2, y1);
+                    __m128d distance = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(xDifference, xDifference),
+                                                              _mm_mul_pd(yDifference, yDifference)));
+                    lane = _mm_and_pd(lane, _mm_cmpnlt_pd(distance, minimum));
+                    __m128d correction = _mm_or_pd(_mm_and_pd(tight, one), _mm_andnot_pd(tight, half));
+                    __m128d distanceError = _mm_sub_pd(distance, rest);
+                    __m128d xMove = _mm_mul_pd(_mm_mul_pd(_mm_div_pd(xDifference, distance), distanceError), correction);
+                    __m128d yMove = _mm_mul_pd(_mm_mul_pd(_mm_div_pd(yDifference, distance), distanceError), correction);
+
+                    __m128d moveSecond = _mm_and_pd(lane, _mm_andnot_pd(pinned2, pinned1));
+                    __m128d moveFirst = _mm_and_pd(lane, _mm_andnot_pd(pinned1, pinned2));
+                    __m128d moveBoth = _mm_andnot_pd(_mm_or_pd(pinned1, pinned2), lane);
+                    __m128d xHalf = _mm_mul_pd(xMove, half), yHalf = _mm_mul_pd(yMove, half);
+
+                    __m128d nx2 = _mm_or_pd(_mm_and_pd(moveSecond, _mm_sub_pd(x2, xMove)),
+                                            _mm_and_pd(moveBoth, _mm_sub_pd(x2, xHalf)));
+                    __m128d ny2 = _mm_or_pd(_mm_and_pd(moveSecond, _mm_sub_pd(y2, yMove)),
+                                            _mm_and_pd(moveBoth, _mm_sub_pd(y2, yHalf)));
+                    __m128d nx1 = _mm_or_pd(_mm_and_pd(moveFirst, _mm_add_pd(x1, xMove)),
+                                            _mm_and_pd(moveBoth, _mm_add_pd(x1, xHalf)));
+                    __m128d ny1 = _mm_or_pd(_mm_and_pd(moveFirst, _mm_add_pd(y1, yMove)),
+                                            _mm_and_pd(moveBoth, _mm_add_pd(y1, yHalf)));
+                    __m128d second = _mm_or_pd(moveSecond, moveBoth);
+                    __m128d firstEnd = _mm_or_pd(moveFirst, moveBoth);
+                    _mm_store_pd(b.x + i, _mm_or_pd(nx2, _mm_andnot_pd(second, x2)));
+                    _mm_store_pd(b.y + i, _mm_or_pd(ny2, _mm_andnot_pd(second, y2)));
+                    _mm_store_pd(a.x + i, _mm_or_pd(nx1, _mm_andnot_pd(firstEnd, x1)));
+                    _mm_store_pd(a.y + i, _mm_or_pd(ny1, _mm_andnot_pd(firstEnd, y1)));
+                }
+#endif
+                // Scalar fallback, the solver's own loop body for one lane
+                for (; i < end; i++) {
+                    if (!lanes[i]) continue;
+                    double correction = taut[i] ? 1.0 : 0.5;
+                    double xDifference = b.x[i] - a.x[i];
+                    double yDifference = b.y[i] - a.y[i];
+                    double distance = sqrt(xDifference * xDifference + yDifference * yDifference);
+                    if (distance < 0.0001) continue;
+
+                    double distanceError = distance - restLength;
+                    double xDirection = xDifference / distance;
+                    double yDirection = yDifference / distance;
+                    bool pinned1 = a.isPinned(i);
+                    bool pinned2 = b.isPinned(i);
+                    if (pinned1 && !pinned2) {
+                        b.x[i] -= xDirection * distanceError * correction;
+                        b.y[i] -= yDirection * distanceError * correction;
+                    } else if (pinned2 && !pinned1) {
+                        a.x[i] += xDirection * distanceError * correction;
+                        a.y[i] += yDirection * distanceError * correction;
+                    } else if (!pinned1 && !pinned2) {
+                        b.x[i] -= xDirection * distanceError * correction * 0.5;
+                        b.y[i] -= yDirection * distanceError * correction * 0.5;
+                        a.x[i] += xDirection * distanceError * correction * 0.5;
+                        a.y[i] += yDirection * distanceError * correction * 0.5;
+                    }
+                }
+            }
+        }
+    }
+
+    // Character::update after the ropes stepped
+    void updatePlayer(int i) {
+        PlayerBody player = body(i);
+        PlayerPhysics::moveBody(player, input[i]);
+    }
+
+    // Character::handlecollision: true when a spike sent the player back to the start
+    bool bodyCollision(Worker& worker, int i) {
+        double reach = 2 * PLAYER_RADIUS;
+        query(worker, i, x[i] - reach, y[i] - reach, x[i] + reach, y[i] + reach);
+        PlayerBody player = body(i);
+        for (int index : worker.nearby) {
+            if (PlayerPhysics::collideBody(player, platform(i, index))) {
+                resetPosition(i);
+                return true;
+            }
+        }
+
+        ropeCollision(worker, i, 0);
+        ropeCollision(worker, i, 1);
+        return false;
+    }
+
+    // ropehand::handlecollision
+    void ropeCollision(Worker& worker, int i, int h) {
+        RopeView view = hand(i, h);
+        double left, top, right, bottom;
+        if (!PlayerPhysics::ropeQueryBox(view, left, top, right, bottom)) return;
+        query(worker, i, left, top, right, bottom);
+
+        for (int p = 0; p < HAND_PARTICLES; p++) {
+            if (view.isPinned(p)) continue;
+            for (int index : worker.nearby) PlayerPhysics::collideParticle(view, p, platform(i, index));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef _SPATIALGRID__H
+#define _SPATIALGRID__H
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid broad phase for the level's platforms. Every platform is listed in each cell its
+// rect touches (right and bottom edges included, the grab test treats them as inside), so a query
+// only has to look at the few cells around the player instead of the whole level.
+// Items are identified by their index in the platform vector; static platforms go in once at level
+// load, moving platforms are re-filed by move() when they cross into other cells. A cell list that
+// empties stays in the map with its capacity, a mover going back and forth reuses it instead of
+// allocating it again every time it comes back.
+class PlatformGrid {
+public:
+    static const int CELL_SIZE = 256;  // about one big platform, a screen is 5 x 3 cells
+
+    PlatformGrid() : queryStamp(0) {}
+
+    void clear() {
+        cells.clear();
+        stamps.clear();
+        queryStamp = 0;
+    }
+
+    // Anything with an SDL_Rect called rect (Platform)
+    template <typename T>
+    void build(const std::vector<T>& items) {
+        clear();
+        for (int i = 0; i < static_cast<int>(items.size()); i++) {
+            insert(i, items[i].rect);
+        }
+    }
+
+    void insert(int index, const SDL_Rect& rect) {
+        if (index >= static_cast<int>(stamps.size())) stamps.resize(index + 1, 0);
+
+        int x0, y0, x1, y1;
+        cellRange(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                cells[key(cx, cy)].push_back(index);
+            }
+        }
+    }
+
+    void remove(int index, const SDL_Rect& rect) {
+        int x0, y0, x1, y1;
+        cellRange(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                auto it = cells.find(key(cx, cy));
+                if (it == cells.end()) continue;
+                std::vector<int>& list = it->second;
+                list.erase(std::remove(list.begin(), list.end(), index), list.end());
+            }
+        }
+    }
+
+    // Room for extra more indices in every cell of the area, so platforms moving into it later
+    // (a mover along its path) do not allocate the cell lists while the level is being played
+    void reserve(const SDL_Rect& area, int extra) {
+        int x0, y0, x1, y1;
+        cellRange(area.x, area.y, area.x + area.w, area.y + area.h, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                std::vector<int>& list = cells[key(cx, cy)];
+                list.reserve(list.size() + extra);
+            }
+        }
+    }
+
+    // Platform index moved from one rect to another, nothing to do while it stays in the same cells
+    void move(int index, const SDL_Rect& from, const SDL_Rect& to) {
+        int ax0, ay0, ax1, ay1, bx0, by0, bx1, by1;
+        cellRange(from.x, from.y, from.x + from.w, from.y + from.h, ax0, ay0, ax1, ay1);
+        cellRange(to.x, to.y, to.x + to.w, to.y + to.h, bx0, by0, bx1, by1);
+        if (ax0 == bx0 && ay0 == by0 && ax1 == bx1 && ay1 == by1) return;
+        remove(index, from);
+        insert(index, to);
+    }
+
+    // Indices of every platform sharing a cell with the area, each once and in ascending order so
+    // callers visit them in the same order as a loop over the whole vector would.
+    // out is any vector of int, the renderer passes one from the frame arena.
+    template <typename IndexList>
+    void query(double left, double top, double right, double bottom, IndexList& out) const {
+        out.clear();
+        if (++queryStamp == 0) {
+            // Wrapped around, old stamps could match again
+            std::fill(stamps.begin(), stamps.end(), 0);
+            queryStamp = 1;
+        }
+
+        int x0, y0, x1, y1;
+        cellRange(left, top, right, bottom, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                auto it = cells.find(key(cx, cy));
+                if (it == cells.end()) continue;
+                for (int index : it->second) {
+                    if (stamps[index] == queryStamp) continue;
+                    stamps[index] = queryStamp;
+                    out.push_back(index);
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    template <typename IndexList>
+    void queryPoint(double x, double y, IndexList& out) const {
+        query(x, y, x, y, out);
+    }
+
+    int cellCount() const { return static_cast<int>(cells.size()); }
+
+private:
+    std::unordered_map<int64_t, std::vector<int>> cells;
+    // Last query that returned each index, so a platform spanning several cells is reported once
+    mutable std::vector<uint32_t> stamps;
+    mutable uint32_t queryStamp;
+
+    static int64_t key(int cx, int cy) {
+        return (static_cast<int64_t>(cx) << 32) ^ static_cast<uint32_t>(cy);
+    }
+
+    // Cells covering [left, right] x [top, bottom], floor so negative coordinates (the spike wall
+    // starts at -200, a hidden platform sits at -1000) land in their own cells
+    static void cellRange(double left, double top, double right, double bottom,
+                          int& x0, int& y0, int& x1, int& y1) {
+        x0 = static_cast<int>(std::floor(left / CELL_SIZE));
+        y0 = static_cast<int>(std::floor(top / CELL_SIZE));
+        x1 = static_cast<int>(std::floor(right / CELL_SIZE));
+        y1 = static_cast<int>(std::floor(bottom / CELL_SIZE));
+    }
+};
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef _TEXTUREATLAS__H
+#define _TEXTUREATLAS__H
+#include <SDL.h>
+#include <SDL_image.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "asset_archive.h"
+#include "texture_cache.h"
+
+// A drawable image: either a whole texture or a sub-rectangle of an atlas page
+struct Sprite {
+    TextureHandle texture;
+    SDL_Rect src;
+
+    Sprite() : src{0, 0, 0, 0} {}
+    Sprite(TextureHandle t, SDL_Rect r) : texture(t), src(r) {}
+
+    explicit operator bool() const { return texture != nullptr; }
+};
+
+inline void renderSprite(SDL_Renderer* renderer, const Sprite& sprite, const SDL_Rect* dest) {
+    if (sprite) SDL_RenderCopy(renderer, sprite.texture.get(), &sprite.src, dest);
+}
+
+inline void renderSpriteEx(SDL_Renderer* renderer, const Sprite& sprite, const SDL_Rect* dest,
+                           double angle, const SDL_Point* center) {
+    if (sprite) SDL_RenderCopyEx(renderer, sprite.texture.get(), &sprite.src, dest, angle, center, SDL_FLIP_NONE);
+}
+
+// Load-time atlas: the small sprites (platforms, hands, menu buttons...) are decoded once at startup
+// and shelf-packed into a few large pages, so consecutive draws share a texture and SDL's render
+// batching does not have to flush on every texture switch.
+class TextureAtlas {
+public:
+    static const int PADDING = 2;  // transparent gap so linear filtering does not bleed between sprites
+
+    static void build(SDL_Renderer* renderer, const std::vector<const char*>& names) {
+        if (renderer == nullptr) return;
+
+        int pageSize = 2048;
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0) {
+            pageSize = std::min(pageSize, std::min(info.max_texture_width, info.max_texture_height));
+        }
+
+        // Decode everything first, packing needs all the sizes
+        std::vector<Pending> pending;
+        for (const char* name : names) {
+            if (regions().count(name)) continue;
+
+            SDL_RWops* rw = AssetArchive::openRW(name);
+            SDL_Surface* loaded = rw ? IMG_Load_RW(rw, 1) : nullptr;
+            if (loaded == nullptr) {
+                SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                               "Atlas: could not load %s: %s", name, IMG_GetError());
+                continue;
+            }
+            SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+            SDL_FreeSurface(loaded);
+            if (surface == nullptr) continue;
+
+            if (surface->w + PADDING > pageSize || surface->h + PADDING > pageSize) {
+                // Too big to share a page, it stays a standalone texture
+                SDL_FreeSurface(surface);
+                continue;
+            }
+
+            Pending p;
+            p.name = name;
+            p.surface = surface;
+            pending.push_back(p);
+        }
+
+        // Shelf packing, tallest first so every shelf wastes little height
+        std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+            return a.surface->h > b.surface->h;
+        });
+
+        std::vector<int> pageHeights;
+        int page = -1, shelfX = 0, shelfY = 0, shelfHeight = 0;
+        for (Pending& p : pending) {
+            int w = p.surface->w + PADDING;
+            int h = p.surface->h + PADDING;
+            if (page < 0 || shelfX + w > pageSize) {
+                // Next shelf
+                shelfY += shelfHeight;
+                shelfX = 0;
+                shelfHeight = 0;
+                if (page < 0 || shelfY + h > pageSize) {
+                    page++;
+                    pageHeights.push_back(0);
+                    shelfY = 0;
+                }
+            }
+            p.page = page;
+            p.rect = {shelfX, shelfY, p.surface->w, p.surface->h};
+            shelfX += w;
+            shelfHeight = std::max(shelfHeight, h);
+            pageHeights[page] = std::max(pageHeights[page], shelfY + h);
+        }
+
+        // Blit into page surfaces (only as tall as needed) and upload each page once
+        for (int i = 0; i < static_cast<int>(pageHeights.size()); i++) {
+            SDL_Surface* pageSurface = SDL_CreateRGBSurfaceWithFormat(0, pageSize, pageHeights[i], 32,
+                                                                      SDL_PIXELFORMAT_ARGB8888);
+            if (pageSurface == nullptr) continue;
+
+            for (Pending& p : pending) {
+                if (p.page != i) continue;
+                SDL_Rect dest = p.rect;
+                SDL_SetSurfaceBlendMode(p.surface, SDL_BLENDMODE_NONE);  // copy alpha as is
+                SDL_BlitSurface(p.surface, NULL, pageSurface, &dest);
+            }
+
+            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, pageSurface);
+            SDL_FreeSurface(pageSurface);
+            if (texture == nullptr) continue;
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+            std::string pageName = "atlas#" + std::to_string(pages().size());
+            TextureHandle handle = TextureCache::adopt(pageName, texture);
+            pages().push_back(handle);
+
+            for (Pending& p : pending) {
+                if (p.page == i) regions()[p.name] = Sprite(handle, p.rect);
+            }
+        }
+
+        for (Pending& p : pending) SDL_FreeSurface(p.surface);
+
+        SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+                       "Atlas: packed %d sprites into %d pages", static_cast<int>(pending.size()),
+                       static_cast<int>(pageHeights.size()));
+    }
+
+    static bool contains(const char* name) {
+        return regions().count(name) != 0;
+    }
+
+    // Atlas region for this asset, or the whole standalone texture from the cache
+    static Sprite sprite(SDL_Renderer* renderer, const char* name) {
+        auto it = regions().find(name);
+        if (it != regions().end()) return it->second;
+
+        TextureHandle texture = TextureCache::load(renderer, name);
+        if (!texture) return Sprite();
+
+        int w = 0, h = 0;
+        SDL_QueryTexture(texture.get(), NULL, NULL, &w, &h);
+        return Sprite(texture, {0, 0, w, h});
+    }
+
+    static int pageCount() {
+        return static_cast<int>(pages().size());
+    }
+
+private:
+    struct Pending {
+        std::string name;
+        SDL_Surface* surface;
+        int page;
+        SDL_Rect rect;
+    };
+
+    static std::unordered_map<std::string, Sprite>& regions() {
+        static std::unordered_map<std::string, Sprite> map;
+        return map;
+    }
+
+    // The atlas keeps its pages alive for the whole session
+    static std::vector<TextureHandle>& pages() {
+        static std::vector<TextureHandle> list;
+        return list;
+    }
+};
+
+#endif
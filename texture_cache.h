@@ -0,0 +1,133 @@
+#ifndef _TEXTURECACHE__H
+#define _TEXTURECACHE__H
+#include <SDL.h>
+#include <SDL_image.h>
+#include "asset_archive.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Shared handle to a cached texture, the texture is destroyed when the last handle is dropped
+typedef std::shared_ptr<SDL_Texture> TextureHandle;
+
+// Central texture cache keyed by asset name ("graphic/poll.png"), moi file anh chi load 1 lan
+// The cache only keeps weak references, so whoever holds a handle keeps the texture alive
+class TextureCache {
+public:
+    static TextureHandle load(SDL_Renderer* renderer, const char* path) {
+        if (renderer == nullptr || path == nullptr) return TextureHandle();
+
+        std::string key(path);
+        TextureHandle cached = find(key);
+        if (cached) return cached;
+
+        SDL_Texture* texture = nullptr;
+        SDL_RWops* rw = AssetArchive::openRW(path);
+        if (rw != nullptr) {
+            texture = IMG_LoadTexture_RW(renderer, rw, 1);
+        }
+        if (texture == nullptr) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "Could not load texture %s: %s", path, IMG_GetError());
+            return TextureHandle();
+        }
+        return adopt(key, texture);
+    }
+
+    // Same as load, but the image is scaled to width x height on the CPU before upload
+    // (used for the character sprite which has to match its collision size)
+    static TextureHandle loadScaled(SDL_Renderer* renderer, const char* path, int width, int height) {
+        if (renderer == nullptr || path == nullptr) return TextureHandle();
+
+        std::string key = std::string(path) + "@" + std::to_string(width) + "x" + std::to_string(height);
+        TextureHandle cached = find(key);
+        if (cached) return cached;
+
+        SDL_RWops* rw = AssetArchive::openRW(path);
+        SDL_Surface* originalSurface = rw ? IMG_Load_RW(rw, 1) : nullptr;
+        if (!originalSurface) {
+            SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR,
+                           "Could not load image %s: %s", path, IMG_GetError());
+            return TextureHandle();
+        }
+
+        SDL_Surface* scaledSurface = SDL_CreateRGBSurface(0, width, height, 32,
+            0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+        if (!scaledSurface) {
+            SDL_FreeSurface(originalSurface);
+            return TextureHandle();
+        }
+
+        SDL_BlitScaled(originalSurface, NULL, scaledSurface, NULL);
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, scaledSurface);
+
+        SDL_FreeSurface(originalSurface);
+        SDL_FreeSurface(scaledSurface);
+
+        if (texture == nullptr) return TextureHandle();
+        return adopt(key, texture);
+    }
+
+    // Already loaded texture for this name, empty handle if nobody holds it right now
+    static TextureHandle get(const char* path) {
+        return find(path);
+    }
+
+    // Upload a surface decoded elsewhere (AssetLoader worker) and register it under its asset name
+    static TextureHandle adoptSurface(SDL_Renderer* renderer, const char* path, SDL_Surface* surface) {
+        std::string key(path);
+        TextureHandle cached = find(key);
+        if (cached) return cached;
+
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        if (texture == nullptr) return TextureHandle();
+        return adopt(key, texture);
+    }
+
+    // Register a texture created elsewhere (atlas pages), the handle takes ownership
+    static TextureHandle adopt(const std::string& key, SDL_Texture* texture) {
+        TextureHandle handle(texture, destroy);
+        entries()[key] = handle;
+        return handle;
+    }
+
+    // Call right before the renderer is destroyed, SDL_DestroyRenderer frees every texture it owns
+    // so handles that are still held by globals or stack objects must not destroy them again
+    static void shutdown() {
+        rendererGone() = true;
+        entries().clear();
+    }
+
+    // Number of textures currently alive (held by at least one handle)
+    static size_t liveCount() {
+        size_t count = 0;
+        for (const auto& entry : entries()) {
+            if (!entry.second.expired()) count++;
+        }
+        return count;
+    }
+
+private:
+    static std::unordered_map<std::string, std::weak_ptr<SDL_Texture>>& entries() {
+        static std::unordered_map<std::string, std::weak_ptr<SDL_Texture>> cache;
+        return cache;
+    }
+
+    static bool& rendererGone() {
+        static bool gone = false;
+        return gone;
+    }
+
+    static void destroy(SDL_Texture* texture) {
+        if (!rendererGone()) SDL_DestroyTexture(texture);
+    }
+
+    static TextureHandle find(const std::string& key) {
+        auto it = entries().find(key);
+        if (it == entries().end()) return TextureHandle();
+        return it->second.lock();  // empty if the last user already released it
+    }
+
+};
+
+#endif
@@ -0,0 +1,130 @@
+// Offline packer for assets.pak, bundles the graphic/, sounds/ and levels/ trees into one indexed archive
+// usage: assetpack <output.pak> [game folder] [subfolder...]
+//   default game folder is ".", default subfolders are graphic, sounds and levels
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../asset_format.h"
+
+namespace fs = std::filesystem;
+
+struct PackInput {
+    std::string name;   // path relative to the game folder with '/' separators
+    fs::path source;
+    uint64_t size;
+};
+
+static void writeZeros(std::ofstream& out, uint64_t count) {
+    static const char zeros[PACK_DATA_ALIGN] = {};
+    while (count > 0) {
+        uint64_t n = std::min<uint64_t>(count, sizeof(zeros));
+        out.write(zeros, n);
+        count -= n;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <output.pak> [game folder] [subfolder...]\n", argv[0]);
+        return 1;
+    }
+
+    fs::path output = argv[1];
+    fs::path root = argc > 2 ? argv[2] : ".";
+    std::vector<std::string> folders;
+    for (int i = 3; i < argc; i++) folders.push_back(argv[i]);
+    if (folders.empty()) {
+        folders.push_back("graphic");
+        folders.push_back("sounds");
+        folders.push_back("levels");
+    }
+
+    // Collect every file below the requested folders
+    std::vector<PackInput> inputs;
+    for (const std::string& folder : folders) {
+        fs::path dir = root / folder;
+        if (!fs::is_directory(dir)) {
+            fprintf(stderr, "skipping %s: not a directory\n", dir.string().c_str());
+            continue;
+        }
+        for (const auto& item : fs::recursive_directory_iterator(dir)) {
+            if (!item.is_regular_file()) continue;
+            PackInput input;
+            input.name = fs::relative(item.path(), root).generic_string();
+            input.source = item.path();
+            input.size = item.file_size();
+            inputs.push_back(input);
+        }
+    }
+
+    if (inputs.empty()) {
+        fprintf(stderr, "no files to pack\n");
+        return 1;
+    }
+
+    // The loader binary searches the index, so entries are sorted by byte order of the name
+    std::sort(inputs.begin(), inputs.end(), [](const PackInput& a, const PackInput& b) {
+        return a.name < b.name;
+    });
+
+    PackHeader header;
+    memcpy(header.magic, PACK_MAGIC, 4);
+    header.version = PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(inputs.size());
+
+    std::string names;
+    std::vector<PackEntry> entries(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        entries[i].nameOffset = static_cast<uint32_t>(names.size());
+        entries[i].nameLength = static_cast<uint32_t>(inputs[i].name.size());
+        names += inputs[i].name;
+    }
+    header.namesSize = static_cast<uint32_t>(names.size());
+
+    // Lay out the data section, every file aligned
+    uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry) + names.size();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        offset = (offset + PACK_DATA_ALIGN - 1) / PACK_DATA_ALIGN * PACK_DATA_ALIGN;
+        entries[i].dataOffset = offset;
+        entries[i].dataSize = inputs[i].size;
+        offset += inputs[i].size;
+    }
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        fprintf(stderr, "cannot write %s\n", output.string().c_str());
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PackEntry));
+    out.write(names.data(), names.size());
+
+    uint64_t written = sizeof(PackHeader) + entries.size() * sizeof(PackEntry) + names.size();
+    std::vector<char> buffer;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        writeZeros(out, entries[i].dataOffset - written);
+        written = entries[i].dataOffset;
+
+        std::ifstream in(inputs[i].source, std::ios::binary);
+        buffer.resize(static_cast<size_t>(inputs[i].size));
+        if (!in.read(buffer.data(), buffer.size())) {
+            fprintf(stderr, "cannot read %s\n", inputs[i].source.string().c_str());
+            return 1;
+        }
+        out.write(buffer.data(), buffer.size());
+        written += inputs[i].size;
+    }
+
+    if (!out) {
+        fprintf(stderr, "write to %s failed\n", output.string().c_str());
+        return 1;
+    }
+
+    printf("packed %zu files (%llu bytes) into %s\n", inputs.size(),
+           static_cast<unsigned long long>(written), output.string().c_str());
+    return 0;
+}
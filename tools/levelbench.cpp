@@ -0,0 +1,160 @@
+// Whole-level throughput: plays recorded runs through the full GameSimulation step (streaming,
+// moving platforms, spike wall, buttons and gates, collisions) with nothing drawn, and reports how
+// long the steps take and how much they allocate.
+// usage: levelbench [--runs n] [replay.sgr...]
+//   without replays it plays replays/level1.sgr .. replays/level5.sgr from the game folder
+//
+// The fixtures are finishing runs found by solvability <level> --save replays/levelN.sgr, so every
+// level's logic (level 3's spike wall, level 5's buttons and gates, the finish) is played through.
+// Game_headless --record, or levelN_best.sgr from the game's user folder, work as well. A replay
+// recorded before a physics change still plays (the inputs are the same) but no longer matches its
+// checkpoints, which is reported next to its timings.
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "../heap_check.h"
+#include "../replay.h"
+#include "../simulation.h"
+
+// Every C++ allocation goes through here, the counts only matter while steps run. Out of line like
+// the game's replacements (heap_check.h).
+static size_t allocationCount = 0;
+static size_t allocationBytes = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    allocationBytes += size;
+    void* block = malloc(size ? size : 1);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+
+HEAP_NOINLINE void operator delete(void* block) noexcept {
+    free(block);
+}
+
+HEAP_NOINLINE void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+struct LevelBenchResult {
+    int level;
+    long steps;
+    double seconds;
+    double p50, p99, worst;     // microseconds per step
+    size_t allocations, bytes;
+    int respawns, buttons;
+    bool finished;
+    uint32_t divergedAt;        // 0 = matched the recording
+};
+
+// Percentile of sorted step times, in microseconds
+static double percentile(const std::vector<double>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index] * 1e6;
+}
+
+static bool benchReplay(const ReplayLog& log, int runs, LevelBenchResult& result) {
+    result = LevelBenchResult();
+    result.level = log.level;
+    std::vector<double> stepTimes;
+    stepTimes.reserve(static_cast<size_t>(log.steps) * runs);
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+
+    for (int run = 0; run < runs; run++) {
+        // Fresh level every run, loading is not part of the measurement
+        Graphics world;
+        Character player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+        GameSimulation sim(world, player);
+        if (!sim.loadLevel(log.level)) return false;
+        sim.startLevel();
+
+        ReplayPlayer replay(log);
+        InputFrame input;
+        SimEvents events;
+        size_t allocationsBefore = allocationCount, bytesBefore = allocationBytes;
+        while (replay.next(input)) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            sim.step(input, events);
+            stepTimes.push_back((SDL_GetPerformanceCounter() - start) / frequency);
+
+            // Checked outside the timed part, hashing is not free
+            replay.check(sim);
+            if (run == 0) {
+                result.respawns += events.respawns;
+                result.buttons += events.buttonsPressed;
+                result.finished = result.finished || events.finished;
+            }
+        }
+        result.allocations += allocationCount - allocationsBefore;
+        result.bytes += allocationBytes - bytesBefore;
+        if (run == 0) result.divergedAt = replay.firstDivergence();
+    }
+
+    result.steps = static_cast<long>(stepTimes.size());
+    for (double t : stepTimes) result.seconds += t;
+    std::sort(stepTimes.begin(), stepTimes.end());
+    if (!stepTimes.empty()) {
+        result.p50 = percentile(stepTimes, 0.50);
+        result.p99 = percentile(stepTimes, 0.99);
+        result.worst = stepTimes.back() * 1e6;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 3;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, atoi(argv[++i]));
+        } else if (arg.compare(0, 2, "--") == 0) {
+            fprintf(stderr, "usage: %s [--runs n] [replay.sgr...]\n", argv[0]);
+            return 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        for (int level = 1; level <= 5; level++) {
+            paths.push_back("replays/level" + std::to_string(level) + ".sgr");
+        }
+    }
+
+    SDL_SetMainReady();
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    printf("%-24s %5s %8s %12s %9s %9s %9s %10s %10s  %s\n", "replay", "level", "steps", "steps/s",
+           "p50 us", "p99 us", "max us", "allocs/st", "bytes/st", "events");
+    int failures = 0;
+    for (const std::string& path : paths) {
+        ReplayLog log;
+        LevelBenchResult result;
+        if (!log.load(path) || !benchReplay(log, runs, result) || result.steps == 0) {
+            fprintf(stderr, "%s: cannot play\n", path.c_str());
+            failures++;
+            continue;
+        }
+
+        std::string name = path.size() > 24 ? "..." + path.substr(path.size() - 21) : path;
+        printf("%-24s %5d %8ld %12.0f %9.2f %9.2f %9.2f %10.3f %10.1f  %d respawns, %d buttons",
+               name.c_str(), result.level, result.steps, result.steps / result.seconds, result.p50, result.p99,
+               result.worst, result.allocations / static_cast<double>(result.steps),
+               result.bytes / static_cast<double>(result.steps), result.respawns, result.buttons);
+        if (result.finished) printf(", finished");
+        if (result.divergedAt != 0) printf(", differs from the recording from step %u", result.divergedAt);
+        printf("\n");
+    }
+
+    SDL_Quit();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+// Offline level compiler, turns the text levels/*.lvl into the binary .lvb the game prefers
+// usage: levelc <input.lvl> [output.lvb]
+//        levelc <folder>          compiles every .lvl in the folder next to itself
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../level_format.h"
+
+namespace fs = std::filesystem;
+
+static bool compile(const fs::path& input, const fs::path& output) {
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", input.string().c_str());
+        return false;
+    }
+    std::vector<char> text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    LevelDescription level;
+    std::string error;
+    if (!LevelFormat::parseText(text.data(), text.size(), level, error)) {
+        fprintf(stderr, "%s: %s\n", input.string().c_str(), error.c_str());
+        return false;
+    }
+
+    std::vector<char> data;
+    LevelFormat::writeBinary(level, data);
+    std::ofstream out(output, std::ios::binary);
+    if (!out.write(data.data(), data.size())) {
+        fprintf(stderr, "cannot write %s\n", output.string().c_str());
+        return false;
+    }
+    printf("%s -> %s, %zu objects, %zu bytes\n", input.string().c_str(), output.string().c_str(),
+           level.objects.size(), data.size());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <input.lvl> [output.lvb]\n       %s <folder>\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    fs::path input = argv[1];
+    if (!fs::is_directory(input)) {
+        fs::path output = argc > 2 ? fs::path(argv[2]) : fs::path(input).replace_extension(".lvb");
+        return compile(input, output) ? 0 : 1;
+    }
+
+    int failed = 0;
+    for (const auto& item : fs::directory_iterator(input)) {
+        if (!item.is_regular_file() || item.path().extension() != ".lvl") continue;
+        if (!compile(item.path(), fs::path(item.path()).replace_extension(".lvb"))) failed++;
+    }
+    return failed == 0 ? 0 : 1;
+}
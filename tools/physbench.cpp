@@ -0,0 +1,375 @@
+// Micro benchmarks for the physics kernels: rope steps, swing forces, body and rope collisions and
+// grab queries, each timed on its own outside the game loop.
+// usage: physbench [--filter text] [--min-time seconds] [--repetitions n] [--json out.json, - for stdout]
+//
+// The JSON follows Google Benchmark's layout (context + benchmarks[] with name, iterations,
+// real_time, cpu_time, time_unit), so its compare.py can diff two builds:
+//   compare.py benchmarks old.json new.json
+// Every run is deterministic (fixed platform layouts, no rand), only the timings change.
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../graphics.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+// Results are added here so the compiler cannot drop the work being timed
+static volatile double sink;
+
+typedef std::function<void(long iterations)> BenchBody;
+
+struct BenchCase {
+    std::string name;
+    std::function<BenchBody()> setup;   // builds the state, only called when the case runs
+};
+
+struct BenchResult {
+    std::string name;
+    long iterations;
+    double nsPerIteration;  // median of the repetitions
+    double cpuNsPerIteration;   // process CPU time, median of the repetitions
+    double minNs, maxNs;
+};
+
+static double seconds(Uint64 from, Uint64 to) {
+    return (to - from) / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+// CPU time the process used so far. clock() is wall time on Windows, so it asks the OS there.
+static double cpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 1e-7;   // 100 ns units
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+static double timeBody(const BenchBody& body, long iterations, double* cpu = nullptr) {
+    double cpuStart = cpuSeconds();
+    Uint64 start = SDL_GetPerformanceCounter();
+    body(iterations);
+    double elapsed = seconds(start, SDL_GetPerformanceCounter());
+    if (cpu != nullptr) *cpu = cpuSeconds() - cpuStart;
+    return elapsed;
+}
+
+static BenchResult runCase(const BenchCase& bench, double minTime, int repetitions) {
+    BenchBody body = bench.setup();
+
+    // Grow the iteration count until one repetition takes at least minTime
+    long iterations = 1;
+    for (;;) {
+        double elapsed = timeBody(body, iterations);
+        if (elapsed >= minTime || iterations >= 1000000000L) break;
+        double scale = elapsed > 0 ? minTime * 1.4 / elapsed : 100.0;
+        iterations = static_cast<long>(iterations * std::min(100.0, std::max(2.0, scale)));
+    }
+
+    std::vector<double> times, cpuTimes;
+    for (int i = 0; i < repetitions; i++) {
+        double cpu = 0;
+        times.push_back(timeBody(body, iterations, &cpu) * 1e9 / iterations);
+        cpuTimes.push_back(cpu * 1e9 / iterations);
+    }
+    std::sort(times.begin(), times.end());
+    std::sort(cpuTimes.begin(), cpuTimes.end());
+
+    BenchResult result;
+    result.name = bench.name;
+    result.iterations = iterations;
+    result.nsPerIteration = times[times.size() / 2];
+    result.cpuNsPerIteration = cpuTimes[cpuTimes.size() / 2];
+    result.minNs = times.front();
+    result.maxNs = times.back();
+    return result;
+}
+
+// Level-like platform layout: rows of 200 x 30 platforms every 400 pixels, four rows between
+// y = 300 and y = 1050, as wide as it takes to hold count platforms
+struct PlatformField {
+    std::vector<Platform> platforms;
+    PlatformGrid grid;
+
+    explicit PlatformField(int count) {
+        platforms.reserve(count);
+        for (int i = 0; i < count; i++) {
+            SDL_Rect rect = {(i / 4) * 400, 300 + (i % 4) * 250, 200, 30};
+            platforms.push_back(Platform(rect, Sprite()));
+        }
+        grid.build(platforms);
+    }
+
+    // Spot on top of platform i, a little sunk in so the collision has something to resolve
+    SDL_Point landing(int i, int radius) const {
+        const SDL_Rect& rect = platforms[i % platforms.size()].rect;
+        return {rect.x + rect.w / 2, rect.y - radius + 5};
+    }
+};
+
+static const char* solverName(RopeSolver solver) {
+    switch (solver) {
+        case ROPE_SOLVER_XPBD: return "xpbd";
+        case ROPE_SOLVER_TRIDIAGONAL: return "tridiagonal";
+        default: return "jakobsen";
+    }
+}
+
+static void addRopeCases(std::vector<BenchCase>& cases) {
+    const RopeSolver solvers[] = {ROPE_SOLVER_JAKOBSEN, ROPE_SOLVER_XPBD, ROPE_SOLVER_TRIDIAGONAL};
+    const int sizes[] = {10, 50, 200, 1000};
+    for (RopeSolver solver : solvers) {
+        for (int particles : sizes) {
+            for (int taut = 0; taut < 2; taut++) {
+                BenchCase bench;
+                bench.name = std::string("rope_step/") + solverName(solver) + (taut ? "/grabbing/" : "/free/") +
+                             std::to_string(particles);
+                bench.setup = [solver, particles, taut]() -> BenchBody {
+                    // 3.5 pixels between particles like the game's 35 pixel, 10 particle rope, hanging to the right
+                    std::shared_ptr<ropehand> hand = std::make_shared<ropehand>(
+                        nullptr, 500.0, 500.0 + 3.5 * particles, 300.0, 300.0, particles, false, solver);
+                    if (taut) hand->grab(hand->handX(), hand->handY());
+                    return [hand](long iterations) {
+                        for (long i = 0; i < iterations; i++) {
+                            // Keep the body end moving so the rope never settles
+                            hand->attachtothebody(500.0 + (i & 63), 300.0, 6.0, false);
+                            hand->step();
+                        }
+                        sink = sink + hand->handY();
+                    };
+                };
+                cases.push_back(bench);
+            }
+        }
+    }
+}
+
+static void addSwingCases(std::vector<BenchCase>& cases) {
+    for (int hands = 1; hands <= 2; hands++) {
+        BenchCase bench;
+        bench.name = hands == 1 ? "swing_forces/one_hand" : "swing_forces/two_hands";
+        bench.setup = [hands]() -> BenchBody {
+            std::shared_ptr<Character> player = std::make_shared<Character>(
+                nullptr, 500, 600, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+            player->x = 500;
+            player->y = 500;
+            player->leftHand.grab(440, 400);
+            if (hands == 2) player->rightHand.grab(560, 400);
+            return [player](long iterations) {
+                InputFrame right, left;
+                right.buttons = InputFrame::RIGHT | InputFrame::UP;
+                left.buttons = InputFrame::LEFT;
+                for (long i = 0; i < iterations; i++) {
+                    // Swing back and forth, and keep the two hand case from piling up speed
+                    player->applySwingForces((i & 64) ? left : right);
+                    if ((i & 1023) == 0) player->vy = 0;
+                }
+                sink = sink + player->x + player->vy;
+            };
+        };
+        cases.push_back(bench);
+    }
+}
+
+static void addCollisionCases(std::vector<BenchCase>& cases) {
+    const int sizes[] = {10, 1000, 100000};
+    for (int count : sizes) {
+        BenchCase body;
+        body.name = "character_collision/" + std::to_string(count);
+        body.setup = [count]() -> BenchBody {
+            std::shared_ptr<PlatformField> field = std::make_shared<PlatformField>(count);
+            std::shared_ptr<Character> player = std::make_shared<Character>(
+                nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+            return [field, player](long iterations) {
+                for (long i = 0; i < iterations; i++) {
+                    // Land on a different platform every time, walking through the whole level. The
+                    // ropes come along, or their broad phase box would span the level
+                    SDL_Point spot = field->landing(static_cast<int>(i * 7), static_cast<int>(PLAYER_RADIUS));
+                    player->leftHand.parti.translate(spot.x - player->x, spot.y - player->y);
+                    player->rightHand.parti.translate(spot.x - player->x, spot.y - player->y);
+                    player->x = spot.x;
+                    player->y = spot.y;
+                    player->handlecollision(field->platforms, field->grid);
+                }
+                sink = sink + player->y;
+            };
+        };
+        cases.push_back(body);
+
+        BenchCase rope;
+        rope.name = "rope_collision/" + std::to_string(count);
+        rope.setup = [count]() -> BenchBody {
+            std::shared_ptr<PlatformField> field = std::make_shared<PlatformField>(count);
+            std::shared_ptr<ropehand> hand = std::make_shared<ropehand>(
+                nullptr, 0.0, 35.0, 0.0, 0.0, PLAYER_HAND_PARTICLES, false);
+            return [field, hand](long iterations) {
+                for (long i = 0; i < iterations; i++) {
+                    // Rope lying across a platform, falling onto it
+                    SDL_Point spot = field->landing(static_cast<int>(i * 7), 0);
+                    for (int p = 0; p < hand->parti.size(); p++) {
+                        hand->parti.x[p] = hand->parti.px[p] = spot.x - 17 + 3.5 * p;
+                        hand->parti.y[p] = spot.y - 2;
+                        hand->parti.py[p] = spot.y - 6;
+                    }
+                    hand->handlecollision(field->platforms, field->grid);
+                }
+                sink = sink + hand->handY();
+            };
+        };
+        cases.push_back(rope);
+
+        BenchCase grab;
+        grab.name = "grab_query/" + std::to_string(count);
+        grab.setup = [count]() -> BenchBody {
+            std::shared_ptr<PlatformField> field = std::make_shared<PlatformField>(count);
+            std::shared_ptr<Character> player = std::make_shared<Character>(
+                nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+            return [field, player](long iterations) {
+                ropehand& hand = player->leftHand;
+                int last = hand.parti.last();
+                for (long i = 0; i < iterations; i++) {
+                    // Every other query hits a platform, the rest reach into the gap beside it
+                    SDL_Point spot = field->landing(static_cast<int>(i * 7), 0);
+                    hand.parti.x[last] = spot.x + ((i & 1) ? 0 : 190);
+                    hand.parti.y[last] = spot.y + 10;
+                    player->grab(true, field->platforms, field->grid);
+                    sink = sink + hand.isGrabbingObject;
+                    hand.release();
+                }
+            };
+        };
+        cases.push_back(grab);
+    }
+}
+
+// Quoted JSON string, the executable path has backslashes on Windows
+static void writeJsonString(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', out);
+        if (static_cast<unsigned char>(*c) < 0x20) fprintf(out, "\\u%04x", *c);
+        else fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+static void writeJson(FILE* out, const std::vector<BenchResult>& results, const char* executable) {
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+#if defined(PARTICLE_SIMD_AVX)
+    const char* simd = "avx";
+#elif defined(PARTICLE_SIMD_SSE2)
+    const char* simd = "sse2";
+#else
+    const char* simd = "none";
+#endif
+#ifdef NDEBUG
+    const char* buildType = "release";
+#else
+    const char* buildType = "debug";
+#endif
+
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"executable\": ");
+    writeJsonString(out, executable);
+    fprintf(out, ",\n");
+    fprintf(out, "    \"num_cpus\": %d,\n", SDL_GetCPUCount());
+    fprintf(out, "    \"particle_simd\": \"%s\",\n", simd);
+    fprintf(out, "    \"library_build_type\": \"%s\"\n", buildType);
+    fprintf(out, "  },\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(out, "    {\n");
+        fprintf(out, "      \"name\": ");
+        writeJsonString(out, r.name.c_str());
+        fprintf(out, ",\n      \"run_name\": ");
+        writeJsonString(out, r.name.c_str());
+        fprintf(out, ",\n");
+        fprintf(out, "      \"run_type\": \"iteration\",\n");
+        fprintf(out, "      \"iterations\": %ld,\n", r.iterations);
+        fprintf(out, "      \"real_time\": %.3f,\n", r.nsPerIteration);
+        fprintf(out, "      \"cpu_time\": %.3f,\n", r.cpuNsPerIteration);
+        fprintf(out, "      \"min_time\": %.3f,\n", r.minNs);
+        fprintf(out, "      \"max_time\": %.3f,\n", r.maxNs);
+        fprintf(out, "      \"time_unit\": \"ns\"\n");
+        fprintf(out, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    const char* jsonPath = nullptr;
+    double minTime = 0.2;
+    int repetitions = 5;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--json" && i + 1 < argc) jsonPath = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc) minTime = atof(argv[++i]);
+        else if (arg == "--repetitions" && i + 1 < argc) repetitions = std::max(1, atoi(argv[++i]));
+        else {
+            fprintf(stderr, "usage: %s [--filter text] [--min-time seconds] [--repetitions n] [--json out.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SDL_SetMainReady();
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    std::vector<BenchCase> cases;
+    addRopeCases(cases);
+    addSwingCases(cases);
+    addCollisionCases(cases);
+
+    // With the JSON on stdout the table goes to stderr
+    bool jsonToStdout = jsonPath != nullptr && std::string(jsonPath) == "-";
+    FILE* table = jsonToStdout ? stderr : stdout;
+
+    std::vector<BenchResult> results;
+    fprintf(table, "%-40s %14s %14s %12s\n", "benchmark", "ns/iter", "min ns", "iterations");
+    for (const BenchCase& bench : cases) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        BenchResult result = runCase(bench, minTime, repetitions);
+        fprintf(table, "%-40s %14.1f %14.1f %12ld\n", result.name.c_str(), result.nsPerIteration, result.minNs,
+                result.iterations);
+        fflush(table);
+        results.push_back(result);
+    }
+
+    if (jsonPath != nullptr) {
+        FILE* out = jsonToStdout ? stdout : fopen(jsonPath, "w");
+        if (out == nullptr) {
+            fprintf(stderr, "cannot write %s\n", jsonPath);
+            SDL_Quit();
+            return 1;
+        }
+        writeJson(out, results, argv[0]);
+        if (out != stdout) fclose(out);
+    }
+
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,247 @@
+// Soak test: many BotInput players (input_source.h) go through the levels again and again with
+// nothing drawn, for as long as you let them, watching for the two things players would only
+// notice after hours: memory that is never given back and steps that get slower.
+// usage: soak [--bots 8] [--minutes 60] [--cycles n] [--level-steps 10800] [--levels 1-5] [--seed 1]
+//
+// One cycle plays every level once with all bots side by side: each bot loads the level from disk
+// into its own GameSimulation (the same objects every time, like the game does when you pick the
+// next level) and plays until it finishes or level-steps run out. Between cycles every bot stands
+// at the same point, the start of the first level, so the live heap measured there should stop
+// changing after the first couple of cycles (vectors settle at their largest size). Step times are
+// averaged per cycle. Stops after --cycles or after the cycle that runs past --minutes.
+// Exits with 2 when the heap kept growing or the last cycle stepped much slower than the best one.
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "../input_source.h"
+#include "../simulation.h"
+#include "../texture_cache.h"
+
+// Every C++ allocation goes through here with its size in front, so frees can be counted too
+static size_t liveBlocks = 0;
+static size_t liveBytes = 0;
+static size_t allocationCount = 0;
+
+static const size_t BLOCK_HEADER = alignof(std::max_align_t);
+
+void* operator new(size_t size) {
+    char* block = static_cast<char*>(malloc(size + BLOCK_HEADER));
+    if (block == nullptr) throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(block) = size;
+    liveBlocks++;
+    liveBytes += size;
+    allocationCount++;
+    return block + BLOCK_HEADER;
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer == nullptr) return;
+    char* block = static_cast<char*>(pointer) - BLOCK_HEADER;
+    liveBlocks--;
+    liveBytes -= *reinterpret_cast<size_t*>(block);
+    free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+static const size_t LEAK_TOLERANCE = 64 * 1024;    // heap growth between settled cycles still called noise
+static const double SLOWDOWN_LIMIT = 1.5;           // last cycle vs the fastest one
+static const int WARMUP_CYCLES = 2;                 // not compared, vectors and caches are still growing
+
+// One player with its own world
+struct SoakBot {
+    Graphics world;
+    Character player;
+    GameSimulation sim;
+    BotInput input;
+    bool playing;
+
+    explicit SoakBot(uint32_t seed)
+        : player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES),
+          sim(world, player), input(seed), playing(false) {}
+};
+
+struct CycleStats {
+    size_t heapAtStart, blocksAtStart;
+    long steps;
+    double seconds;
+    double worstStep;       // seconds
+    size_t allocations;
+    int finishes, respawns, grabs, buttons;
+};
+
+static bool startLevel(SoakBot& bot, int level) {
+    if (!bot.sim.loadLevel(level)) return false;
+    bot.sim.startLevel();
+    bot.input.restart();
+    bot.playing = true;
+    return true;
+}
+
+// All bots through one level, stepped round robin one step at a time
+static bool playLevel(std::vector<std::unique_ptr<SoakBot> >& bots, int level, long levelSteps, CycleStats& cycle) {
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    int playing = 0;
+    for (auto& bot : bots) {
+        if (!startLevel(*bot, level)) return false;
+        playing++;
+    }
+
+    SimEvents events;
+    for (long step = 0; step < levelSteps && playing > 0; step++) {
+        for (auto& bot : bots) {
+            if (!bot->playing) continue;
+            InputFrame input = bot->input.next(bot->sim);
+            size_t allocationsBefore = allocationCount;
+            Uint64 start = SDL_GetPerformanceCounter();
+            bot->sim.step(input, events);
+            double seconds = (SDL_GetPerformanceCounter() - start) / frequency;
+
+            cycle.allocations += allocationCount - allocationsBefore;
+            cycle.steps++;
+            cycle.seconds += seconds;
+            cycle.worstStep = std::max(cycle.worstStep, seconds);
+            cycle.respawns += events.respawns;
+            cycle.grabs += events.grabPresses;
+            cycle.buttons += events.buttonsPressed;
+            if (events.finished) {
+                cycle.finishes++;
+                bot->playing = false;
+                playing--;
+            }
+        }
+    }
+    return true;
+}
+
+static bool parseLevels(const std::string& text, int& first, int& last) {
+    if (sscanf(text.c_str(), "%d-%d", &first, &last) == 2) return first >= 1 && last >= first;
+    if (sscanf(text.c_str(), "%d", &first) == 1) {
+        last = first;
+        return first >= 1;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    int botCount = 8, maxCycles = 0, firstLevel = 1, lastLevel = 5;
+    double minutes = 60;
+    long levelSteps = 180L * STEPS_PER_SECOND;  // three minutes of game time per level
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bots" && hasValue) botCount = std::max(1, atoi(argv[++i]));
+        else if (arg == "--minutes" && hasValue) minutes = atof(argv[++i]);
+        else if (arg == "--cycles" && hasValue) maxCycles = std::max(1, atoi(argv[++i]));
+        else if (arg == "--level-steps" && hasValue) levelSteps = std::max(1L, atol(argv[++i]));
+        else if (arg == "--seed" && hasValue) seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--levels" && hasValue && parseLevels(argv[++i], firstLevel, lastLevel)) continue;
+        else {
+            fprintf(stderr, "usage: %s [--bots 8] [--minutes 60] [--cycles n] [--level-steps 10800] "
+                            "[--levels 1-5] [--seed 1]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SDL_SetMainReady();
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    size_t heapBefore = liveBytes, blocksBefore = liveBlocks;
+    std::vector<std::unique_ptr<SoakBot> > bots;
+    for (int i = 0; i < botCount; i++) {
+        bots.push_back(std::unique_ptr<SoakBot>(new SoakBot(seed + i * 7919)));
+    }
+
+    printf("%d bots, levels %d-%d, up to %ld steps a level\n", botCount, firstLevel, lastLevel, levelSteps);
+    printf("%5s %13s %10s %10s %10s %10s %9s %9s %10s  %s\n", "cycle", "heap at start", "blocks", "steps",
+           "mean us", "worst us", "allocs/st", "finishes", "respawns", "grabs/buttons");
+
+    std::vector<CycleStats> cycles;
+    Uint64 started = SDL_GetPerformanceCounter();
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    bool failed = false;
+    for (;;) {
+        CycleStats cycle = CycleStats();
+
+        // Everyone at the start of the first level, same point every cycle
+        for (auto& bot : bots) {
+            if (!startLevel(*bot, firstLevel)) {
+                failed = true;
+                break;
+            }
+        }
+        if (failed) break;
+        cycle.heapAtStart = liveBytes;
+        cycle.blocksAtStart = liveBlocks;
+
+        for (int level = firstLevel; level <= lastLevel && !failed; level++) {
+            failed = !playLevel(bots, level, levelSteps, cycle);
+        }
+        if (failed) break;
+
+        cycles.push_back(cycle);
+        printf("%5d %13zu %10zu %10ld %10.2f %10.2f %9.3f %9d %10d  %d/%d\n", static_cast<int>(cycles.size()),
+               cycle.heapAtStart, cycle.blocksAtStart, cycle.steps, cycle.seconds / cycle.steps * 1e6,
+               cycle.worstStep * 1e6, cycle.allocations / static_cast<double>(cycle.steps), cycle.finishes,
+               cycle.respawns, cycle.grabs, cycle.buttons);
+        fflush(stdout);
+
+        double elapsed = (SDL_GetPerformanceCounter() - started) / frequency;
+        if (maxCycles > 0 ? static_cast<int>(cycles.size()) >= maxCycles : elapsed >= minutes * 60) break;
+    }
+    if (failed) {
+        fprintf(stderr, "cannot load a level between %d and %d\n", firstLevel, lastLevel);
+        SDL_Quit();
+        return 1;
+    }
+
+    size_t textures = TextureCache::liveCount();
+    bots.clear();
+    printf("after the bots are gone: %zd bytes in %zd blocks more than before them, %zu textures alive\n",
+           static_cast<ptrdiff_t>(liveBytes - heapBefore), static_cast<ptrdiff_t>(liveBlocks - blocksBefore),
+           textures);
+
+    // Verdict over the cycles after the warm up
+    int result = 0;
+    if (static_cast<int>(cycles.size()) > WARMUP_CYCLES + 1) {
+        const CycleStats& settled = cycles[WARMUP_CYCLES];
+        const CycleStats& last = cycles.back();
+        ptrdiff_t growth = static_cast<ptrdiff_t>(last.heapAtStart - settled.heapAtStart);
+        printf("heap from cycle %d to %d: %+td bytes, %+td blocks\n", WARMUP_CYCLES + 1, static_cast<int>(cycles.size()),
+               growth, static_cast<ptrdiff_t>(last.blocksAtStart - settled.blocksAtStart));
+        if (growth > static_cast<ptrdiff_t>(LEAK_TOLERANCE)) {
+            printf("LEAK: the heap keeps growing between cycles\n");
+            result = 2;
+        }
+
+        double fastest = 0;
+        for (size_t i = WARMUP_CYCLES; i < cycles.size(); i++) {
+            double mean = cycles[i].seconds / cycles[i].steps;
+            if (fastest == 0 || mean < fastest) fastest = mean;
+        }
+        double lastMean = last.seconds / last.steps;
+        printf("last cycle steps at %.2fx the fastest\n", lastMean / fastest);
+        if (lastMean > fastest * SLOWDOWN_LIMIT) {
+            printf("SLOWDOWN: steps got slower over the run\n");
+            result = 2;
+        }
+    } else {
+        printf("too few cycles to compare, run at least %d\n", WARMUP_CYCLES + 2);
+    }
+
+    SDL_Quit();
+    return result;
+}
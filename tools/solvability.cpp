@@ -0,0 +1,663 @@
+// Level solvability check: plays a level thousands of times with generated input on every core and
+// reports whether the finish zone was ever reached, the fastest run found and where runs die.
+// usage: solvability <level> [--runs n] [--rounds n] [--steps n] [--threads n] [--seed n]
+//                            [--save best.sgr] [--heatmap deaths.csv] [--batch] [--check-batch]
+//
+// Round 0 plays random inputs. Every later round mostly mutates the best runs so far (keep the
+// part that made progress, replace the rest with new random input) and keeps some random runs so
+// the search does not get stuck on one route. Runs take very different times (a run that dies
+// early is cheap, one that finishes is not), so every worker has its own queue and steals from the
+// others when it runs dry.
+//
+// --batch plays each round on one SimulationBatch instead (every run a lane, all stepped together),
+// a few times more runs per second. The batch keeps the whole level loaded where the game streams it,
+// so past the first screens it can differ from the game a little: the best run is played again in a
+// GameSimulation at the end and that result is the one reported.
+//
+// --check-batch searches nothing: it plays --runs random runs on a SimulationBatch and each of them in
+// its own GameSimulation as well, and compares the two state hashes after every step for as long as
+// the game has exactly the level's first chunks loaded (where the batch has to match it bit for bit).
+//
+// Exits with 0 when the finish was reached, 2 when it was not (--check-batch: 0 when every run matched).
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../replay.h"
+#include "../simulation.h"
+#include "../simulation_batch.h"
+
+static const int HEAT_CELL = 256;           // heatmap cell in pixels, same as the platform grid
+static const int STALL_STEPS = 20 * STEPS_PER_SECOND;    // a run that gets no further in 20 s of game time is stopped
+static const int BATCH_LANES_PER_THREAD = 32;   // --batch: runs stepped side by side per thread
+
+// Same input for steps steps in a row
+struct InputSegment {
+    Uint8 buttons;
+    int steps;
+};
+
+struct RunResult {
+    std::vector<InputSegment> input;
+    long finishedAt;            // step, -1 = not finished
+    double farthestX;
+    long farthestStep;          // step where farthestX was reached
+    long stepsPlayed;
+    std::vector<SDL_Point> deaths;
+    int round;
+    unsigned seed;
+
+    RunResult() : finishedAt(-1), farthestX(0), farthestStep(0), stepsPlayed(0), round(0), seed(0) {}
+
+    // Finished beats unfinished, then faster, then farther
+    bool betterThan(const RunResult& other) const {
+        if ((finishedAt >= 0) != (other.finishedAt >= 0)) return finishedAt >= 0;
+        if (finishedAt >= 0) return finishedAt < other.finishedAt;
+        return farthestX > other.farthestX;
+    }
+};
+
+// Mostly pushing right while grabbing and letting go, the way a player moves through a level
+static void appendRandomInput(std::mt19937& rng, std::vector<InputSegment>& input, long steps) {
+    std::uniform_int_distribution<int> length(4, 45);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    long total = 0;
+    while (total < steps) {
+        InputSegment segment;
+        segment.buttons = 0;
+        double direction = chance(rng);
+        if (direction < 0.7) segment.buttons |= InputFrame::RIGHT;
+        else if (direction < 0.85) segment.buttons |= InputFrame::LEFT;
+        if (chance(rng) < 0.3) segment.buttons |= InputFrame::UP;
+        double grab = chance(rng);
+        if (grab < 0.35) segment.buttons |= InputFrame::GRAB_LEFT;
+        else if (grab < 0.7) segment.buttons |= InputFrame::GRAB_RIGHT;
+        else if (grab < 0.8) segment.buttons |= InputFrame::GRAB_LEFT | InputFrame::GRAB_RIGHT;
+        segment.steps = length(rng);
+        input.push_back(segment);
+        total += segment.steps;
+    }
+}
+
+// Keep the parent's input up to a little before it stopped making progress, new input after that
+static std::vector<InputSegment> mutate(std::mt19937& rng, const RunResult& parent, long maxSteps) {
+    long keepUntil = parent.finishedAt >= 0 ? parent.finishedAt : parent.farthestStep;
+    std::uniform_real_distribution<double> fraction(0.5, 1.0);
+    keepUntil = static_cast<long>(keepUntil * fraction(rng));
+
+    std::vector<InputSegment> input;
+    long kept = 0;
+    for (const InputSegment& segment : parent.input) {
+        if (kept >= keepUntil) break;
+        InputSegment part = segment;
+        part.steps = static_cast<int>(std::min<long>(part.steps, keepUntil - kept));
+        input.push_back(part);
+        kept += part.steps;
+    }
+    appendRandomInput(rng, input, maxSteps - kept);
+    return input;
+}
+
+// Plays one input sequence from the start of the level
+static void playRun(const LevelDescription& description, long maxSteps, RunResult& run, ReplayLog* recording) {
+    Graphics world;
+    Character player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES);
+    GameSimulation sim(world, player);
+    sim.loadLevel(description);
+    sim.startLevel();
+    if (recording) recording->begin(0);
+
+    SimEvents events;
+    long step = 0;
+    run.farthestX = player.x;
+    for (const InputSegment& segment : run.input) {
+        InputFrame input;
+        input.buttons = segment.buttons;
+        for (int i = 0; i < segment.steps && step < maxSteps; i++) {
+            double x = player.x, y = player.y;
+            sim.step(input, events);
+            if (recording) recording->record(input, sim);
+            step++;
+
+            if (events.respawns > 0) run.deaths.push_back({static_cast<int>(x), static_cast<int>(y)});
+            if (events.finished) {
+                run.finishedAt = step;
+                break;
+            }
+            if (player.x > run.farthestX) {
+                run.farthestX = player.x;
+                run.farthestStep = step;
+            }
+        }
+        if (run.finishedAt >= 0 || step >= maxSteps || step - run.farthestStep > STALL_STEPS) break;
+    }
+    run.stepsPlayed = step;
+    if (recording) recording->finish(sim);
+}
+
+// One queue per worker, the owner takes from the back, thieves from the front
+struct WorkQueue {
+    SDL_mutex* mutex;
+    std::deque<int> jobs;
+};
+
+struct Round {
+    const LevelDescription* level;
+    long maxSteps;
+    std::vector<RunResult>* runs;
+    std::vector<WorkQueue> queues;
+    SDL_atomic_t steals;
+    SDL_atomic_t stepsPlayed;
+};
+
+struct Worker {
+    Round* round;
+    int index;
+};
+
+static bool takeJob(Round& round, int self, int& job) {
+    WorkQueue& own = round.queues[self];
+    SDL_LockMutex(own.mutex);
+    bool found = !own.jobs.empty();
+    if (found) {
+        job = own.jobs.back();
+        own.jobs.pop_back();
+    }
+    SDL_UnlockMutex(own.mutex);
+    if (found) return true;
+
+    // Jobs are never added during a round, so one pass over the others finding nothing means done
+    int count = static_cast<int>(round.queues.size());
+    for (int i = 1; i < count && !found; i++) {
+        WorkQueue& victim = round.queues[(self + i) % count];
+        SDL_LockMutex(victim.mutex);
+        found = !victim.jobs.empty();
+        if (found) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+        }
+        SDL_UnlockMutex(victim.mutex);
+    }
+    if (found) SDL_AtomicIncRef(&round.steals);
+    return found;
+}
+
+static int workerMain(void* data) {
+    Worker* worker = static_cast<Worker*>(data);
+    Round& round = *worker->round;
+    int job;
+    while (takeJob(round, worker->index, job)) {
+        RunResult& run = (*round.runs)[job];
+        playRun(*round.level, round.maxSteps, run, nullptr);
+        SDL_AtomicAdd(&round.stepsPlayed, static_cast<int>(run.stepsPlayed));
+    }
+    return 0;
+}
+
+// Plays every run on threadCount threads, returns the number of steals
+static int playRound(const LevelDescription& level, long maxSteps, std::vector<RunResult>& runs, int threadCount,
+                     long& stepsPlayed) {
+    Round round;
+    round.level = &level;
+    round.maxSteps = maxSteps;
+    round.runs = &runs;
+    round.queues.resize(threadCount);
+    SDL_AtomicSet(&round.steals, 0);
+    SDL_AtomicSet(&round.stepsPlayed, 0);
+    for (int i = 0; i < threadCount; i++) round.queues[i].mutex = SDL_CreateMutex();
+    for (int job = 0; job < static_cast<int>(runs.size()); job++) {
+        round.queues[job % threadCount].jobs.push_back(job);
+    }
+
+    std::vector<Worker> workers(threadCount);
+    std::vector<SDL_Thread*> threads;
+    for (int i = 0; i < threadCount; i++) {
+        workers[i].round = &round;
+        workers[i].index = i;
+        SDL_Thread* thread = SDL_CreateThread(workerMain, "Solvability", &workers[i]);
+        if (thread != nullptr) threads.push_back(thread);
+    }
+    // No threads at all, play everything here
+    if (threads.empty()) workerMain(&workers[0]);
+    for (SDL_Thread* thread : threads) SDL_WaitThread(thread, nullptr);
+
+    for (int i = 0; i < threadCount; i++) SDL_DestroyMutex(round.queues[i].mutex);
+    stepsPlayed += SDL_AtomicGet(&round.stepsPlayed);
+    return SDL_AtomicGet(&round.steals);
+}
+
+// Moves a batched run on to the input of its next step, false once playRun would have stopped it
+static bool nextSegment(const RunResult& run, long maxSteps, size_t& segment, int& segmentStep) {
+    if (run.finishedAt >= 0 || run.stepsPlayed >= maxSteps) return false;
+    while (segment < run.input.size() && segmentStep >= run.input[segment].steps) {
+        if (run.stepsPlayed - run.farthestStep > STALL_STEPS) return false;
+        segment++;
+        segmentStep = 0;
+    }
+    return segment < run.input.size();
+}
+
+// The same round on a SimulationBatch: a few lanes per thread, a lane whose run is over starts the
+// next one, so the registers stay full however differently long the runs are
+static void playRoundBatched(const BatchLevel& batchLevel, long maxSteps, std::vector<RunResult>& runs,
+                             int threadCount, long& stepsPlayed) {
+    const int count = static_cast<int>(runs.size());
+    const int lanes = std::min(count, BATCH_LANES_PER_THREAD * threadCount);
+    SimulationBatch batch(batchLevel, lanes, threadCount);
+    std::vector<int> job(lanes);
+    std::vector<size_t> segment(lanes, 0);
+    std::vector<int> segmentStep(lanes, 0);
+    std::vector<double> lastX(lanes), lastY(lanes);
+    int nextJob = 0;
+    for (int lane = 0; lane < lanes; lane++) {
+        job[lane] = nextJob++;
+        runs[job[lane]].farthestX = batch.x[lane];
+    }
+
+    int playing = lanes;
+    while (playing > 0) {
+        for (int lane = 0; lane < lanes; lane++) {
+            while (batch.running[lane] && !nextSegment(runs[job[lane]], maxSteps, segment[lane], segmentStep[lane])) {
+                if (nextJob < count) {
+                    job[lane] = nextJob++;
+                    segment[lane] = 0;
+                    segmentStep[lane] = 0;
+                    batch.restart(lane);
+                    runs[job[lane]].farthestX = batch.x[lane];
+                } else {
+                    batch.running[lane] = 0;
+                    playing--;
+                }
+            }
+            if (!batch.running[lane]) continue;
+            batch.input[lane].buttons = runs[job[lane]].input[segment[lane]].buttons;
+            lastX[lane] = batch.x[lane];
+            lastY[lane] = batch.y[lane];
+        }
+        if (playing == 0) break;
+
+        batch.step();
+
+        for (int lane = 0; lane < lanes; lane++) {
+            if (!batch.running[lane]) continue;
+            RunResult& run = runs[job[lane]];
+            run.stepsPlayed++;
+            segmentStep[lane]++;
+            stepsPlayed++;
+
+            const SimEvents& events = batch.events[lane];
+            if (events.respawns > 0) {
+                run.deaths.push_back({static_cast<int>(lastX[lane]), static_cast<int>(lastY[lane])});
+            }
+            if (events.finished) {
+                run.finishedAt = run.stepsPlayed;
+            } else if (batch.x[lane] > run.farthestX) {
+                run.farthestX = batch.x[lane];
+                run.farthestStep = run.stepsPlayed;
+            }
+        }
+    }
+}
+
+// --check-batch: a GameSimulation playing the same input as one batch lane. A new one for every run,
+// like playRun: a Character keeps its facing direction across resetPosition().
+struct CheckedRun {
+    Graphics world;
+    Character player;
+    GameSimulation sim;
+    std::vector<InputSegment> input;
+    size_t segment;
+    int segmentStep;
+    long steps;
+    int number;
+
+    CheckedRun(const LevelDescription& level, int runNumber, unsigned seed, long maxSteps)
+        : player(nullptr, PLAYER_START_X, PLAYER_START_Y, PLAYER_RADIUS, PLAYER_HAND_PARTICLES),
+          sim(world, player), segment(0), segmentStep(0), steps(0),
+          number(runNumber) {
+        std::mt19937 rng(seed);
+        appendRandomInput(rng, input, maxSteps);
+        sim.loadLevel(level);
+        sim.startLevel();
+    }
+
+    Uint8 nextButtons() {
+        while (segmentStep >= input[segment].steps) {
+            segment++;
+            segmentStep = 0;
+        }
+        segmentStep++;
+        return input[segment].buttons;
+    }
+};
+
+// Does the game still hold the batch's first platforms, slot for slot, and nothing else
+static bool inFirstWindow(const GameSimulation& sim, const BatchLevel& batchLevel) {
+    int slots = std::max(static_cast<int>(sim.world.platforms.size()), batchLevel.firstWindow);
+    for (int slot = 0; slot < slots; slot++) {
+        int object = sim.streamer.objectInSlot(slot);
+        int expected = slot < batchLevel.firstWindow ? batchLevel.objects[slot] : -1;
+        if (object == expected) continue;
+        // Open gates are despawned for good, the batch leaves them out of its queries instead
+        if (object < 0 && expected >= 0 && batchLevel.isGate[slot] && sim.rules.gatesOpen) continue;
+        return false;
+    }
+    return true;
+}
+
+// What the game and a batch lane both have, hashed in the same order: the player and its ropes, the
+// camera, the live platforms, the spike wall, buttons and gates
+static uint64_t windowHash(const GameSimulation& sim) {
+    StateHash hash;
+    const Character& player = sim.player;
+    hash.add(player.x); hash.add(player.y);
+    hash.add(player.vx); hash.add(player.vy);
+    hash.add(player.leftHand);
+    hash.add(player.rightHand);
+    hash.add(player.hasReachedFinish);
+    hash.add(sim.camera.x);
+    for (int slot = 0; slot < static_cast<int>(sim.world.platforms.size()); slot++) {
+        if (sim.streamer.objectInSlot(slot) < 0) continue;
+        hash.add(sim.world.platforms[slot].rect);
+        hash.add(sim.world.platforms[slot].activated);
+    }
+    if (sim.spikeWall) hash.add(sim.spikeWall->rect);
+    hash.add(sim.rules.pressedButtons);
+    hash.add(sim.rules.gatesOpen);
+    return hash.result();
+}
+
+static uint64_t windowHash(SimulationBatch& batch, const BatchLevel& batchLevel, int lane) {
+    StateHash hash;
+    hash.add(batch.x[lane]); hash.add(batch.y[lane]);
+    hash.add(batch.vx[lane]); hash.add(batch.vy[lane]);
+    for (int h = 0; h < 2; h++) {
+        RopeView rope = batch.hand(lane, h);
+        for (int p = 0; p < rope.count; p++) {
+            int i = rope.at(p);
+            hash.add(rope.x[i]); hash.add(rope.y[i]); hash.add(rope.px[i]); hash.add(rope.py[i]);
+        }
+        hash.add(batch.grabbing[h][lane] != 0);
+        hash.add(batch.grabbedPlatform[h][lane]);
+    }
+    hash.add(batch.finished[lane] != 0);
+    hash.add(batch.cameras[lane].x);
+    for (int index = 0; index < batchLevel.firstWindow; index++) {
+        if (batch.gatesOpen[lane] && batchLevel.isGate[index]) continue;
+        int button = batchLevel.buttonOf[index];
+        hash.add(batch.platform(lane, index).rect);
+        hash.add(button >= 0 && batch.buttonPressed(lane, button));
+    }
+    if (batchLevel.rules.hasSpikeWall) {
+        SDL_Rect wall = batchLevel.rules.spikeWallRect;
+        wall.x = batch.spikeWallX[lane];
+        hash.add(wall);
+    }
+    hash.add(batch.pressedButtons[lane]);
+    hash.add(batch.gatesOpen[lane] != 0);
+    return hash.result();
+}
+
+// Plays runs random runs on a SimulationBatch and in GameSimulations side by side, a run is compared
+// after each step until it finishes, runs out of steps or the game's load window moves. Returns the
+// number of runs that went somewhere else.
+static int checkBatch(const LevelDescription& level, const BatchLevel& batchLevel, int runs, long maxSteps,
+                      int threadCount, std::mt19937& rng, long& stepsCompared, int& windowsLeft) {
+    const int lanes = std::min(runs, BATCH_LANES_PER_THREAD * threadCount);
+    SimulationBatch batch(batchLevel, lanes, threadCount);
+    std::vector<std::unique_ptr<CheckedRun>> checked(lanes);
+    int started = 0, differing = 0;
+    for (int lane = 0; lane < lanes; lane++) {
+        checked[lane].reset(new CheckedRun(level, started, rng(), maxSteps));
+        started++;
+    }
+
+    int playing = lanes;
+    while (playing > 0) {
+        for (int lane = 0; lane < lanes; lane++) {
+            if (batch.running[lane]) batch.input[lane].buttons = checked[lane]->nextButtons();
+        }
+        batch.step();
+
+        for (int lane = 0; lane < lanes; lane++) {
+            if (!batch.running[lane]) continue;
+            CheckedRun& run = *checked[lane];
+            SimEvents events;
+            run.sim.step(batch.input[lane], events);
+            run.steps++;
+
+            bool over = events.finished || run.steps >= maxSteps;
+            if (!inFirstWindow(run.sim, batchLevel)) {
+                windowsLeft++;
+                over = true;
+            } else if (windowHash(run.sim) != windowHash(batch, batchLevel, lane)) {
+                printf("run %d differs from GameSimulation at step %ld: player at %.2f, %.2f there, %.2f, %.2f in the batch\n",
+                       run.number, run.steps, run.player.x, run.player.y, batch.x[lane], batch.y[lane]);
+                differing++;
+                over = true;
+            } else {
+                stepsCompared++;
+            }
+
+            if (!over) continue;
+            if (started < runs) {
+                checked[lane].reset(new CheckedRun(level, started, rng(), maxSteps));
+                started++;
+                batch.restart(lane);
+            } else {
+                batch.running[lane] = 0;
+                playing--;
+            }
+        }
+    }
+    return differing;
+}
+
+static void printHeatmap(const std::vector<int>& cells, int columns, int rows) {
+    const char shades[] = " .:-=+*#%@";
+    int most = *std::max_element(cells.begin(), cells.end());
+    if (most == 0) {
+        printf("no deaths\n");
+        return;
+    }
+    printf("deaths per %d px cell (level left to right, top to bottom), busiest cell %d:\n", HEAT_CELL, most);
+    for (int row = 0; row < rows; row++) {
+        printf("  |");
+        for (int column = 0; column < columns; column++) {
+            int count = cells[row * columns + column];
+            int shade = count == 0 ? 0 : 1 + (count * 8) / most;
+            putchar(shades[std::min(shade, 9)]);
+        }
+        printf("|\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <level> [--runs n] [--rounds n] [--steps n] [--threads n] [--seed n]\n"
+                        "       [--save best.sgr] [--heatmap deaths.csv] [--batch] [--check-batch]\n", argv[0]);
+        return 1;
+    }
+    int levelNumber = atoi(argv[1]);
+    int totalRuns = 2000, rounds = 8, threadCount = 0;
+    long maxSteps = 180L * STEPS_PER_SECOND;
+    unsigned seed = 1;
+    const char* savePath = nullptr;
+    const char* heatmapPath = nullptr;
+    bool batched = false, checking = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--batch" || arg == "--check-batch") {
+            batched = batched || arg == "--batch";
+            checking = checking || arg == "--check-batch";
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", arg.c_str());
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--runs") totalRuns = std::max(1, atoi(value));
+        else if (arg == "--rounds") rounds = std::max(1, atoi(value));
+        else if (arg == "--steps") maxSteps = std::max(1L, atol(value));
+        else if (arg == "--threads") threadCount = atoi(value);
+        else if (arg == "--seed") seed = static_cast<unsigned>(atol(value));
+        else if (arg == "--save") savePath = value;
+        else if (arg == "--heatmap") heatmapPath = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    SDL_SetMainReady();
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+    if (threadCount <= 0) threadCount = std::max(1, SDL_GetCPUCount());
+
+    LevelDescription level;
+    if (!LevelLoader::load(levelNumber, level)) {
+        SDL_Quit();
+        return 1;
+    }
+    int levelWidth = std::max(level.width, SCREEN_WIDTH);
+    int columns = (levelWidth + 200 + HEAT_CELL - 1) / HEAT_CELL;   // falls are counted up to 100 px outside
+    int rows = (SCREEN_HEIGHT + 200 + HEAT_CELL - 1) / HEAT_CELL;
+    std::vector<int> heat(columns * rows, 0);
+    BatchLevel batchLevel;
+    if (batched || checking) batchLevel.build(level);
+
+    std::mt19937 rng(seed);
+    if (checking) {
+        long stepsCompared = 0;
+        int windowsLeft = 0;
+        int differing = checkBatch(level, batchLevel, totalRuns, maxSteps, threadCount, rng, stepsCompared, windowsLeft);
+        printf("level %d: %d runs checked against GameSimulation, %ld steps inside the first load window "
+               "(%d runs left it), %d runs differ\n", levelNumber, totalRuns, stepsCompared, windowsLeft, differing);
+        SDL_Quit();
+        return differing == 0 ? 0 : 2;
+    }
+    std::vector<RunResult> elite;               // best runs so far, parents of the next round
+    const size_t ELITE_SIZE = 16;
+    RunResult best;
+    bool haveBest = false;
+    long stepsPlayed = 0;
+    int steals = 0, finishedRuns = 0;
+    size_t deaths = 0;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int r = 0; r < rounds; r++) {
+        int count = totalRuns / rounds + (r < totalRuns % rounds ? 1 : 0);
+        std::vector<RunResult> runs(count);
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        for (RunResult& run : runs) {
+            run.round = r;
+            run.seed = rng();
+            std::mt19937 runRng(run.seed);
+            if (elite.empty() || chance(rng) < 0.3) {
+                appendRandomInput(runRng, run.input, maxSteps);
+            } else {
+                run.input = mutate(runRng, elite[rng() % elite.size()], maxSteps);
+            }
+        }
+
+        if (batched) playRoundBatched(batchLevel, maxSteps, runs, threadCount, stepsPlayed);
+        else steals += playRound(level, maxSteps, runs, threadCount, stepsPlayed);
+
+        for (RunResult& run : runs) {
+            if (run.finishedAt >= 0) finishedRuns++;
+            for (const SDL_Point& death : run.deaths) {
+                int column = std::min(columns - 1, std::max(0, (death.x + 100) / HEAT_CELL));
+                int row = std::min(rows - 1, std::max(0, (death.y + 100) / HEAT_CELL));
+                heat[row * columns + column]++;
+            }
+            deaths += run.deaths.size();
+            run.deaths.clear();
+            if (!haveBest || run.betterThan(best)) {
+                best = run;
+                haveBest = true;
+            }
+            elite.push_back(run);
+        }
+        std::stable_sort(elite.begin(), elite.end(), [](const RunResult& a, const RunResult& b) { return a.betterThan(b); });
+        if (elite.size() > ELITE_SIZE) elite.resize(ELITE_SIZE);
+
+        printf("round %d: %d runs, best %s %.0f\n", r, count, best.finishedAt >= 0 ? "finish at step" : "x",
+               best.finishedAt >= 0 ? static_cast<double>(best.finishedAt) : best.farthestX);
+        fflush(stdout);
+    }
+    double seconds = (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+
+    if (batched) {
+        printf("level %d: %d runs batched on %d threads in %.1f s, %.0f steps/s\n", levelNumber, totalRuns,
+               threadCount, seconds, stepsPlayed / seconds);
+    } else {
+        printf("level %d: %d runs on %d threads in %.1f s, %.0f steps/s, %d jobs stolen\n", levelNumber, totalRuns,
+               threadCount, seconds, stepsPlayed / seconds, steals);
+    }
+
+    // What the batch found has to hold in the game's own simulation
+    if (batched && haveBest) {
+        RunResult check;
+        check.input = best.input;
+        check.round = best.round;
+        check.seed = best.seed;
+        playRun(level, maxSteps, check, nullptr);
+        if (check.finishedAt != best.finishedAt || check.farthestX != best.farthestX) {
+            printf("best batch run plays differently in GameSimulation (%s %.0f there, %s %.0f in the batch)\n",
+                   check.finishedAt >= 0 ? "finish at step" : "x",
+                   check.finishedAt >= 0 ? static_cast<double>(check.finishedAt) : check.farthestX,
+                   best.finishedAt >= 0 ? "finish at step" : "x",
+                   best.finishedAt >= 0 ? static_cast<double>(best.finishedAt) : best.farthestX);
+            if (best.finishedAt >= 0 && check.finishedAt < 0) finishedRuns--;
+        }
+        check.deaths.clear();
+        best = check;
+    }
+    if (best.finishedAt >= 0) {
+        printf("finish reachable: %d runs finished, fastest %.2f s of game time (step %ld, round %d)\n",
+               finishedRuns, best.finishedAt * STEP_SECONDS, best.finishedAt, best.round);
+    } else {
+        printf("finish NOT reached, farthest x %.0f of %d\n", best.farthestX, levelWidth);
+    }
+    printf("%zu deaths\n", deaths);
+    printHeatmap(heat, columns, rows);
+
+    // Play the best run once more while recording it, it then opens in Game_headless --replay
+    if (savePath != nullptr && haveBest) {
+        ReplayLog recording;
+        RunResult replayRun;
+        replayRun.input = best.input;
+        long steps = best.finishedAt >= 0 ? best.finishedAt : best.stepsPlayed;
+        playRun(level, steps, replayRun, &recording);
+        recording.level = levelNumber;
+        if (recording.save(savePath)) printf("best run saved to %s\n", savePath);
+    }
+
+    if (heatmapPath != nullptr) {
+        FILE* out = fopen(heatmapPath, "w");
+        if (out != nullptr) {
+            fprintf(out, "x,y,deaths\n");
+            for (int row = 0; row < rows; row++) {
+                for (int column = 0; column < columns; column++) {
+                    int count = heat[row * columns + column];
+                    if (count > 0) fprintf(out, "%d,%d,%d\n", column * HEAT_CELL - 100, row * HEAT_CELL - 100, count);
+                }
+            }
+            fclose(out);
+        } else {
+            fprintf(stderr, "cannot write %s\n", heatmapPath);
+        }
+    }
+
+    SDL_Quit();
+    return best.finishedAt >= 0 ? 0 : 2;
+}
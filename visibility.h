@@ -0,0 +1,76 @@
+#ifndef _VISIBILITY__H
+#define _VISIBILITY__H
+#include <SDL.h>
+#include <vector>
+#include "camera.h"
+#include "defs.h"
+#include "graphics.h"
+#include "spatial_grid.h"
+
+// Drawn vs culled renderables, summed over a reporting period
+struct CullStats {
+    int drawn;
+    int culled;
+    int frames;
+
+    CullStats() : drawn(0), culled(0), frames(0) {}
+
+    void count(int visible, int total) {
+        drawn += visible;
+        culled += total - visible;
+    }
+
+    void reset() {
+        drawn = 0;
+        culled = 0;
+        frames = 0;
+    }
+};
+
+// Visibility pass of the PLAYING renderer: only what overlaps the camera rect is submitted.
+// Platforms come from the collision grid, so the cost follows what is on screen, not the level size.
+class Visibility {
+public:
+    // Rendering draws interpolated positions while the grid holds the last physics step, a moving
+    // platform can be a step away from its cells
+    static const int QUERY_MARGIN = 64;
+
+    static bool isOnScreen(const SDL_Rect& rect, const Camera& camera) {
+        return camera.isVisible(rect.x, rect.x + rect.w) && rect.y + rect.h >= 0 && rect.y <= SCREEN_HEIGHT;
+    }
+
+    // Indices of the visible platforms in ascending order, the same draw order as the full list
+    template <typename IndexList>
+    static void visiblePlatforms(const std::vector<Platform>& platforms, const PlatformGrid& grid,
+                                 const Camera& camera, IndexList& out) {
+        grid.query(camera.x - QUERY_MARGIN, -QUERY_MARGIN,
+                   camera.x + SCREEN_WIDTH + QUERY_MARGIN, SCREEN_HEIGHT + QUERY_MARGIN, out);
+        int kept = 0;
+        for (int index : out) {
+            if (isOnScreen(platforms[index].rect, camera)) out[kept++] = index;
+        }
+        out.resize(kept);
+    }
+
+    // A background stretched over the whole level: the part of the texture under the view and where
+    // it lands on screen (dest is computed back from the whole-pixel source so nothing stretches)
+    static bool backgroundRects(SDL_Texture* texture, const Camera& camera, SDL_Rect& src, SDL_Rect& dest) {
+        int textureWidth = 0, textureHeight = 0;
+        if (SDL_QueryTexture(texture, NULL, NULL, &textureWidth, &textureHeight) != 0 || textureWidth <= 0) {
+            return false;
+        }
+
+        double texelsPerPixel = textureWidth / camera.getLevelWidth();
+        int left = static_cast<int>(camera.x * texelsPerPixel);
+        int right = static_cast<int>((camera.x + SCREEN_WIDTH) * texelsPerPixel) + 1;
+        if (right > textureWidth) right = textureWidth;
+
+        src = {left, 0, right - left, textureHeight};
+        int destLeft = static_cast<int>(left / texelsPerPixel - camera.x);
+        int destRight = static_cast<int>(right / texelsPerPixel - camera.x);
+        dest = {destLeft, 0, destRight - destLeft, SCREEN_HEIGHT};
+        return true;
+    }
+};
+
+#endif